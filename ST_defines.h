@@ -32,7 +32,6 @@
 #define MAX_SPECIESNAMELEN   4
 #define MAX_OUTFIELDS (MAX_SPECIES + (MAX_RGROUPS *2) + 5 +1 )
 #define MAX_FIELDLEN MAX_GROUPNAMELEN + 6  /* +6 for xtra chars like _RSize, etc */
-#define MAX_CELLS 10000 // defines the maximum number of cells in the grid option
 
 /* Constants for flagging whether a sort is
    ascending or descending or none */
@@ -5,6 +5,18 @@
 //  Purpose: This module handles the grid.
 //  History:
 //     (5/24/2013) -- INITIAL CODING - DLM
+//     (10/18/2026) -- the cells only keep the species/group quantities that change during a run (Grid_Species_St, Grid_RGroup_St), the parameters are shared through Species[] & RGroup[]
+//     (10/18/2026) -- the output files are written straight from the grid accumulators (stat_Output_Cell()) by several threads, without loading each cell
+//     (10/18/2026) -- optional 5th line of the grid setup file to write one binary file for each kind of output instead of files for every cell (see ST_gridbin.h & griddump)
+//     (10/18/2026) -- the phases of each cell-year are timed with the -t option, and traced with -r (see ST_prof.c)
+//     (10/18/2026) -- memory report after the setup and once a year on SIGUSR1 with the -a option (see ST_prof.c)
+//     (10/18/2026) -- no MAX_CELLS limit anymore, the grid is only bounded by memory now that the build is 64-bit
+//     (10/18/2026) -- the seed dispersal sending cells were indexed with the row and column swapped (_read_seed_dispersal_in())
+//     (10/18/2026) -- optional cell mask (6th line of the grid setup file, 10th file of files.in): masked out cells get no state, aren't simulated, and have no output; seed dispersal between the cells still uses their rows/cols
+//     (10/18/2026) -- the state of the cells comes from a cell state store (_store_alloc()), which compiling with -DGRID_MMAP backs with a mapped file that is paged in a row ahead of the simulation
+//     (10/18/2026) -- optional 7th line of the grid setup file to keep the soilwat state of the cells that aren't being simulated packed (see _pack_cell() & ST_pack.c)
+//     (10/18/2026) -- optional 8th line of the grid setup file to store & simulate the cells along a Morton or Hilbert curve instead of row by row (see _order_cells()); row/col <-> cell number goes through the _cell_*() macros
+//     (10/18/2026) -- -j option: each cell draws from its own random number stream and starts every iteration from the same state, and without seed dispersal the cells are simulated a chunk at a time by worker processes that steal chunks from each other (see "about the worker processes" at the top & _run_workers())
 //
 //	WARNING: This module deals with a LARGE amount of dynamic memory allocation/deallocation (there can be potentially hundreds of thousands of allocations/frees called by this code depending on settings ran).  
 //			 Be very wary when editing it as even small changes could possibly cause massive memory errors/leaks to occur.  In particular be careful when copy/freeing the linked list of individuals (I would suggest just using the code I wrote for this as it works and it's pretty easy to screw it up).  
@@ -28,6 +40,8 @@ the general idea when copying over the dynamically allocated data is (ie. how to
 	4.) Use memcpy to copy the data over to your newly allocated pointer (or use the _copy_head() function to copy the linked list of individuals)
 	5.) Be careful at all stages of this process as it is easy to make a simple error that can be very aggravating to try and track down.
 	
+	Species and groups are the exception: only their state is kept for each cell, and it is copied field by field (see _load_species() & _save_species()) into arrays Species[]/RGroup[] already own, since those are the same size in every cell.
+	
 ----------------------------------------------------------------------------------------------------------------
 explanation of why all this trouble is gone through when copying the memory (as it is not obvious by any means):
 ----------------------------------------------------------------------------------------------------------------
@@ -50,9 +64,47 @@ about performance concerns:
 The performance hit of all this memory management is surprisingly low in CPU execution time.  Luckily, modern day implementations of malloc/free/memcpy are very fast. 
 After profiling the code the time spent allocating/deallocating/copying memory is completely negligible compared to the time spent doing calculations.
 Where the approach has it's downsides is that the program requires a TON of memory in order to do large simulations (ie. it took around 2.8 GB for a 10,000 cell grid when I tried it).
+The makefile builds 64-bit by default, so a single run isn't held under 4 GB of address space anymore; a 32-bit build (make ARCH=-m32) still is.
 This shouldn't be an issue in most cases.  It is unavoidable though that at some point the number of cells in a simulation will be bounded by the amount of memory available.
 Issues could possibly arise if you're trying to run a simulation that requires more memory then your system has available.  I don't know of a way to easily check for that condition, so just don't do it.
 	
+----------------------------------------------------------------------------------------------------------------
+about paging the cell state out to disk:
+----------------------------------------------------------------------------------------------------------------
+
+	Everything that is kept for each simulated cell (the grid_* arrays of one element per cell, the arrays each cell's state points to, the seed dispersal tables, and the statistics accumulators) is allocated with _store_alloc()/_store_cells() instead of Mem_Calloc().
+Normally those are just Mem_Calloc() blocks.  Compiled with -DGRID_MMAP (which turns on STAT_MMAP in ST_stats.c too) they're carved out of chunks of an unlinked temporary file that are mapped in with mmap(), so the kernel can write them back to the file and drop them from memory when it needs to, and the size of the grid is bounded by disk instead of RAM.
+The temporary file goes where tmpfile() puts it (usually /tmp, see TMPDIR), so that needs to be on a disk with room for the whole grid.
+The cells are visited in the order they are stored in (grid_Order), so at the start of each row's worth of cells (grid_Cols) the next STORE_PREFETCH_ROWS rows' worth are read ahead (MADV_WILLNEED) while the current ones are simulated, and the ones before are marked as the first to page out (MADV_COLD), see _store_page().
+The arrays each cell's state points to are allocated in that order every iteration, so those cells are next to each other in the file too; they are given back all at once at the end of the iteration (_store_rewind()).
+The individuals are the exception, they stay in ordinary memory since the lists are rebuilt every time a cell is saved (they are a small part of a cell's state).
+	
+----------------------------------------------------------------------------------------------------------------
+about packing the soilwat state of the cells:
+----------------------------------------------------------------------------------------------------------------
+
+	With soilwat on, almost all of a cell's state is its copy of SW_Soilwat & SW_VegProd (about 170K and 100K, mostly zeros and numbers repeated for each layer and day), which sits unused from one year's visit to the next.
+If the 7th line of the grid setup file is 1, those two, the cell's SXW transp/swc arrays, and (with the soils input) its copy of sxw.c's root arrays are kept packed with the LZ4 style compressor in ST_pack.c instead of in grid_SW_Soilwat/grid_SW_VegProd/grid_SXW_ptrs.
+_save_cell() lays them out one after the other in pack_Buf (_pack_layout()) and packs that into the cell's grid_Packed block, and _load_cell() unpacks it again, so they are only unpacked for the one cell being simulated.
+The rest of the cell's state isn't packed, since the seed dispersal reads the species of every cell between visits and the rest is small.
+Packing is lossless, so the output is the same either way; it costs some time in _load_cell() & _save_cell() (see the -t report) for a much smaller resident size.
+	
+----------------------------------------------------------------------------------------------------------------
+about the worker processes (-j):
+----------------------------------------------------------------------------------------------------------------
+
+	STEPPE and SOILWAT keep the cell being simulated in global variables (that's why cells are loaded & saved), so cells can't be simulated by threads of one process, but they can by separate processes.
+Without seed dispersal a cell never looks at another one, so with -j n the cells are split into chunks and n processes (this one and n-1 forked workers) each simulate a chunk through every iteration and year before taking the next one (_run_worker()).
+The cells' state stays in the process simulating them (it's only ever allocated there), and stat_Collect() writes into the accumulators of the cell, which are in memory shared by the processes (stat_Share_Accumulators()), so this process can write the output when they're all done.
+The chunks are cut so they have about the same estimated cost (_cell_cost(), from the soil layers of each cell, since soilwat is most of a year and takes longer the more layers there are), and each process starts with a run of CHUNKS_PER_WORKER of them.
+A process takes its own chunks from the front, and when it has none left it steals the back half (by estimated cost) of the chunks of the process with the most estimated cost left (_pool_take()), so the processes keep busy until the very end even when the estimates are off.
+For the results not to depend on which process simulates a cell or what it simulated before, each cell draws from its own random number stream (grid_Rand, seeded from the iteration and cell number) and starts every iteration from the same state (_save_start(), _restore_start()).
+Soilwat also carries some state from one day to the next in module variables rather than in SW_Soilwat (the water intercepted by the plants, the snow temperature, ...), which with -j goes with the cell too (grid_SW_Carry, _save_carry()), and _load_cell() sets the calendar to the cell's year, since sxw sets up the year's vegetation before soilwat does.
+The -m cache and the -x surrogate would be kept by each process for itself, so what they return would depend on which cells the process simulated before (and on how the chunks happened to be stolen), and they're turned off when the cells are simulated a chunk at a time (with a note in the log file).
+So the output is the same for any n, but it isn't the same as without -j, where the cells share one random number stream.
+With seed dispersal (the cells have to wait for each other every year) or -DGRID_MMAP (the store is a file mapping the processes would share) -j still gives each cell its stream, but the cells are all simulated in this process, year by year as without -j.
+The timing, trace, and memory reports (-t, -r, -a) only cover this process.
+
 ----------------------------------------------------------------------------------------------------------------
 	If any of the concepts I have been discussing seem confusing (or your knowledge of pointers feels rusty) I would suggest brushing up on your pointers/memory management.
 Some things to go over would be correct free/alloc/memcpy usage (keep in mind that a free is needed for every corresponding alloc call, some people seem not to comprehend that a pointer of pointers (ie. int**) must be freed in multiple steps, otherwise you lose memory), pointer arithmetic, and the difference between arrays & pointers in C.	
@@ -67,16 +119,24 @@ Some things to go over would be correct free/alloc/memcpy usage (keep in mind th
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
 #include <errno.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "ST_steppe.h"
 #include "generic.h"
 #include "filefuncs.h"
 #include "myMemory.h"
 #include "ST_globals.h"
+#include "ST_prof.h"
+#include "ST_pack.h"
 #include "rands.h"
 
 #include "sxw_funcs.h"
@@ -88,20 +148,57 @@ Some things to go over would be correct free/alloc/memcpy usage (keep in mind th
 #include "SW_VegProd.h"
 #include "SW_Model.h"
 #include "SW_Weather.h"
+#include "SW_Flow_lib.h"
 
 /***************** Structure Declarations ******************/
 /***********************************************************/
 
+struct _grid_species_st { //the quantities in species_st that can change during a model run, kept for each cell (the parameters are the same for every cell, so they stay in Species[])
+	SppIndex est_count;
+	IntUS *kills,		/* length max_age */
+	      estabs;
+	RealF relsize,
+	      *seedprod,	/* length viable_yrs */
+	      extragrowth,
+	      received_prob,
+	      seedling_estab_prob; /* set to 0 when the species' group is extirpated, see rgroup_Extirpate() */
+	IndivType *IndvHead;
+	Bool allow_growth;
+} typedef Grid_Species_St;
+
+struct _grid_rgroup_st { //the quantities in resourcegroup_st that can change during a model run, kept for each cell (the parameters stay in RGroup[])
+	IntUS *kills,		/* length max_age */
+	      estabs,
+	      killyr,
+	      yrs_neg_pr,
+	      mm_extra_res;
+	RealF res_required,
+	      res_avail,
+	      res_extra,
+	      pr,
+	      relsize;
+	SppIndex est_count,
+	         est_spp[MAX_SPP_PER_GRP];
+	Bool extirpated,
+	     regen_ok;
+} typedef Grid_RGroup_St;
+
 struct _grid_soil_lyr_st { // represents a single soil layer
 	float data[11];
 	int width;
 } typedef Grid_Soil_Lyr;
 
 struct _grid_soil_st { //represents the input data for all the soil layers of a cell
-	int num_layers;
+	int num_layers, profile; //profile is the index into grid_Profiles of this cell's unique soil profile
 	Grid_Soil_Lyr* lyr;
 } typedef Grid_Soil_St;
 
+struct _grid_soil_profile_st { //the soilwat site for a unique soil profile, shared by every cell that has that profile
+	SW_SITE site; //site.lyr is allocated in _init_soil_profiles()... the transp_coeff_tree/shrub/grass of its layers are scratch values of the year, which _sxw_sw_setup() writes (in _update_transp_coeff()) before every soilwat run, so they can be shared too; nothing else in the layers may be written after the setup
+	int cell, num_lyrs, next; //first cell with this profile, number of allocated layers (site.n_layers can be one less, see init_site_info()), next profile in the same hash bucket
+	unsigned long hash;
+} typedef Grid_Soil_Profile_St;
+
 struct _grid_disturb_st {
 	int choices[3]; //used as boolean values (ie flags as to whether or not to use the specified disturbance)
 	int kill_yr;
@@ -117,20 +214,78 @@ struct _grid_sxw_st { //holds pointers dynamically allocated by SXW.c
 	RealD *roots_max, *rootsXphen, *roots_active, *roots_active_rel, *roots_active_sum, *phen;
 } typedef Grid_SXW_St;
 
+struct _grid_packed_st { //the packed soilwat state of a cell, see _pack_cell()
+	unsigned char *data;
+	int size, cap; //cap is how much data has room for
+} typedef Grid_Packed_St;
+
+struct _grid_sw_carry_st { //with -j, the soilwat state that is carried from one day to the next outside of SW_Soilwat (in module variables), see _save_carry()
+	SW_WEATHER_2DAYS now; //SW_Weather.now
+	RealD pools[SW_FLW_NPOOLS]; //SW_Flow.c's intercepted & standing water
+	TimeInt runavg_tail; //SW_Weather.c's position in the running average
+	RealD temp_snow; //SW_SoilWater.c's snow temperature
+	ST_RGR_VALUES st; //SW_Flow_lib.c's soil temperature regression, only if it's used
+	unsigned int st_init;
+} typedef Grid_SW_Carry_St;
+
+#define MAX_WORKERS 64 //most processes -j can use
+
+struct _grid_deque_st { //the chunks a worker process has left, see _pool_take()
+	pthread_mutex_t lock;
+	int first, last; //the chunks first .. last - 1
+} typedef Grid_Deque_St;
+
+struct _grid_pool_st { //the chunks of cells the worker processes share out, in memory shared by them (see _pool_init())
+	Grid_Deque_St deque[MAX_WORKERS];
+	pthread_mutex_t lock; //held while stealing, so chunks being stolen are never in no deque while someone looks for some
+	pthread_mutex_t doneLock;
+	long done; //cell-years simulated, for the progress bar
+	int nWorkers;
+} typedef Grid_Pool_St;
+
+struct _grid_pack_layout_st { //where each part of a cell's soilwat state is in pack_Buf, see _pack_layout()
+	SW_SOILWAT *soilwat;
+	SW_VEGPROD *vegprod;
+	RealD *transp;
+	RealF *swc;
+	Grid_SXW_St roots; //only with the soils input
+	size_t size;
+} typedef Grid_Pack_Layout;
+
 /************ Module Variable Declarations ***************/
 /***********************************************************/
 
-#define N_GRID_FILES 9
+#define N_GRID_FILES 10 //the last one, the cell mask file, is optional
 #define N_GRID_DIRECTORIES 1
 
 char *grid_files[N_GRID_FILES], *grid_directories[N_GRID_DIRECTORIES], sd_Sep;
 
-int grid_Cols, grid_Rows, grid_Cells;
+int grid_Cols, grid_Rows, grid_Cells; //grid_Cells is every cell of the rows x cols grid, including the masked out ones
 int UseDisturbances, UseSoils, sd_DoOutput, sd_MakeHeader; //these two are treated like booleans
+int grid_BinaryOutput; //boolean, from the optional 5th line of the grid setup file
+int UseMask; //boolean, from the optional 6th line of the grid setup file
+int grid_Pack; //boolean, from the optional 7th line of the grid setup file (only used with soilwat)
+int grid_Order; //GRID_ORDER_*, from the optional 8th line of the grid setup file
+
+// the orders the cells can be stored & simulated in, see _order_cells()
+#define GRID_ORDER_ROWS 0 //row by row, in cell number order
+#define GRID_ORDER_MORTON 1 //along a Morton (Z) curve
+#define GRID_ORDER_HILBERT 2 //along a Hilbert curve
+
+// the cells that are simulated (all of them without a cell mask)... every array of cell state below is grid_nActive long, in cell number order
+int grid_nActive;
+int *grid_CellIndex; //for each cell number, its index into the grid arrays, or -1 if it's masked out
+int *grid_CellNumber; //for each index into the grid arrays, the cell number
+
+// cell numbers are row by row from 0, rows & cols are base1... always go through these, the grid arrays are only in cell number order with GRID_ORDER_ROWS
+#define _cell_number(row, col) (((row) - 1) * grid_Cols + (col) - 1)
+#define _cell_row(cell) ((cell) / grid_Cols + 1)
+#define _cell_col(cell) ((cell) % grid_Cols + 1)
+#define _cell_index(row, col) (grid_CellIndex[_cell_number(row, col)]) //the index into the grid arrays, -1 if masked out
 
 // these variables are for storing the globals in STEPPE... they are dynamically allocated/freed
-SpeciesType	*grid_Species[MAX_SPECIES];
-GroupType	*grid_RGroup [MAX_RGROUPS];
+Grid_Species_St	*grid_Species[MAX_SPECIES];
+Grid_RGroup_St	*grid_RGroup [MAX_RGROUPS];
 SucculentType	*grid_Succulent;
 EnvType		*grid_Env;
 PlotType	*grid_Plot;
@@ -145,19 +300,95 @@ extern SW_SOILWAT SW_Soilwat;
 extern SW_SITE SW_Site;
 extern SW_VEGPROD SW_VegProd;
 extern SW_WEATHER SW_Weather;
+extern SW_MODEL SW_Model;
 
 // these are grids to store the SOILWAT variables... also dynamically allocated/freed
 SW_SOILWAT *grid_SW_Soilwat;
 SW_SITE *grid_SW_Site;
 SW_VEGPROD *grid_SW_VegProd;
 SW_MODEL *grid_SW_Model;
+Grid_SW_Carry_St *grid_SW_Carry; //only with -j
+
+// from SW_Flow_lib.c, for grid_SW_Carry
+extern ST_RGR_VALUES stValues;
+extern unsigned int soil_temp_init;
+
+// with grid_Pack these are kept packed instead, along with the SXW arrays of the cell (see "about packing the soilwat state of the cells" at the top)
+Grid_Packed_St *grid_Packed;
+static unsigned char *pack_Buf, *pack_Out; //the unpacked state of one cell & room for packing it
+static size_t pack_BufSize;
 
 // these two variables are used to store the soil/distubance inputs for each grid cell... also dynamically allocated/freed
 Grid_Soil_St *grid_Soils;
 Grid_Disturb_St *grid_Disturb;
 
+// the unique soil profiles found in grid_Soils... also dynamically allocated/freed
+Grid_Soil_Profile_St *grid_Profiles;
+int grid_nProfiles;
+
 Grid_SD_St *grid_SD[MAX_SPECIES]; //for seed dispersal
 
+// the cell state store, see "about paging the cell state out to disk" at the top and _store_alloc()
+#define STORE_CHUNK (64 << 20) // bytes of the file that are mapped at a time, a bigger allocation gets a chunk of its own
+#define STORE_PREFETCH_ROWS 1 // rows of cells read ahead while a row is simulated
+#define MAX_STORE_ARRAYS (MAX_SPECIES + MAX_RGROUPS + 16) // arrays of one element per cell that are read ahead
+
+#ifdef GRID_MMAP
+struct _store_chunk_st {
+	char *base;
+	size_t size, used;
+} typedef Store_Chunk;
+
+struct _store_pos_st {
+	int chunk;
+	size_t used;
+} typedef Store_Pos;
+
+static FILE *store_File;
+static off_t store_FileSize;
+static Store_Chunk *store_Chunks;
+static int store_nChunks, store_Cur; // store_Cur is the chunk being allocated from
+static Store_Pos store_Mark; // where the part that is given back every iteration starts
+static Store_Pos *store_CellPos; // where each cell's part of that starts, grid_nActive + 1 long
+static struct { char *base; size_t size; } store_Arrays[MAX_STORE_ARRAYS];
+static int store_nArrays;
+#endif
+
+// for the output stage, see _output_grid()... the cells are handed out one at a time to the threads
+#define MAX_OUTPUT_THREADS 16
+static int out_NextCell, out_CellsDone;
+static pthread_mutex_t out_Lock = PTHREAD_MUTEX_INITIALIZER;
+static clock_t out_Time;
+
+// for -j, see "about the worker processes" at the top
+#define CHUNKS_PER_WORKER 8 //chunks each worker process starts with, so there are some left to steal near the end
+#define COST_STEPPE 1.0 //the estimated cost of a year of a cell is a year of STEPPE,
+#define COST_SOILWAT 3.0 //plus this much with soilwat,
+#define COST_SOILWAT_LAYER 1.25 //and this much for each soil layer (from the -t cost of the 9 & 16 layer cells of the testing inputs)
+int grid_Workers; //the n of -j, 0 without it
+static Bool work_Chunks; //the cells are simulated a chunk at a time by _run_workers() instead of year by year
+RandStream *grid_Rand; //each cell's random number stream, with -j
+static RandStream rand_Dispersal; //the stream of the draws in _do_seed_dispersal() that aren't for one cell, with -j
+static unsigned long rand_Base; //the streams of a run are the streams of this seed
+static Grid_Pool_St *pool;
+static int pool_nChunks, *pool_First; //the first index into the grid arrays of each chunk, pool_nChunks + 1 long (these two aren't shared, they don't change once the workers start)
+static double *pool_Cost; //the estimated cost of the chunks before each chunk, pool_nChunks + 1 long
+
+// the stream of iteration iter for cell number n, or for rand_Dispersal if n is grid_Cells
+#define _stream_number(iter, n) ((unsigned long) (iter) * (grid_Cells + 1) + (n))
+
+// the state every cell starts an iteration from with -j, see _save_start()
+static Grid_Species_St start_Species[MAX_SPECIES];
+static Grid_RGroup_St start_RGroup[MAX_RGROUPS];
+static SucculentType start_Succulent;
+static EnvType start_Env;
+static PlotType start_Plot;
+static ModelType start_Globals;
+static SXW_t start_SXW;
+static SW_SOILWAT start_SW_Soilwat;
+static SW_VEGPROD start_SW_VegProd;
+static Grid_SW_Carry_St start_SW_Carry;
+
 // these are both declared and set in the ST_main.c module
 extern Bool UseSoilwat;
 extern Bool UseProgressBar;
@@ -167,6 +398,7 @@ extern Bool UseProgressBar;
 /***********************************************************/
 
 void runGrid( void ); //to be called from ST_main.c
+void grid_SetWorkers( int n ); //so is this one, for -j
 
 /************* External Function Declarations **************/
 /***********************************************************/
@@ -195,13 +427,14 @@ void Plot_Initialize( void );
 void stat_Collect(Int year);
 void stat_Collect_GMort( void );
 void stat_Collect_SMort( void );
-void stat_Output_AllMorts( void) ;
-void stat_Output_AllBmass(void) ;
-void stat_Output_Seed_Dispersal(const char * filename, const char sep, Bool makeHeader); 
+void stat_Output_Cell( int cell, const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader);
+void stat_Output_Grid_Binary( const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader, int gridRows, int gridCols, const int *cellNumbers, const int *cellIndex);
 void stat_Load_Accumulators(int cell, int year);
 void stat_Save_Accumulators(int cell, int year);
 void stat_Free_Accumulators( void );
 void stat_Init_Accumulators( void );
+void stat_Advise_Accumulators( int cell, int ncells, int advice );
+void stat_Share_Accumulators( void );
 
 //functions from sxw.c
 void free_sxw_memory( void ); 
@@ -219,23 +452,48 @@ void init_site_info(void);
 
 static int _load_bar(char* prefix, clock_t start, int x, int n, int r, int w);
 static double _time_remaining(clock_t start, char* timeChar, double percentDone); 
+static void _run_cell_year( int k, IntS year );
+static void _collect_cell_mort( int k );
+static void _run_workers( void );
+static void _run_worker( int w, clock_t start );
+static double _cell_cost( int k );
+static void _pool_init( int nWorkers );
+static int _pool_take( int w );
+static void _pool_free( void );
+static void _save_start( void );
+static void _restore_start( void );
+static void _save_carry( Grid_SW_Carry_St *to );
+static void _load_carry( const Grid_SW_Carry_St *from );
+static void _free_start( void );
+static void _output_grid( void );
+static void *_output_cells( void *arg );
 static void _init_grid_files( void );
 static void _init_grid_inputs( void );
 static void _init_SXW_inputs( Bool init_SW );
 static void _init_stepwat_inputs( void );
 static void _init_grid_globals( void );
 static void _load_grid_globals( void );
+static void _load_grid_cell( int i );
+static void _free_input_layers( void );
 static void _free_grid_memory( void );
 static void _free_grid_globals( void );
+static void _free_grid_cell( int i );
 static void _load_cell( int row, int col, int year );
 static void _save_cell( int row, int col, int year );
+static void _read_mask_in( void );
+static unsigned long long _curve_key(int cell, unsigned long long side);
+static int _compare_keys(const void *a, const void *b);
+static void _order_cells( void );
 static void _read_disturbances_in( void );
 static void _read_soils_in( void );
+static int  _find_soil_profile(int cell, int *buckets);
+static void _init_soil_profiles( void );
 static void _init_soil_layers(int cell);
 static float _read_a_float(FILE *f, char *buf, const char *filename, const char *descriptor);
 static float _cell_dist(int row1, int row2, int col1, int col2, float cellLen);
 static void _read_seed_dispersal_in( void );
 static void _do_seed_dispersal( void );
+static double _sd_rand( RandStream *stream );
 static void _set_sd_lyppt(int row, int col);
 static void _kill_groups_and_species( void );
 static int  _do_grid_disturbances(int row, int col);
@@ -245,6 +503,22 @@ static void _free_individuals( IndivType *head );
 static void _free_head( IndivType *head );
 static IndivType* _copy_individuals( IndivType *head );
 static IndivType* _copy_head( IndivType *head );
+static void _load_species(SppIndex s, Grid_Species_St *from);
+static void _save_species(SppIndex s, Grid_Species_St *to);
+static void _load_rgroup(GrpIndex c, Grid_RGroup_St *from);
+static void _save_rgroup(GrpIndex c, Grid_RGroup_St *to);
+static void *_store_alloc(size_t nobjs, size_t size, const char *funcname);
+static void *_store_cells(size_t size, const char *funcname);
+static void _store_free(void *block);
+static void _store_mark( void );
+static void _store_rewind( void );
+static void _store_cell(int cell);
+static void _store_page(int first);
+static void _store_free_all( void );
+static void *_pack_part(size_t *pos, size_t bytes);
+static void _pack_layout(Grid_Pack_Layout *l);
+static void _pack_cell(int cell);
+static void _unpack_cell(int cell);
 
 /******************** Begin Model Code *********************/
 /***********************************************************/
@@ -327,134 +601,483 @@ static int _load_bar(char* prefix, clock_t start, int x, int n, int r, int w)
 void runGrid( void ) {
 	// this function sets up & runs the grid
 	
+	prof_Begin(ProfInit);
 	_init_grid_files();				// reads in files.in file
 	_init_stepwat_inputs();				// reads the stepwat inputs in
 	_init_grid_inputs();				// reads the grid inputs in & initializes the global grid variables
+	prof_SetCells(grid_Rows, grid_Cols, grid_nActive);
+	prof_End();
+	prof_MemReport("setup");
 	
 	double prog_Percent = 0.0, prog_Incr, prog_Acc = 0.0;
 	char prog_Prefix[32];
 	clock_t prog_Time;
-	int i, j;
-	Bool killedany;
+	int k;
 	IntS year, iter;
 	if(UseProgressBar) {
-		prog_Incr = (((double)1)/ ((double)((Globals.runModelYears*grid_Cells)*Globals.runModelIterations)));  //gets how much progress we'll make in one year towards our goal of iter*years*cells	
+		prog_Incr = (((double)1)/ ((double)((Globals.runModelYears*grid_nActive)*Globals.runModelIterations)));  //gets how much progress we'll make in one year towards our goal of iter*years*cells	
 		prog_Time = clock();  //used for timing
 		sprintf(prog_Prefix, "simulations: ");
 	}
+	
+	if(grid_Workers) // the seed of the cells' random number streams comes from the model's seed
+		rand_Base = (unsigned long) (RandUni() * 4294967295.0);
 
-	for(iter = 1; iter <= Globals.runModelIterations; iter++) { //for each iteration
+	if(work_Chunks) // the cells don't depend on each other, so they're simulated a chunk at a time, see "about the worker processes" at the top
+		_run_workers();
+	else for(iter = 1; iter <= Globals.runModelIterations; iter++) { //for each iteration
 	
+		trace_Begin(TraceIter, iter);
+		prof_Begin(ProfInit);
 		if (BmassFlags.yearly || MortFlags.yearly)
         		parm_Initialize( iter);
         	
 		Plot_Initialize();
 		if(iter > 1) _free_grid_globals(); //frees the memory from when we called _load_grid_globals() last time... (doesn't need to be called on the first iteration because the memory hasn't been allocated yet)
+		if(grid_Workers) { //with -j every iteration starts from the same state
+			if(iter == 1) _save_start();
+			else _restore_start();
+		}
 		
 		Globals.currIter = iter;
 		_load_grid_globals(); //allocates/initializes grid variables (specifically the ones that are going to change every iter)
+		prof_End();
 		
 		for( year=1; year <= Globals.runModelYears; year++) {//for each year
-			for(i = 1; i <= grid_Rows; i++)
-				for(j = 1; j <= grid_Cols; j++) { //for each cell
-					//fprintf(stderr, "year: %d", year);
-
-					_load_cell(i, j, year);
-	          			Globals.currYear = year;
-				
-					if(year > 1 && UseSeedDispersal)
-						_set_sd_lyppt(i, j);	
-
-					_do_grid_disturbances(i, j);
-					
-					rgroup_Establish();  /* excludes annuals */
-
-          				Env_Generate(); //if UseSoilwat it calls : SXW_Run_SOILWAT() which calls : _sxw_sw_run() which calls : SW_CTL_run_current_year()
-          				
-					rgroup_PartResources();
-					rgroup_Grow();
-					
-					mort_Main( &killedany);
-					
-					rgroup_IncrAges();
-						
-					
-         				stat_Collect(year);
-					mort_EndOfYear();
-         				
-         				_save_cell(i, j, year);
-         		
-         				if(UseProgressBar) {
-         					prog_Percent += prog_Incr; //updating our percent done
-         				if(prog_Percent > prog_Acc) { //only update if 1% progress or more has been made since the last time we updated (this check is so it doesn't waste processing time that could be spent running the simulations by updating all of the time)
-         					prog_Acc += 0.01;
-         					_load_bar(prog_Prefix, prog_Time, (int) (100 * prog_Percent), 100, 100, 10); //display our bar to the console
-         				}
-         			}
-    			} /* end model run for this cell*/
+			trace_Begin(TraceYear, year);
+			prof_Poll();
+			for(k = 0; k < grid_nActive; k++) { //for each cell, in the order they're stored in (grid_Order)
+				if(k % grid_Cols == 0)
+					_store_page(k); // reads the next cells' state in while these are simulated, if it's paged out
+
+				_run_cell_year(k, year);
+     		
+     				if(UseProgressBar) {
+     					prog_Percent += prog_Incr; //updating our percent done
+     				if(prog_Percent > prog_Acc) { //only update if 1% progress or more has been made since the last time we updated (this check is so it doesn't waste processing time that could be spent running the simulations by updating all of the time)
+     					prog_Acc += 0.01;
+     					_load_bar(prog_Prefix, prog_Time, (int) (100 * prog_Percent), 100, 100, 10); //display our bar to the console
+     				}
+     			}
+			} /* end model run for this cell*/
     			
+			prof_Begin(ProfDispersal);
 			if(UseSeedDispersal)
 				_do_seed_dispersal();
+			prof_End();
+			trace_End(TraceYear);
 		}/* end model run for this year*/	
     	
 		// collects the data appropriately for the mort output... (ie. fills the accumulators in ST_stats.c with the values that they need)
 		if(MortFlags.summary)
-			for( i = 1; i <= grid_Rows; i++)
-				for( j = 1; j <= grid_Cols; j++) {
-					_load_cell(i, j, Globals.runModelYears);
-        				stat_Collect_GMort();
-        				stat_Collect_SMort();
-   					_save_cell(i, j, Globals.runModelYears);
-   				}
+			for(k = 0; k < grid_nActive; k++)
+				_collect_cell_mort(k);
+		trace_End(TraceIter);
    					
 	} /*end iterations */
     	if(UseProgressBar) printf("\rsimulations took approximately: %.2f seconds\n", ((double)(clock() - prog_Time) / CLOCKS_PER_SEC));
     
-	if(UseProgressBar) {
- 		prog_Percent = prog_Acc = 0.0;
- 		prog_Incr = ((double)1)/ ((double)grid_Cells);
- 		prog_Time = clock();
- 		sprintf(prog_Prefix, "outputting: ");
-	}	
- 
- 	// outputs all of the mort and BMass files for each cell...
-	for(i = 1; i <= grid_Rows; i++)
-  		for(j = 1; j <= grid_Cols; j++) {	
-  	
-  			int cell = j + ( (i-1) * grid_Cols) - 1;
-  			_load_cell(i, j, 1);
-  			for( year=2; year <= Globals.runModelYears; year++) // _load_cell gets the first years accumulators loaded, so we start at 2...
-  				stat_Load_Accumulators(cell, year);
-  				
-  			char fileMort[1024], fileBMass[1024], fileReceivedProb[1024];
-  		
-			sprintf(fileReceivedProb, "%s%d.out", grid_files[8], cell);
-  			sprintf(fileMort, "%s%d.out", grid_files[7], cell);
-  			sprintf(fileBMass, "%s%d.out", grid_files[6], cell);
-  			parm_SetName(fileMort, F_MortAvg);
-  			parm_SetName(fileBMass, F_BMassAvg);
-  		
-  			if (MortFlags.summary)
-    				stat_Output_AllMorts();
-  			if (BmassFlags.summary)
-    				stat_Output_AllBmass();
-			if (UseSeedDispersal && sd_DoOutput)
-				stat_Output_Seed_Dispersal(fileReceivedProb, sd_Sep, sd_MakeHeader); 
-
-        		if(UseProgressBar) {
-        			prog_Percent += prog_Incr;
-        			if(prog_Percent > prog_Acc) {
-        				prog_Acc += 0.01;
-         				_load_bar(prog_Prefix, prog_Time, 100 * prog_Percent, 100, 100, 10);
-         			}
-         		}
-    		
-    	}
-	if(UseProgressBar) printf("\routputting files took approximately %.2f seconds\n", ((double)(clock() - prog_Time) / CLOCKS_PER_SEC));
+	prof_Begin(ProfOutput);
+	_output_grid(); // outputs all of the mort and BMass files for each cell...
+	prof_End();
+
+	if(UseSoilwat) { // reports the SOILWAT memo cache & emulator statistics, if they were used
+		SXW_MemoFree();
+		SXW_EmuFree();
+	}
 	_free_grid_memory(); // free our allocated memory since we do not need it anymore
 	/*if(UseProgressBar)*/ printf("!\n");
 }
 
+/***********************************************************/
+void grid_SetWorkers( int n ) {
+	// sets the number of processes that simulate the cells (-j, at least 1), see "about the worker processes" at the top... more than MAX_WORKERS are MAX_WORKERS
+	
+	grid_Workers = min(n, MAX_WORKERS);
+}
+
+/***********************************************************/
+static void _run_cell_year( int k, IntS year ) {
+	// simulates a year of the cell at index k of the grid arrays, loading it first & saving it after
+	
+	int cell = grid_CellNumber[k], i = _cell_row(cell), j = _cell_col(cell);
+	Bool killedany;
+
+	trace_Begin(TraceCell, cell);
+	prof_SetCell(cell);
+	prof_Begin(ProfLoadCell);
+	_load_cell(i, j, year);
+	prof_End();
+	Globals.currYear = year;
+			
+	prof_Begin(ProfDispersal);
+	if(year > 1 && UseSeedDispersal)
+		_set_sd_lyppt(i, j);	
+	prof_End();
+
+	prof_Begin(ProfEnviron);
+	_do_grid_disturbances(i, j);
+	prof_End();
+				
+	prof_Begin(ProfEstablish);
+	rgroup_Establish();  /* excludes annuals */
+	prof_End();
+
+	prof_Begin(ProfEnviron);
+	Env_Generate(); //if UseSoilwat it calls : SXW_Run_SOILWAT() which calls : _sxw_sw_run() which calls : SW_CTL_run_current_year()
+	prof_End();
+      				
+	prof_Begin(ProfPartRes);
+	rgroup_PartResources();
+	prof_End();
+	prof_Begin(ProfGrow);
+	rgroup_Grow();
+	prof_End();
+				
+	prof_Begin(ProfMort);
+	mort_Main( &killedany);
+				
+	rgroup_IncrAges();
+	prof_End();
+				
+	prof_Begin(ProfStats);
+	stat_Collect(year);
+	prof_End();
+	prof_Begin(ProfMort);
+	mort_EndOfYear();
+	prof_End();
+     				
+	prof_Begin(ProfSaveCell);
+	_save_cell(i, j, year);
+	prof_End();
+	prof_SetCell(-1);
+	trace_End(TraceCell);
+}
+
+/***********************************************************/
+static void _collect_cell_mort( int k ) {
+	// collects the mort output of the cell at index k for the iteration that has just ended
+	
+	int cell = grid_CellNumber[k];
+	
+	prof_SetCell(cell);
+	prof_Begin(ProfLoadCell);
+	_load_cell(_cell_row(cell), _cell_col(cell), Globals.runModelYears);
+	prof_End();
+	prof_Begin(ProfStats);
+	stat_Collect_GMort();
+	stat_Collect_SMort();
+	prof_End();
+	prof_Begin(ProfSaveCell);
+	_save_cell(_cell_row(cell), _cell_col(cell), Globals.runModelYears);
+	prof_End();
+	prof_SetCell(-1);
+}
+
+/***********************************************************/
+static void _run_workers( void ) {
+	// simulates the cells with -j when they don't depend on each other: this process and grid_Workers - 1 forked ones take chunks of cells from the pool (see _pool_take()) until they're all done, see "about the worker processes" at the top
+	
+	pid_t pids[MAX_WORKERS];
+	int w, status, failed = 0;
+	clock_t start = clock();
+	
+	prof_Begin(ProfInit);
+	Plot_Initialize();
+	_save_start(); // the same state the first iteration would start from without -j
+	_free_input_layers();
+	_pool_init(grid_Workers);
+	prof_End();
+	
+	fflush(NULL); // or the workers would write out what's buffered again
+	for(w = 1; w < pool->nWorkers; w++) {
+		pids[w] = fork();
+		if(pids[w] < 0)
+			LogError(logfp, LOGFATAL, "Could not start worker process %d (%s)", w, strerror(errno));
+		if(pids[w] == 0) {
+			prof_Worker(); // the report files belong to this process
+			_run_worker(w, start);
+			fflush(NULL);
+			_exit(0);
+		}
+	}
+	_run_worker(0, start); // this process does its share too
+	
+	for(w = 1; w < pool->nWorkers; w++)
+		if(waitpid(pids[w], &status, 0) != pids[w] || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			failed++;
+	if(failed)
+		LogError(logfp, LOGFATAL, "%d of the %d worker processes failed, see the log file", failed, pool->nWorkers - 1);
+	
+	_pool_free();
+}
+
+/***********************************************************/
+static void _run_worker( int w, clock_t start ) {
+	// simulates the chunks that worker process w gets from the pool, each one through every iteration & year... the cells of a chunk are only allocated while it's being simulated
+	// start is when the simulations started, for the progress bar (only shown by this process, worker 0)
+	
+	int chunk, k, first, last, percent, shown = -1;
+	IntS year, iter;
+	long cellYears = (long) Globals.runModelIterations * Globals.runModelYears * grid_nActive;
+	
+	while((chunk = _pool_take(w)) >= 0) {
+		first = pool_First[chunk];
+		last = pool_First[chunk + 1];
+		prof_AddCells(last - first); // the phases are only timed in this process
+		
+		for(iter = 1; iter <= Globals.runModelIterations; iter++) {
+			trace_Begin(TraceIter, iter);
+			prof_Begin(ProfInit);
+			Plot_Initialize();
+			_restore_start();
+			Globals.currIter = iter;
+			for(k = first; k < last; k++)
+				_load_grid_cell(k);
+			prof_End();
+			
+			for(year = 1; year <= Globals.runModelYears; year++) {
+				trace_Begin(TraceYear, year);
+				prof_Poll();
+				for(k = first; k < last; k++)
+					_run_cell_year(k, year);
+				
+				pthread_mutex_lock(&pool->doneLock);
+				pool->done += last - first;
+				percent = (int) ((100 * pool->done) / cellYears);
+				pthread_mutex_unlock(&pool->doneLock);
+				if(UseProgressBar && w == 0 && percent != shown) {
+					_load_bar("simulations: ", start, percent, 100, 100, 10);
+					shown = percent;
+				}
+				trace_End(TraceYear);
+			}
+			
+			if(MortFlags.summary)
+				for(k = first; k < last; k++)
+					_collect_cell_mort(k);
+			for(k = first; k < last; k++)
+				_free_grid_cell(k);
+			trace_End(TraceIter);
+		}
+		
+		if(grid_Pack) // the chunk is done with
+			for(k = first; k < last; k++) {
+				Mem_Free(grid_Packed[k].data);
+				grid_Packed[k].data = NULL;
+				grid_Packed[k].size = grid_Packed[k].cap = 0;
+			}
+	}
+}
+
+/***********************************************************/
+static double _cell_cost( int k ) {
+	// the estimated cost of a year of the cell at index k of the grid arrays (see COST_STEPPE), from its soil layers... the cells start every iteration empty, so there's nothing else to go on before they're simulated
+	
+	double cost = COST_STEPPE;
+	
+	if(UseSoilwat)
+		cost += COST_SOILWAT + COST_SOILWAT_LAYER * ((UseSoils) ? grid_Soils[grid_CellNumber[k]].num_layers : SW_Site.n_layers);
+	return cost;
+}
+
+/***********************************************************/
+static void _pool_init( int nWorkers ) {
+	// cuts the cells into chunks of about the same estimated cost (in the order they're stored in, so with a curve order they're close together), and deals each worker a run of them, in memory the worker processes share
+	
+	pthread_mutexattr_t attr;
+	double total, per;
+	int k, c, w;
+	
+	if(nWorkers > grid_nActive) nWorkers = grid_nActive;
+	pool_nChunks = min(grid_nActive, nWorkers * CHUNKS_PER_WORKER);
+	pool_First = Mem_Calloc(pool_nChunks + 1, sizeof(int), "_pool_init()");
+	pool_Cost = Mem_Calloc(pool_nChunks + 1, sizeof(double), "_pool_init()");
+	
+	for(total = 0, k = 0; k < grid_nActive; k++)
+		total += _cell_cost(k);
+	per = total / pool_nChunks;
+	
+	// a chunk ends once the cells so far have the cost of the chunks so far, but every chunk gets at least one cell
+	for(total = 0, c = 1, k = 0; k < grid_nActive && c < pool_nChunks; k++) {
+		total += _cell_cost(k);
+		if(total >= c * per || grid_nActive - (k + 1) == pool_nChunks - c) {
+			pool_First[c] = k + 1;
+			pool_Cost[c++] = total;
+		}
+	}
+	pool_First[pool_nChunks] = grid_nActive;
+	for(; k < grid_nActive; k++)
+		total += _cell_cost(k);
+	pool_Cost[pool_nChunks] = total;
+	
+	pool = mmap(NULL, sizeof(Grid_Pool_St), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(pool == MAP_FAILED)
+		LogError(logfp, LOGFATAL, "_pool_init(): could not map the pool of chunks (%s)", strerror(errno));
+	memset(pool, 0, sizeof(Grid_Pool_St));
+	pool->nWorkers = nWorkers;
+	
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutex_init(&pool->lock, &attr);
+	pthread_mutex_init(&pool->doneLock, &attr);
+	for(w = 0; w < nWorkers; w++) {
+		pthread_mutex_init(&pool->deque[w].lock, &attr);
+		pool->deque[w].first = (int) ((long) w * pool_nChunks / nWorkers);
+		pool->deque[w].last = (int) ((long) (w + 1) * pool_nChunks / nWorkers);
+	}
+	pthread_mutexattr_destroy(&attr);
+}
+
+/***********************************************************/
+static int _pool_take( int w ) {
+	// the next chunk for worker w: the first one it has left, or if it has none, one it steals along with the back half (by estimated cost) of the chunks of the worker with the most estimated cost left... -1 when there are none left anywhere
+	
+	Grid_Deque_St *d = &pool->deque[w], *v;
+	int chunk = -1, i, mid, victim;
+	double left, most, half;
+	
+	pthread_mutex_lock(&d->lock);
+	if(d->first < d->last)
+		chunk = d->first++;
+	pthread_mutex_unlock(&d->lock);
+	if(chunk >= 0) return chunk;
+	
+	pthread_mutex_lock(&pool->lock);
+	for(;;) {
+		victim = -1;
+		most = 0;
+		for(i = 0; i < pool->nWorkers; i++) {
+			v = &pool->deque[i];
+			pthread_mutex_lock(&v->lock);
+			left = (v->first < v->last) ? pool_Cost[v->last] - pool_Cost[v->first] : 0;
+			pthread_mutex_unlock(&v->lock);
+			if(left > most) {
+				most = left;
+				victim = i;
+			}
+		}
+		if(victim < 0) break; // all taken
+		
+		v = &pool->deque[victim];
+		pthread_mutex_lock(&v->lock);
+		if(v->first < v->last) { // the victim may have taken its last one meanwhile
+			// the victim keeps its front chunk, unless it's the only one left
+			half = (pool_Cost[v->first] + pool_Cost[v->last]) / 2;
+			mid = (v->last - v->first == 1) ? v->first : v->first + 1;
+			while(mid < v->last - 1 && pool_Cost[mid] < half) mid++;
+			chunk = mid;
+			i = v->last;
+			v->last = mid;
+		}
+		pthread_mutex_unlock(&v->lock);
+		
+		if(chunk >= 0) {
+			pthread_mutex_lock(&d->lock);
+			d->first = chunk + 1;
+			d->last = i;
+			pthread_mutex_unlock(&d->lock);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+	
+	return chunk;
+}
+
+/***********************************************************/
+static void _pool_free( void ) {
+	// frees what _pool_init() allocated
+	int w;
+	
+	pthread_mutex_destroy(&pool->lock);
+	pthread_mutex_destroy(&pool->doneLock);
+	for(w = 0; w < pool->nWorkers; w++)
+		pthread_mutex_destroy(&pool->deque[w].lock);
+	munmap(pool, sizeof(Grid_Pool_St));
+	pool = NULL;
+	Mem_Free(pool_First);
+	Mem_Free(pool_Cost);
+}
+
+/***********************************************************/
+static void _output_grid( void ) {
+	// writes the output files of every cell.  The files are formatted straight from the cell's accumulators in ST_stats.c, so the cells don't need to be loaded, and the cells are spread across up to MAX_OUTPUT_THREADS threads.
+	
+	pthread_t threads[MAX_OUTPUT_THREADS];
+	int i, n, nThreads = (int) sysconf(_SC_NPROCESSORS_ONLN), *numbers = grid_CellNumber, *index = NULL;
+	
+	if(grid_BinaryOutput) { // one file for each kind of output, holding every cell in cell number order whatever order they're stored in
+		if(grid_Order != GRID_ORDER_ROWS) {
+			numbers = Mem_Calloc(grid_nActive, sizeof(int), "_output_grid()");
+			index = Mem_Calloc(grid_nActive, sizeof(int), "_output_grid()");
+			for(i = n = 0; i < grid_Cells; i++)
+				if(grid_CellIndex[i] >= 0) {
+					numbers[n] = i;
+					index[n++] = grid_CellIndex[i];
+				}
+		}
+		stat_Output_Grid_Binary(grid_files[7], grid_files[6], (UseSeedDispersal && sd_DoOutput) ? grid_files[8] : NULL, sd_Sep, sd_MakeHeader, grid_Rows, grid_Cols, (grid_nActive < grid_Cells) ? numbers : NULL, index);
+		if(grid_Order != GRID_ORDER_ROWS) {
+			Mem_Free(numbers);
+			Mem_Free(index);
+		}
+		return;
+	}
+	
+	if(nThreads < 1) nThreads = 1;
+	if(nThreads > MAX_OUTPUT_THREADS) nThreads = MAX_OUTPUT_THREADS;
+	if(nThreads > grid_nActive) nThreads = grid_nActive;
+	
+	out_NextCell = out_CellsDone = 0;
+	out_Time = clock();
+	
+	for(i = 1; i < nThreads; i++) // this thread does its share too
+		if(pthread_create(&threads[i], NULL, _output_cells, "output") != 0)
+			LogError(logfp, LOGFATAL, "Could not start output thread %d", i);
+	_output_cells(NULL);
+	for(i = 1; i < nThreads; i++)
+		pthread_join(threads[i], NULL);
+	
+	if(UseProgressBar) printf("\routputting files took approximately %.2f seconds\n", ((double)(clock() - out_Time) / CLOCKS_PER_SEC));
+}
+
+/***********************************************************/
+static void *_output_cells( void *arg ) {
+	// takes cells from out_NextCell until they're all written... run by every output thread
+	// out_NextCell is an index into the grid arrays, the files are named with the cell number
+	
+	char fileMort[1024], fileBMass[1024], fileReceivedProb[1024];
+	int i, cell;
+	
+	if(arg) trace_Thread((const char *) arg); // arg is the thread's name, or NULL for the main thread
+	
+	for(;;) {
+		pthread_mutex_lock(&out_Lock);
+		i = out_NextCell++;
+		pthread_mutex_unlock(&out_Lock);
+		if(i >= grid_nActive) break;
+		cell = grid_CellNumber[i];
+		
+		sprintf(fileReceivedProb, "%s%d.out", grid_files[8], cell);
+		sprintf(fileMort, "%s%d.out", grid_files[7], cell);
+		sprintf(fileBMass, "%s%d.out", grid_files[6], cell);
+		trace_Begin(TraceOutputCell, cell);
+		stat_Output_Cell(i, fileMort, fileBMass, (UseSeedDispersal && sd_DoOutput) ? fileReceivedProb : NULL, sd_Sep, sd_MakeHeader);
+		trace_End(TraceOutputCell);
+		
+		if(UseProgressBar) {
+			pthread_mutex_lock(&out_Lock);
+			out_CellsDone++;
+			if((100 * out_CellsDone) / grid_nActive != (100 * (out_CellsDone - 1)) / grid_nActive) // only update the bar once every 1%
+				_load_bar("outputting: ", out_Time, (100 * out_CellsDone) / grid_nActive, 100, 100, 10);
+			pthread_mutex_unlock(&out_Lock);
+		}
+	}
+	
+	return NULL;
+}
+
 /***********************************************************/
 static void _init_grid_files( void ) {
 	// reads the files.in file
@@ -475,7 +1098,9 @@ static void _init_grid_files( void ) {
     		if(!GetALine(f, buf)) break;
     		grid_files[i] = Str_Dup(Str_TrimLeftQ(buf));
     	}
-    	if(i !=  N_GRID_FILES) LogError(stderr, LOGFATAL, "Invalid files.in");
+    	if(i < N_GRID_FILES - 1) LogError(stderr, LOGFATAL, "Invalid files.in"); //the cell mask file can be left out
+    	for(; i < N_GRID_FILES; i++)
+    		grid_files[i] = NULL;
     
     	// opens the log file...
     	if ( !strcmp("stdout", grid_files[0]) )
@@ -505,13 +1130,12 @@ static void _init_grid_inputs( void ) {
 	if(i != 2)
 		LogError(logfp, LOGFATAL, "Invalid grid setup file (rows/cols line wrong)");
 	
+	if(grid_Rows < 1 || grid_Cols < 1)
+		LogError(logfp, LOGFATAL, "Invalid grid setup file (rows/cols must be at least 1)");
+	if(grid_Rows > INT_MAX / grid_Cols)
+		LogError(logfp, LOGFATAL, "Invalid grid setup file (%d rows x %d cols is too many cells)", grid_Rows, grid_Cols);
 	grid_Cells = grid_Cols * grid_Rows;
 	
-	if(grid_Cells > MAX_CELLS)
-		LogError(logfp, LOGFATAL, "Number of cells in grid exceeds MAX_CELLS defined in ST_defines.h");
-		
-	Globals.nCells = (grid_Cols * grid_Rows);
-	
 	GetALine(f, buf);
 	i=sscanf( buf, "%d", &UseDisturbances );
 	if(i != 1)
@@ -527,17 +1151,69 @@ static void _init_grid_inputs( void ) {
 	if(i != 1)
 		LogError(logfp, LOGFATAL, "Invalid grid setup file (seed dispersal line wrong)");
 	UseSeedDispersal = itob(j);	
+	
+	grid_BinaryOutput = 0; // this line is optional, so older setup files still work
+	if(GetALine(f, buf)) {
+		i=sscanf( buf, "%d", &grid_BinaryOutput );
+		if(i != 1)
+			LogError(logfp, LOGFATAL, "Invalid grid setup file (binary output line wrong)");
+	}
+	
+	UseMask = 0; // so is this one, it can only be given after the binary output line
+	if(GetALine(f, buf)) {
+		i=sscanf( buf, "%d", &UseMask );
+		if(i != 1)
+			LogError(logfp, LOGFATAL, "Invalid grid setup file (cell mask line wrong)");
+		if(UseMask && grid_files[9] == NULL)
+			LogError(logfp, LOGFATAL, "Invalid grid setup file (a cell mask is used, but files.in doesn't name the cell mask file)");
+	}
+	
+	grid_Pack = 0; // and this one after the cell mask line
+	if(GetALine(f, buf)) {
+		i=sscanf( buf, "%d", &grid_Pack );
+		if(i != 1)
+			LogError(logfp, LOGFATAL, "Invalid grid setup file (pack soilwat state line wrong)");
+	}
+	if(!UseSoilwat) grid_Pack = 0; // there's nothing to pack
+	
+	grid_Order = GRID_ORDER_ROWS; // and this one after the pack line
+	if(GetALine(f, buf)) {
+		i=sscanf( buf, "%d", &grid_Order );
+		if(i != 1 || grid_Order < GRID_ORDER_ROWS || grid_Order > GRID_ORDER_HILBERT)
+			LogError(logfp, LOGFATAL, "Invalid grid setup file (cell order line wrong)");
+	}
 
 	CloseFile(&f);
 	
+	_read_mask_in(); // sets up grid_CellIndex & grid_CellNumber, even without a mask
+	Globals.nCells = grid_nActive;
+	
+#ifdef GRID_MMAP
+	work_Chunks = FALSE; // the cell state file isn't shared by the worker processes
+#else
+	work_Chunks = grid_Workers && !UseSeedDispersal; // seed dispersal needs every cell done with a year before the next
+#endif
+	if(grid_Workers > 1 && !work_Chunks)
+		LogError(logfp, LOGNOTE, "The cells can't be simulated in worker processes (-j) with seed dispersal or a cell state file, they are simulated here");
+	if(work_Chunks && grid_Workers > 1)
+		stat_Share_Accumulators(); // the worker processes all add to them
+	if(work_Chunks && (GT(SXW.memo_quantum, 0.) || SXW.emu_refresh)) {
+		LogError(logfp, LOGNOTE, "The SOILWAT year cache (-m) and surrogate (-x) are turned off with worker processes (-j), each process would keep its own and the results would depend on which cells it simulated");
+		SXW.memo_quantum = 0.;
+		SXW.emu_refresh = 0;
+	}
+	
 	_init_grid_globals(); // initializes the global grid variables
 	if(UseDisturbances)	
 		_read_disturbances_in();
-	if(UseSoils && UseSoilwat)
+	if(UseSoils && UseSoilwat) {
 		_read_soils_in();
+		_init_soil_profiles();
+	}
 	if(UseSeedDispersal)
 		_read_seed_dispersal_in();
 	
+	_store_mark(); // the store from here on is what _load_grid_globals() allocates every iteration
 }
 
 /***********************************************************/
@@ -609,28 +1285,243 @@ static IndivType* _copy_head( IndivType *head ) {
 }
 
 /**********************************************************/
-static void _copy_species(SpeciesType* to, SpeciesType* from, Bool deep) {
-	if(deep) {
-		Mem_Free(to->kills);
-		Mem_Free(to->seedprod);
-		_free_head(to->IndvHead); //free_head() frees the memory allocated by the head and the memory allocated by each part of the linked list
-	}
+static void _load_species(SppIndex s, Grid_Species_St *from) {
+	//copies a cell's species state into Species[s]... kills and seedprod are always the same size, so they are copied into Species[s]'s own arrays (see _init_grid_globals())
+	SpeciesType *to = Species[s];
+	
+	_free_head(to->IndvHead); //free_head() frees the memory allocated by the head and the memory allocated by each part of the linked list
+	
+	to->est_count = from->est_count;
+	to->estabs = from->estabs;
+	to->relsize = from->relsize;
+	to->extragrowth = from->extragrowth;
+	to->received_prob = from->received_prob;
+	to->seedling_estab_prob = from->seedling_estab_prob;
+	to->allow_growth = from->allow_growth;
+	
+	memcpy(to->kills, from->kills, to->max_age * sizeof(IntUS));
+	memcpy(to->seedprod, from->seedprod, to->viable_yrs * sizeof(RealF));
+	to->IndvHead = _copy_head(from->IndvHead); //copy_head() deep copies the linked list structure (allocating memory when needed)... it will even allocate memory for the head of the list
+}
 
-	//*to = *from;
+/**********************************************************/
+static void _save_species(SppIndex s, Grid_Species_St *to) {
+	//copies Species[s]'s state into a cell, the cell's kills and seedprod must already be allocated
+	SpeciesType *from = Species[s];
+	
+	_free_head(to->IndvHead);
+	
 	to->est_count = from->est_count;
 	to->estabs = from->estabs;
 	to->relsize = from->relsize;
 	to->extragrowth = from->extragrowth;
+	to->received_prob = from->received_prob;
+	to->seedling_estab_prob = from->seedling_estab_prob;
 	to->allow_growth = from->allow_growth;
+	
+	memcpy(to->kills, from->kills, from->max_age * sizeof(IntUS));
+	memcpy(to->seedprod, from->seedprod, from->viable_yrs * sizeof(RealF));
+	to->IndvHead = _copy_head(from->IndvHead);
+}
+
+/**********************************************************/
+static void _load_rgroup(GrpIndex c, Grid_RGroup_St *from) {
+	//copies a cell's group state into RGroup[c]
+	GroupType *to = RGroup[c];
+	
+	to->estabs = from->estabs;
+	to->killyr = from->killyr;
+	to->yrs_neg_pr = from->yrs_neg_pr;
+	to->mm_extra_res = from->mm_extra_res;
+	to->res_required = from->res_required;
+	to->res_avail = from->res_avail;
+	to->res_extra = from->res_extra;
+	to->pr = from->pr;
+	to->relsize = from->relsize;
+	to->est_count = from->est_count;
+	memcpy(to->est_spp, from->est_spp, sizeof(from->est_spp));
+	to->extirpated = from->extirpated;
+	to->regen_ok = from->regen_ok;
+	
+	memcpy(to->kills, from->kills, to->max_age * sizeof(IntUS));
+}
+
+/**********************************************************/
+static void _save_rgroup(GrpIndex c, Grid_RGroup_St *to) {
+	//copies RGroup[c]'s state into a cell, the cell's kills must already be allocated
+	GroupType *from = RGroup[c];
+	
+	to->estabs = from->estabs;
+	to->killyr = from->killyr;
+	to->yrs_neg_pr = from->yrs_neg_pr;
+	to->mm_extra_res = from->mm_extra_res;
+	to->res_required = from->res_required;
+	to->res_avail = from->res_avail;
+	to->res_extra = from->res_extra;
+	to->pr = from->pr;
+	to->relsize = from->relsize;
+	to->est_count = from->est_count;
+	memcpy(to->est_spp, from->est_spp, sizeof(to->est_spp));
+	to->extirpated = from->extirpated;
+	to->regen_ok = from->regen_ok;
+	
+	memcpy(to->kills, from->kills, from->max_age * sizeof(IntUS));
+}
+
+/***********************************************************/
+static void *_store_alloc(size_t nobjs, size_t size, const char *funcname) {
+	// allocates zeroed memory for the state of the cells, to be given back with _store_free()... with GRID_MMAP it comes from the cell state file (see the top of the file), otherwise from Mem_Calloc()
+#ifdef GRID_MMAP
+	size_t bytes = (nobjs * size + 15) & ~((size_t) 15), chunk, page; // everything stays 16 byte aligned
+	Store_Chunk *c;
+	char *p;
+	
+	while(store_Cur < store_nChunks && store_Chunks[store_Cur].size - store_Chunks[store_Cur].used < bytes)
+		if(++store_Cur < store_nChunks) // the chunks after store_Cur are only there after a _store_rewind(), they are used again from the start
+			store_Chunks[store_Cur].used = 0;
+	
+	if(store_Cur == store_nChunks) { // maps another chunk at the end of the file
+		page = (size_t) sysconf(_SC_PAGESIZE);
+		chunk = (max(bytes, STORE_CHUNK) + page - 1) / page * page;
+		if(store_File == NULL && (store_File = tmpfile()) == NULL)
+			LogError(logfp, LOGFATAL, "Can't create the cell state file in %s", funcname);
+		if(ftruncate(fileno(store_File), store_FileSize + chunk) != 0)
+			LogError(logfp, LOGFATAL, "Can't grow the cell state file to %lu bytes in %s", (unsigned long) (store_FileSize + chunk), funcname);
+		
+		store_Chunks = (store_nChunks == 0) ? Mem_Calloc(1, sizeof(Store_Chunk), "_store_alloc()") : Mem_ReAlloc(store_Chunks, (store_nChunks + 1) * sizeof(Store_Chunk));
+		c = &store_Chunks[store_nChunks++];
+		c->base = mmap(NULL, chunk, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(store_File), store_FileSize);
+		if(c->base == MAP_FAILED)
+			LogError(logfp, LOGFATAL, "Can't map %lu bytes of the cell state file in %s", (unsigned long) chunk, funcname);
+		c->size = chunk;
+		c->used = 0;
+		store_FileSize += chunk;
+	}
+	
+	c = &store_Chunks[store_Cur];
+	p = c->base + c->used;
+	c->used += bytes;
+	memset(p, 0, nobjs * size); // new chunks are zero already, but not the ones used again
+	return p;
+#else
+	return Mem_Calloc(nobjs, size, funcname);
+#endif
+}
+
+/***********************************************************/
+static void *_store_cells(size_t size, const char *funcname) {
+	// allocates one zeroed element of size bytes for each simulated cell, for the arrays that _store_page() reads ahead
+	void *p = _store_alloc(grid_nActive, size, funcname);
+	
+#ifdef GRID_MMAP
+	if(store_nArrays < MAX_STORE_ARRAYS) {
+		store_Arrays[store_nArrays].base = p;
+		store_Arrays[store_nArrays].size = size;
+		store_nArrays++;
+	}
+#endif
+	return p;
+}
+
+/***********************************************************/
+static void _store_free(void *block) {
+	// gives back memory from _store_alloc()... the cell state file is only given back all at once (_store_rewind() & _store_free_all())
+#ifndef GRID_MMAP
+	Mem_Free(block);
+#endif
+}
 
-	if(deep) {
-		to->kills = Mem_Calloc(from->max_age, sizeof(IntUS), "_load_cell(Species[s]->kills)");
-		to->seedprod = Mem_Calloc(from->viable_yrs, sizeof(RealF), "_load_cell(Species[s]->seedprod)");
+/***********************************************************/
+static void _store_mark( void ) {
+	// everything allocated from the store after this is given back by _store_rewind()
+#ifdef GRID_MMAP
+	store_Mark.chunk = store_Cur;
+	store_Mark.used = (store_Cur < store_nChunks) ? store_Chunks[store_Cur].used : 0;
+#endif
+}
 
-		memcpy(to->kills, from->kills, from->max_age * sizeof(IntUS));
-		memcpy(to->seedprod, from->seedprod, from->viable_yrs * sizeof(RealF));
-		to->IndvHead = _copy_head(from->IndvHead); //copy_head() deep copies the linked list structure (allocating memory when needed)... it will even allocate memory for the head of the list
+/***********************************************************/
+static void _store_rewind( void ) {
+	// gives back everything allocated from the store since _store_mark(), so the next iteration uses the same part of the file
+#ifdef GRID_MMAP
+	store_Cur = store_Mark.chunk;
+	if(store_Cur < store_nChunks)
+		store_Chunks[store_Cur].used = store_Mark.used;
+#endif
+}
+
+/***********************************************************/
+static void _store_cell(int cell) {
+	// notes that what is allocated from the store next belongs to cell (an index into the grid arrays, grid_nActive for the end of the last cell)
+#ifdef GRID_MMAP
+	store_CellPos[cell].chunk = store_Cur;
+	store_CellPos[cell].used = (store_Cur < store_nChunks) ? store_Chunks[store_Cur].used : 0;
+#endif
+}
+
+#ifdef GRID_MMAP
+/***********************************************************/
+static void _store_advise(int first, int last, int advice) {
+	// passes advice on to madvise() for the state of the cells first up to (not including) last
+	size_t page = (size_t) sysconf(_SC_PAGESIZE);
+	char *from, *to;
+	int k;
+	
+	if(first >= last) return;
+	
+	for(k = 0; k <= store_nArrays; k++) {
+		if(k < store_nArrays) { // the arrays of one element per cell
+			from = store_Arrays[k].base + first * store_Arrays[k].size;
+			to = store_Arrays[k].base + last * store_Arrays[k].size;
+			madvise((void *) ((size_t) from / page * page), to - (char *) ((size_t) from / page * page), advice);
+		} else { // and what each cell's state points to, which can be spread over several chunks
+			int c, c2 = store_CellPos[last].chunk;
+			for(c = store_CellPos[first].chunk; c <= c2 && c < store_nChunks; c++) {
+				from = store_Chunks[c].base + ((c == store_CellPos[first].chunk) ? store_CellPos[first].used : 0);
+				to = store_Chunks[c].base + ((c == c2) ? store_CellPos[last].used : store_Chunks[c].used);
+				if(to > from)
+					madvise((void *) ((size_t) from / page * page), to - (char *) ((size_t) from / page * page), advice);
+			}
+		}
 	}
+	stat_Advise_Accumulators(first, last - first, advice);
+}
+#endif
+
+/***********************************************************/
+static void _store_page(int first) {
+	// called before a row's worth of cells (grid_Cols, in the order they're stored in) starting at index first are simulated: reads the state of the next STORE_PREFETCH_ROWS rows' worth ahead, and marks the ones before as the first to page out
+#ifdef GRID_MMAP
+	int next = first + grid_Cols, last;
+	
+	if(next >= grid_nActive) next = 0; // the first cells of the next year
+	last = min(next + STORE_PREFETCH_ROWS * grid_Cols, grid_nActive);
+	_store_advise(next, last, MADV_WILLNEED);
+  #ifdef MADV_COLD
+	if(first >= grid_Cols)
+		_store_advise(first - grid_Cols, first, MADV_COLD);
+  #endif
+#endif
+}
+
+/***********************************************************/
+static void _store_free_all( void ) {
+	// unmaps the cell state file, which goes away with it since it's unlinked
+#ifdef GRID_MMAP
+	int c;
+	
+	for(c = 0; c < store_nChunks; c++)
+		munmap(store_Chunks[c].base, store_Chunks[c].size);
+	if(store_nChunks > 0)
+		Mem_Free(store_Chunks);
+	if(store_File != NULL)
+		fclose(store_File);
+	Mem_Free(store_CellPos);
+	store_Chunks = NULL;
+	store_File = NULL;
+	store_nChunks = store_Cur = store_nArrays = 0;
+	store_FileSize = 0;
+#endif
 }
 
 /***********************************************************/
@@ -641,147 +1532,320 @@ static void _init_grid_globals( void ) {
 	SppIndex s;
 	int i;
 	
-	grid_Succulent = Mem_Calloc(grid_Cells, sizeof(SucculentType), "_init_grid_globals()");
-	grid_Env = Mem_Calloc(grid_Cells, sizeof(EnvType), "_init_grid_globals()");
-	grid_Plot = Mem_Calloc(grid_Cells, sizeof(PlotType), "_init_grid_globals()");
-	grid_Globals = Mem_Calloc(grid_Cells, sizeof(ModelType), "_init_grid_globals()");
+	grid_Succulent = _store_cells(sizeof(SucculentType), "_init_grid_globals()");
+	grid_Env = _store_cells(sizeof(EnvType), "_init_grid_globals()");
+	grid_Plot = _store_cells(sizeof(PlotType), "_init_grid_globals()");
+	grid_Globals = _store_cells(sizeof(ModelType), "_init_grid_globals()");
 	
 	ForEachSpecies(s)
-		if(Species[s]->use_me) grid_Species[s] = Mem_Calloc(grid_Cells, sizeof(SpeciesType), "_init_grid_globals()");
+		if(Species[s]->use_me) grid_Species[s] = _store_cells(sizeof(Grid_Species_St), "_init_grid_globals()");
+	ForEachGroup(c)
+		if(RGroup[c]->use_me) grid_RGroup[c] = _store_cells(sizeof(Grid_RGroup_St), "_init_grid_globals()");
+	
+	//the cells' states are copied in and out of Species[] & RGroup[] without reallocating, so make sure the arrays they hold exist (they are NULL if the mortality output isn't on)
+	ForEachSpecies(s) {
+		if(!Species[s]->use_me) continue;
+		if(Species[s]->kills == NULL) Species[s]->kills = Mem_Calloc(Species[s]->max_age, sizeof(IntUS), "_init_grid_globals()");
+		if(Species[s]->seedprod == NULL) Species[s]->seedprod = Mem_Calloc(Species[s]->viable_yrs, sizeof(RealF), "_init_grid_globals()");
+	}
 	ForEachGroup(c)
-		if(RGroup[c]->use_me) grid_RGroup[c] = Mem_Calloc(grid_Cells, sizeof(GroupType), "_init_grid_globals()");
+		if(RGroup[c]->use_me && RGroup[c]->kills == NULL) RGroup[c]->kills = Mem_Calloc(RGroup[c]->max_age, sizeof(IntUS), "_init_grid_globals()");
 	
 	if(UseSoilwat) {
-		grid_SXW = Mem_Calloc(grid_Cells, sizeof(SXW_t), "_init_grid_globals()");
-		grid_SW_Soilwat = Mem_Calloc(grid_Cells, sizeof(SW_SOILWAT), "_init_grid_globals()");
-		grid_SW_Site = Mem_Calloc(grid_Cells, sizeof(SW_SITE), "_init_grid_globals()");
-		grid_SW_VegProd = Mem_Calloc(grid_Cells, sizeof(SW_VEGPROD), "_init_grid_globals()");
+		grid_SXW = _store_cells(sizeof(SXW_t), "_init_grid_globals()");
+		grid_SW_Site = _store_cells(sizeof(SW_SITE), "_init_grid_globals()");
+		if(grid_Pack)
+			grid_Packed = Mem_Calloc(grid_nActive, sizeof(Grid_Packed_St), "_init_grid_globals()");
+		else {
+			grid_SW_Soilwat = _store_cells(sizeof(SW_SOILWAT), "_init_grid_globals()");
+			grid_SW_VegProd = _store_cells(sizeof(SW_VEGPROD), "_init_grid_globals()");
+		}
 		if(UseSoils) {
-			grid_Soils = Mem_Calloc(grid_Cells, sizeof(Grid_Soil_St), "_init_grid_globals()");
+			grid_Soils = Mem_Calloc(grid_Cells, sizeof(Grid_Soil_St), "_init_grid_globals()"); //the soils input is by cell number, masked out cells can still be copied from
 			for(i = 0; i < grid_Cells; i++)
 				grid_Soils[i].num_layers = 0;
-			grid_SXW_ptrs = Mem_Calloc(grid_Cells, sizeof(Grid_SXW_St), "_init_grid_globals()");
+			if(!grid_Pack) grid_SXW_ptrs = _store_cells(sizeof(Grid_SXW_St), "_init_grid_globals()");
+			grid_Profiles = Mem_Calloc(grid_Cells, sizeof(Grid_Soil_Profile_St), "_init_grid_globals()");
 		}
 	}
 	
+	if(grid_Workers) {
+		grid_Rand = _store_cells(sizeof(RandStream), "_init_grid_globals()");
+		if(UseSoilwat) grid_SW_Carry = _store_cells(sizeof(Grid_SW_Carry_St), "_init_grid_globals()");
+	}
 	if(UseDisturbances)
-		grid_Disturb = Mem_Calloc(grid_Cells, sizeof(Grid_Disturb_St), "_init_grid_globals()");
+		grid_Disturb = _store_cells(sizeof(Grid_Disturb_St), "_init_grid_globals()");
 	if(UseSeedDispersal)
 		ForEachSpecies(s)
-			if(Species[s]->use_me && Species[s]->use_dispersal) grid_SD[s] = Mem_Calloc(grid_Cells, sizeof(Grid_SD_St), "_init_grid_globals()");
+			if(Species[s]->use_me && Species[s]->use_dispersal) grid_SD[s] = _store_cells(sizeof(Grid_SD_St), "_init_grid_globals()");
 	
 	stat_Init_Accumulators();
+	
+#ifdef GRID_MMAP
+	store_CellPos = Mem_Calloc(grid_nActive + 1, sizeof(Store_Pos), "_init_grid_globals()");
+#endif
 }
 
 /***********************************************************/
 static void _load_grid_globals( void ) {
 	//this initializes/allocates memory needed... this step is needed to be done for every iteration
 
-	int i, j;
+	int i;
+	
+	if(UseSoils && UseSoilwat && Globals.currIter == 1)
+		_free_input_layers();
+	
+	for(i = 0; i < grid_nActive; i++)
+		_load_grid_cell(i);
+	_store_cell(grid_nActive);
+	
+	if(grid_Workers && UseSeedDispersal) // the stream of the draws that aren't for a cell, after the cells' ones
+		RandSeedStream(&rand_Dispersal, rand_Base, _stream_number(Globals.currIter, grid_Cells));
+}
+
+/***********************************************************/
+static void _free_input_layers( void ) {
+	//the layers read in from the soilwat input files aren't used once the cells get their soil profiles
+	int j;
+	
+	if(!(UseSoils && UseSoilwat)) return;
+	for(j = 0; j < SW_Site.n_layers; j++)
+		Mem_Free(SW_Site.lyr[j]);
+	Mem_Free(SW_Site.lyr);
+}
+
+/***********************************************************/
+static void _load_grid_cell( int i ) {
+	//allocates & initializes the state of the cell at index i of the grid arrays from the state that is loaded (what Plot_Initialize() leaves), at the start of an iteration
+	
 	GrpIndex c;
 	SppIndex s;
 	
-	if(UseSoils && UseSoilwat) ChDir(grid_directories[0]); //change the directory for _init_soil_layers()
-	for(i = 0; i < grid_Cells; i++) {
+	_store_cell(i); // everything allocated from the store for the cell in here is kept together
+	if(grid_Workers) // with -j each cell draws its random numbers from its own stream, see "about the worker processes" at the top
+		RandSeedStream(&grid_Rand[i], rand_Base, _stream_number(Globals.currIter, grid_CellNumber[i]));
+	if(grid_Workers && UseSoilwat)
+		grid_SW_Carry[i] = start_SW_Carry;
 		
-		ForEachSpecies(s) { //macros defined in ST_defines.h
-			if(!Species[s]->use_me) continue;
-			grid_Species[s][i] = *Species[s];
-
-			grid_Species[s][i].kills = Mem_Calloc(Species[s]->max_age, sizeof(IntUS), "_init_grid_globals()");
-			grid_Species[s][i].seedprod = Mem_Calloc(Species[s]->viable_yrs, sizeof(RealF), "_init_grid_globals()");
-			
-			memcpy(grid_Species[s][i].kills, Species[s]->kills, Species[s]->max_age * sizeof(IntUS));
-			memcpy(grid_Species[s][i].seedprod, Species[s]->seedprod, Species[s]->viable_yrs * sizeof(RealF));
+	ForEachSpecies(s) { //macros defined in ST_defines.h
+		if(!Species[s]->use_me) continue;
+		grid_Species[s][i].kills = _store_alloc(Species[s]->max_age, sizeof(IntUS), "_init_grid_globals()");
+		grid_Species[s][i].seedprod = _store_alloc(Species[s]->viable_yrs, sizeof(RealF), "_init_grid_globals()");
+		grid_Species[s][i].IndvHead = NULL;
+		
+		_save_species(s, &grid_Species[s][i]); //deep copies the individuals too (allocating memory when needed)
+	}
+	
+	ForEachGroup(c) {
+		if(!RGroup[c]->use_me) continue;
+		grid_RGroup [c][i].kills = _store_alloc(RGroup[c]->max_age, sizeof(IntUS), "_init_grid_globals()");
+		
+		_save_rgroup(c, &grid_RGroup[c][i]);
+		if(UseDisturbances) 
+			grid_RGroup[c][i].killyr = grid_Disturb[i].kill_yr;
+	}
+		
+	grid_Succulent[i] = Succulent;
+	grid_Env[i] = Env;
+	grid_Plot[i] = Plot;
+	grid_Globals[i] = Globals;
+	
+	if(UseDisturbances) {
+		grid_Globals[i].pat.use = grid_Disturb[i].choices[0];
+		grid_Globals[i].mound.use = grid_Disturb[i].choices[1];
+		grid_Globals[i].burrow.use = grid_Disturb[i].choices[2];
+	}
+	if(UseSoils && UseSoilwat)
+		_init_soil_layers(i);
 			
-			grid_Species[s][i].IndvHead = _copy_head(Species[s]->IndvHead); //copy_head() deep copies the structure (allocating memory when needed)... it will even allocate memory for the head of the list
+	if(UseSoilwat) {
+		grid_SXW[i] = SXW; 
+		grid_SW_Site[i] = SW_Site; //the layers are shared, not copied, since soilwat doesn't change them (they belong to grid_Profiles if UseSoils, otherwise to SW_Site)
+		
+		if(grid_Pack) {
+			grid_SXW[i].transp = NULL;
+			grid_SXW[i].swc = NULL;
+			_pack_cell(i);
+			return;
 		}
 		
-		ForEachGroup(c) {
-			if(!RGroup[c]->use_me) continue;
-			grid_RGroup [c][i] = *RGroup[c];
-			grid_RGroup [c][i].kills = Mem_Calloc(RGroup[c]->max_age, sizeof(IntUS), "_init_grid_globals()");
-			
-			memcpy(grid_RGroup[c][i].kills, RGroup[c]->kills, RGroup[c]->max_age * sizeof(IntUS));
-			if(UseDisturbances) 
-				grid_RGroup[c][i].killyr = grid_Disturb[i].kill_yr;
+		grid_SXW[i].transp = _store_alloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_grid_globals()");
+		grid_SXW[i].swc = _store_alloc(SXW.NPds * SXW.NSoLyrs, sizeof(RealF), "_init_grid_globals()");
+		
+		memcpy(grid_SXW[i].transp, SXW.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		memcpy(grid_SXW[i].swc, SXW.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
+		
+		grid_SW_Soilwat[i] = SW_Soilwat;
+		grid_SW_VegProd[i] = SW_VegProd;
+	}
+}
+
+/***********************************************************/
+static void _free_grid_globals( void ) {
+	//frees memory allocated in _load_grid_globals() function.
+	int i;
+	
+	for( i = 0; i < grid_nActive; i++ )
+		_free_grid_cell(i);
+	_store_rewind(); // the next iteration allocates the same things again
+	
+}
+
+/***********************************************************/
+static void _free_grid_cell( int i ) {
+	//frees the memory _load_grid_cell() allocated for the cell at index i
+	GrpIndex c;
+	SppIndex s;
+	
+	ForEachSpecies(s) {
+		if(!Species[s]->use_me) continue;
+		_store_free(grid_Species[s][i].kills);
+		_store_free(grid_Species[s][i].seedprod);
+		_free_head(grid_Species[s][i].IndvHead);
+		grid_Species[s][i].kills = NULL;
+		grid_Species[s][i].seedprod = NULL;
+		grid_Species[s][i].IndvHead = NULL;
+	}
+	
+	ForEachGroup(c)
+		if(RGroup[c]->use_me) {
+			_store_free(grid_RGroup[c][i].kills);
+			grid_RGroup[c][i].kills = NULL;
 		}
-			
-		grid_Succulent[i] = Succulent;
-		grid_Env[i] = Env;
-		grid_Plot[i] = Plot;
-		grid_Globals[i] = Globals;
 		
-		if(UseDisturbances) {
-			grid_Globals[i].pat.use = grid_Disturb[i].choices[0];
-			grid_Globals[i].mound.use = grid_Disturb[i].choices[1];
-			grid_Globals[i].burrow.use = grid_Disturb[i].choices[2];
+	if(UseSoilwat) {
+		_store_free(grid_SXW[i].transp);
+		_store_free(grid_SXW[i].swc);
+		grid_SXW[i].transp = NULL;
+		grid_SXW[i].swc = NULL;
+		if(UseSoils && !grid_Pack) {
+			_store_free(grid_SXW_ptrs[i].roots_max);
+   			_store_free(grid_SXW_ptrs[i].rootsXphen);
+			_store_free(grid_SXW_ptrs[i].roots_active);
+			_store_free(grid_SXW_ptrs[i].roots_active_rel);
+			_store_free(grid_SXW_ptrs[i].roots_active_sum);
+			_store_free(grid_SXW_ptrs[i].phen);
+			memset(&grid_SXW_ptrs[i], 0, sizeof(Grid_SXW_St));
 		}
-		if(UseSoils && UseSoilwat)
-			_init_soil_layers(i);
-				
-		if(UseSoilwat) {
-			grid_SXW[i] = SXW; 
-			
-			grid_SXW[i].transp = Mem_Calloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_grid_globals()");
-			grid_SXW[i].swc = Mem_Calloc(SXW.NPds * SXW.NSoLyrs, sizeof(RealF), "_init_grid_globals()");
-			
-			memcpy(grid_SXW[i].transp, SXW.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
-			memcpy(grid_SXW[i].swc, SXW.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
-			
-			grid_SW_Soilwat[i] = SW_Soilwat;
-			grid_SW_Site[i] = SW_Site;
-			grid_SW_VegProd[i] = SW_VegProd;
-			
-        		grid_SW_Site[i].lyr = Mem_Calloc(SW_Site.n_layers, sizeof(SW_LAYER_INFO *), "_init_grid_globals()");
-        		for(j = 0; j < SW_Site.n_layers; j++) {
-        			grid_SW_Site[i].lyr[j] = Mem_Calloc(1, sizeof(SW_LAYER_INFO), "_init_grid_globals()");
-        			memcpy(grid_SW_Site[i].lyr[j], SW_Site.lyr[j], sizeof(SW_LAYER_INFO));
-        		}
+	}
+}
+
+/***********************************************************/
+static void _save_start( void ) {
+	//keeps the state that is loaded after Plot_Initialize() in the first iteration, for _restore_start() (only with -j)
+	GrpIndex c;
+	SppIndex s;
+	
+	ForEachSpecies(s) {
+		if(!Species[s]->use_me) continue;
+		start_Species[s].kills = Mem_Calloc(Species[s]->max_age, sizeof(IntUS), "_save_start()");
+		start_Species[s].seedprod = Mem_Calloc(Species[s]->viable_yrs, sizeof(RealF), "_save_start()");
+		start_Species[s].IndvHead = NULL;
+		_save_species(s, &start_Species[s]);
+	}
+	ForEachGroup(c) {
+		if(!RGroup[c]->use_me) continue;
+		start_RGroup[c].kills = Mem_Calloc(RGroup[c]->max_age, sizeof(IntUS), "_save_start()");
+		_save_rgroup(c, &start_RGroup[c]);
+	}
+	
+	start_Succulent = Succulent;
+	start_Env = Env;
+	start_Plot = Plot;
+	start_Globals = Globals;
+	
+	if(UseSoilwat) {
+		start_SXW = SXW;
+		start_SXW.transp = Mem_Calloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_save_start()");
+		memcpy(start_SXW.transp, SXW.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		if(SXW.swc != NULL) {
+			start_SXW.swc = Mem_Calloc(SXW.NPds * SXW.NSoLyrs, sizeof(RealF), "_save_start()");
+			memcpy(start_SXW.swc, SXW.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
 		}
+		start_SW_Soilwat = SW_Soilwat;
+		start_SW_VegProd = SW_VegProd;
+		_save_carry(&start_SW_Carry); // every cell starts with its own, see _load_grid_cell()
 	}
-	if(UseSoils && UseSoilwat) ChDir(".."); //get back to our previous directory
+}
+
+/***********************************************************/
+static void _save_carry( Grid_SW_Carry_St *to ) {
+	//copies the soilwat state that carries over from one day to the next outside of SW_Soilwat into a cell (only with -j)... without -j it carries over from one cell to the next like it always has, but with -j that would depend on which cell was simulated before
 	
+	to->now = SW_Weather.now;
+	SW_FLW_get_pools(to->pools);
+	to->runavg_tail = SW_WTH_get_runavg_tail();
+	to->temp_snow = SW_SWC_get_temp_snow();
+	if(SW_Site.use_soil_temp) {
+		to->st = stValues;
+		to->st_init = soil_temp_init;
+	}
 }
 
 /***********************************************************/
-static void _free_grid_globals( void ) {
-	//frees memory allocated in _load_grid_globals() function.
-	int i, j;
+static void _load_carry( const Grid_SW_Carry_St *from ) {
+	//the reverse of _save_carry()
+	
+	SW_Weather.now = from->now;
+	SW_FLW_set_pools(from->pools);
+	SW_WTH_set_runavg_tail(from->runavg_tail);
+	SW_SWC_set_temp_snow(from->temp_snow);
+	if(SW_Site.use_soil_temp) {
+		stValues = from->st;
+		soil_temp_init = from->st_init; // so each cell sets up the regression for its own layers
+	}
+}
+
+/***********************************************************/
+static void _restore_start( void ) {
+	//loads the state _save_start() kept, after Plot_Initialize(), so every iteration of a cell starts from the same state whatever was loaded before it (only with -j)
 	GrpIndex c;
 	SppIndex s;
 	
-	for( i = 0; i < grid_Cells; i++ ) {
+	ForEachSpecies(s)
+		if(Species[s]->use_me) _load_species(s, &start_Species[s]);
+	ForEachGroup(c)
+		if(RGroup[c]->use_me) _load_rgroup(c, &start_RGroup[c]);
+	
+	Succulent = start_Succulent;
+	Env = start_Env;
+	Plot = start_Plot;
+	Globals = start_Globals;
 	
-		ForEachSpecies(s) {
-			if(!Species[s]->use_me) continue;
-			Mem_Free(grid_Species[s][i].kills);
-			Mem_Free(grid_Species[s][i].seedprod);
-			_free_head(grid_Species[s][i].IndvHead);
-		}
+	if(UseSoilwat) {
+		Mem_Free(SXW.transp);
+		if(SXW.swc != NULL) Mem_Free(SXW.swc);
 		
-		ForEachGroup(c)
-			if(RGroup[c]->use_me) Mem_Free(grid_RGroup[c][i].kills);
-			
-		if(UseSoilwat) {
-			Mem_Free(grid_SXW[i].transp);
-			Mem_Free(grid_SXW[i].swc);
-			if(UseSoils) {
-				Mem_Free(grid_SXW_ptrs[i].roots_max);
-   				Mem_Free(grid_SXW_ptrs[i].rootsXphen);
-				Mem_Free(grid_SXW_ptrs[i].roots_active);
-				Mem_Free(grid_SXW_ptrs[i].roots_active_rel);
-				Mem_Free(grid_SXW_ptrs[i].roots_active_sum);
-				Mem_Free(grid_SXW_ptrs[i].phen);
-			}
-			
-			for(j = 0; j < grid_SW_Site[i].n_layers; j++)
-				Mem_Free(grid_SW_Site[i].lyr[j]);
-			Mem_Free(grid_SW_Site[i].lyr);
+		SXW = start_SXW;
+		SXW.transp = Mem_Calloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_restore_start()");
+		memcpy(SXW.transp, start_SXW.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		if(start_SXW.swc != NULL) {
+			SXW.swc = Mem_Calloc(SXW.NPds * SXW.NSoLyrs, sizeof(RealF), "_restore_start()");
+			memcpy(SXW.swc, start_SXW.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
 		}
-			
+		SW_Soilwat = start_SW_Soilwat;
+		SW_VegProd = start_SW_VegProd;
 	}
+}
+
+/***********************************************************/
+static void _free_start( void ) {
+	//frees what _save_start() allocated
+	GrpIndex c;
+	SppIndex s;
 	
+	ForEachSpecies(s) {
+		if(!Species[s]->use_me) continue;
+		Mem_Free(start_Species[s].kills);
+		Mem_Free(start_Species[s].seedprod);
+		_free_head(start_Species[s].IndvHead);
+	}
+	ForEachGroup(c)
+		if(RGroup[c]->use_me) Mem_Free(start_RGroup[c].kills);
+	if(UseSoilwat) {
+		Mem_Free(start_SXW.transp);
+		if(start_SXW.swc != NULL) Mem_Free(start_SXW.swc);
+	}
 }
 
 /***********************************************************/
@@ -793,45 +1857,67 @@ static void _free_grid_memory( void ) {
 	SppIndex s;
 	
 	_free_grid_globals();
+	if(grid_Workers)
+		_free_start();
 	
 	ForEachSpecies(s)
-		if(Species[s]->use_me) Mem_Free(grid_Species[s]);
+		if(Species[s]->use_me) _store_free(grid_Species[s]);
 	ForEachGroup(c)
-		if(RGroup[c]->use_me) Mem_Free(grid_RGroup[c]);
+		if(RGroup[c]->use_me) _store_free(grid_RGroup[c]);
 	
-	Mem_Free(grid_Succulent);
-	Mem_Free(grid_Env);
-	Mem_Free(grid_Plot);
-	Mem_Free(grid_Globals);
+	_store_free(grid_Succulent);
+	_store_free(grid_Env);
+	_store_free(grid_Plot);
+	_store_free(grid_Globals);
 	if(UseSoilwat) {
-		Mem_Free(grid_SXW);
-		Mem_Free(grid_SW_Soilwat);
-		Mem_Free(grid_SW_Site);
-		Mem_Free(grid_SW_VegProd);
+		_store_free(grid_SXW);
+		_store_free(grid_SW_Soilwat);
+		_store_free(grid_SW_Site);
+		_store_free(grid_SW_VegProd);
+	}
+	if(grid_Pack) {
+		for(i = 0; i < grid_nActive; i++)
+			Mem_Free(grid_Packed[i].data);
+		Mem_Free(grid_Packed);
+		Mem_Free(pack_Buf);
+		Mem_Free(pack_Out);
 	}
 	
 	if(UseSoils && UseSoilwat) {
 		free_all_sxw_memory();
-		Mem_Free(grid_SXW_ptrs);
+		_store_free(grid_SXW_ptrs);
 		for( i=0; i < grid_Cells; i++)
 			Mem_Free(grid_Soils[i].lyr);
 		Mem_Free(grid_Soils);
+		for( i=0; i < grid_nProfiles; i++) {
+			Mem_Free(grid_Profiles[i].site.lyr[0]); //all of the layers of a profile are one block
+			Mem_Free(grid_Profiles[i].site.lyr);
+		}
+		Mem_Free(grid_Profiles);
+	}
+	if(grid_Workers) {
+		_store_free(grid_Rand);
+		if(UseSoilwat) _store_free(grid_SW_Carry);
 	}
 	if(UseDisturbances)
-		Mem_Free(grid_Disturb);
+		_store_free(grid_Disturb);
 	if(UseSeedDispersal)
 		ForEachSpecies(s) 
 			if(Species[s]->use_me && Species[s]->use_dispersal) { 
-				for(i = 0; i < grid_Cells; i++) {
-					Mem_Free(grid_SD[s][i].cells);
-					Mem_Free(grid_SD[s][i].prob);
+				for(i = 0; i < grid_nActive; i++) {
+					_store_free(grid_SD[s][i].cells);
+					_store_free(grid_SD[s][i].prob);
 					grid_SD[s][i].size = 0;
 				}
-				Mem_Free(grid_SD[s]);
+				_store_free(grid_SD[s]);
 			}
+	_store_free_all();
 	
 	stat_Free_Accumulators(); //free our memory we allocated for all the accumulators now that they're unnecessary to have
 	
+	Mem_Free(grid_CellIndex);
+	Mem_Free(grid_CellNumber);
+	
 	for(i = 0; i < N_GRID_DIRECTORIES; i++) //frees the strings allocated in _init_grid_files()
     		Mem_Free(grid_directories[i]);
     	for(i = 0; i < N_GRID_FILES; i++)
@@ -854,9 +1940,11 @@ static void _free_grid_memory( void ) {
 	if(UseSoilwat) {
 		Mem_Free(SXW.swc);
 		Mem_Free(SXW.debugfile);
-		for(i = 0; i < SW_Site.n_layers; i++)
-			Mem_Free(SW_Site.lyr[i]);
-		Mem_Free(SW_Site.lyr);
+		if(!UseSoils) { //otherwise SW_Site.lyr belongs to grid_Profiles
+			for(i = 0; i < SW_Site.n_layers; i++)
+				Mem_Free(SW_Site.lyr[i]);
+			Mem_Free(SW_Site.lyr);
+		}
 	}
     	
 }
@@ -865,40 +1953,20 @@ static void _free_grid_memory( void ) {
 static void _load_cell( int row, int col, int year ) {	
 	// loads the specified cell into the global variables
 	
-	int cell = col + ( (row-1) * grid_Cols) - 1;  // converts the row/col into an array index
-	int j;
+	int cell = _cell_index(row, col);  // converts the row/col into an array index
 	GrpIndex c;
 	SppIndex s;
 	//fprintf(stderr, " loading cell: %d; ", cell);
 	
+	if(grid_Workers) RandUseStream(&grid_Rand[cell]); // until _save_cell(), see "about the worker processes" at the top
 	stat_Load_Accumulators(cell, year);
 	ForEachSpecies(s) {
 		if(!Species[s]->use_me) continue;
-
-		Mem_Free(Species[s]->kills);
-		Mem_Free(Species[s]->seedprod);
-		_free_head(Species[s]->IndvHead); //free_head() frees the memory allocated by the head and the memory allocated by each part of the linked list
-		
-		*Species[s] = grid_Species[s][cell];
-
-		Species[s]->kills = Mem_Calloc(grid_Species[s][cell].max_age, sizeof(IntUS), "_load_cell(Species[s]->kills)");
-		Species[s]->seedprod = Mem_Calloc(grid_Species[s][cell].viable_yrs, sizeof(RealF), "_load_cell(Species[s]->seedprod)");
-		
-		memcpy(Species[s]->kills, grid_Species[s][cell].kills, grid_Species[s][cell].max_age * sizeof(IntUS));
-		memcpy(Species[s]->seedprod, grid_Species[s][cell].seedprod, grid_Species[s][cell].viable_yrs * sizeof(RealF));
-		Species[s]->IndvHead = _copy_head(grid_Species[s][cell].IndvHead); //copy_head() deep copies the linked list structure (allocating memory when needed)... it will even allocate memory for the head of the list
-	
+		_load_species(s, &grid_Species[s][cell]); //only the state is copied, the parameters are shared by every cell
 	}
 		
-	ForEachGroup(c) {
-		if(!RGroup[c]->use_me) continue;
-		Mem_Free(RGroup[c]->kills); //kills is the only pointer in the resourcegroup_st struct (which is what RGroup is defined as)... we need to free it then reallocate it then memcpy it to get the deep copy we want
-		
-		*RGroup[c] = grid_RGroup[c][cell]; //does a shallow copy, we have to do the freeing/malloc/memcpy to deep copy (ie copy the values in the pointers instead of the addresses) the pointers.  A shallow copy will copy over the values for every non-pointer (C itself does not inherently know how to deep copy, so we must code this behaviour).
-		
-		RGroup[c]->kills = Mem_Calloc(grid_RGroup[c][cell].max_age, sizeof(IntUS), "_load_cell(RGroup[c]->kills");
-		memcpy(RGroup[c]->kills, grid_RGroup[c][cell].kills, grid_RGroup[c][cell].max_age * sizeof(IntUS));
-	}
+	ForEachGroup(c)
+		if(RGroup[c]->use_me) _load_rgroup(c, &grid_RGroup[c][cell]);
 		
 	Succulent = grid_Succulent[cell];
 	Env = grid_Env[cell];
@@ -908,26 +1976,26 @@ static void _load_cell( int row, int col, int year ) {
 	if(UseSoilwat) {
 		Mem_Free(SXW.transp);
 		if(SXW.swc != NULL) Mem_Free(SXW.swc);
-		for(j = 0; j < SW_Site.n_layers; j++)
-			Mem_Free(SW_Site.lyr[j]);
-		Mem_Free(SW_Site.lyr);
 			
 		SXW = grid_SXW[cell];
-		SW_Site = grid_SW_Site[cell];
-		SW_Soilwat = grid_SW_Soilwat[cell];
-		SW_VegProd = grid_SW_VegProd[cell];
+		SW_Site = grid_SW_Site[cell]; //shallow copy, the layers are shared (only their transp_coeff_* get written, see Grid_Soil_Profile_St)
+		if(grid_Workers) {
+			_load_carry(&grid_SW_Carry[cell]);
+			Time_new_year(SW_Model.startyr + year - 1); //sxw sets up the year's vegetation before soilwat starts the year, so it would use the calendar of whichever cell came before
+		}
 		
 		SXW.transp = Mem_Calloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_load_cell(SXW.transp)");
 		SXW.swc = Mem_Calloc(SXW.NPds * SXW.NSoLyrs, sizeof(RealF), "_load_cell(SXW.swc)");
 		
+		if(grid_Pack) {
+			_unpack_cell(cell); //SW_Soilwat, SW_VegProd, & the arrays
+			return;
+		}
+		
+		SW_Soilwat = grid_SW_Soilwat[cell];
+		SW_VegProd = grid_SW_VegProd[cell];
 		memcpy(SXW.transp, grid_SXW[cell].transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
 		memcpy(SXW.swc, grid_SXW[cell].swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
-		
-		SW_Site.lyr = Mem_Calloc(grid_SW_Site[cell].n_layers, sizeof(SW_LAYER_INFO *), "_load_cell(SW_Site.lyr)");
-        for(j = 0; j < grid_SW_Site[cell].n_layers; j++) {
-        	SW_Site.lyr[j] = Mem_Calloc(1, sizeof(SW_LAYER_INFO), "_load_cell(SW_Site.lyr[j])");
-        	memcpy(SW_Site.lyr[j], grid_SW_Site[cell].lyr[j], sizeof(SW_LAYER_INFO));
-        }
         
         if(UseSoils) load_sxw_memory(grid_SXW_ptrs[cell].roots_max, grid_SXW_ptrs[cell].rootsXphen, grid_SXW_ptrs[cell].roots_active, grid_SXW_ptrs[cell].roots_active_rel, grid_SXW_ptrs[cell].roots_active_sum, grid_SXW_ptrs[cell].phen);
 	}
@@ -937,39 +2005,20 @@ static void _load_cell( int row, int col, int year ) {
 static void _save_cell( int row, int col, int year ) {	
 	// saves the specified cell into the grid variables
 
-	int cell = col + ( (row-1) * grid_Cols) - 1;  // converts the row/col into an array index
-	int j;
+	int cell = _cell_index(row, col);  // converts the row/col into an array index
 	GrpIndex c;
 	SppIndex s;
 	//fprintf(stderr, "saving cell: %d\n", cell);
 	
+	RandUseStream(NULL);
 	stat_Save_Accumulators(cell, year);
 	ForEachSpecies(s) {
 		if(!Species[s]->use_me) continue;
-
-		Mem_Free(grid_Species[s][cell].kills);
-		Mem_Free(grid_Species[s][cell].seedprod);
-		_free_head(grid_Species[s][cell].IndvHead);
-		
-		grid_Species[s][cell] = *Species[s];
-		
-		grid_Species[s][cell].kills = Mem_Calloc(Species[s]->max_age, sizeof(IntUS), "_save_cell(grid_Species[cell][s].kills)");
-		grid_Species[s][cell].seedprod = Mem_Calloc(Species[s]->viable_yrs, sizeof(RealF), "_save_cell(grid_Species[cell][s].seedprod)");
-		
-		memcpy(grid_Species[s][cell].kills, Species[s]->kills, Species[s]->max_age * sizeof(IntUS));
-		memcpy(grid_Species[s][cell].seedprod, Species[s]->seedprod, Species[s]->viable_yrs * sizeof(RealF));
-		grid_Species[s][cell].IndvHead = _copy_head(Species[s]->IndvHead);
+		_save_species(s, &grid_Species[s][cell]);
 	}
 		
-	ForEachGroup(c) {
-		if(!RGroup[c]->use_me) continue;
-		Mem_Free(grid_RGroup[c][cell].kills); //kills is the only pointer in the resourcegroup_st struct (which is what RGroup is defined as)
-		
-		grid_RGroup[c][cell] = *RGroup[c]; //does a shallow copy, we have to do the freeing/malloc/memcpy to deep copy (i.e. copy the values in the pointers instead of the addresses) the pointers
-		
-		grid_RGroup[c][cell].kills = Mem_Calloc(RGroup[c]->max_age, sizeof(IntUS), "_save_cell(grid_RGroup[cell][c].kills)");
-		memcpy(grid_RGroup[c][cell].kills, RGroup[c]->kills, RGroup[c]->max_age * sizeof(IntUS));
-	}
+	ForEachGroup(c)
+		if(RGroup[c]->use_me) _save_rgroup(c, &grid_RGroup[c][cell]);
 		
 	grid_Succulent[cell] = Succulent;
 	grid_Env[cell] = Env;
@@ -977,33 +2026,110 @@ static void _save_cell( int row, int col, int year ) {
 	grid_Globals[cell] = Globals;
 	
 	if(UseSoilwat) {
-		Mem_Free(grid_SXW[cell].transp);
-		Mem_Free(grid_SXW[cell].swc);
-		for(j = 0; j < SW_Site.n_layers; j++)
-			Mem_Free(grid_SW_Site[cell].lyr[j]);
-		Mem_Free(grid_SW_Site[cell].lyr);	
+		RealD *transp = grid_SXW[cell].transp; //the cell keeps its arrays (they're the same size every year), only their contents are copied
+		RealF *swc = grid_SXW[cell].swc;
 	
 		grid_SXW[cell] = SXW;
-		grid_SW_Site[cell] = SW_Site;
-		grid_SW_Soilwat[cell] = SW_Soilwat;
-		grid_SW_VegProd[cell] = SW_VegProd;
+		grid_SW_Site[cell] = SW_Site; //shallow copy, the layers are shared (only their transp_coeff_* get written, see Grid_Soil_Profile_St)
+		grid_SXW[cell].transp = transp;
+		grid_SXW[cell].swc = swc;
+		if(grid_Workers)
+			_save_carry(&grid_SW_Carry[cell]);
 		
-		grid_SXW[cell].transp = Mem_Calloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_save_cell(grid_SXW[cell].transp)");
-		grid_SXW[cell].swc = Mem_Calloc(SXW.NPds * SXW.NSoLyrs, sizeof(RealF), "_save_cell(grid_SXW[cell].swc)");
+		if(grid_Pack) {
+			_pack_cell(cell); //SW_Soilwat, SW_VegProd, & the arrays
+			return;
+		}
 		
+		grid_SW_Soilwat[cell] = SW_Soilwat;
+		grid_SW_VegProd[cell] = SW_VegProd;
 		memcpy(grid_SXW[cell].transp, SXW.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
 		memcpy(grid_SXW[cell].swc, SXW.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
-		
-		grid_SW_Site[cell].lyr = Mem_Calloc(SW_Site.n_layers, sizeof(SW_LAYER_INFO *), "_save_cell(grid_SW_Site[cell].lyr[j])");
-       		for(j = 0; j < SW_Site.n_layers; j++) {
-        		grid_SW_Site[cell].lyr[j] = Mem_Calloc(1, sizeof(SW_LAYER_INFO), "_save_cell(grid_SW_Site[cell].lyr[j])");
-        		memcpy(grid_SW_Site[cell].lyr[j], SW_Site.lyr[j], sizeof(SW_LAYER_INFO));
-        	}
         
         if(UseSoils) save_sxw_memory(grid_SXW_ptrs[cell].roots_max, grid_SXW_ptrs[cell].rootsXphen, grid_SXW_ptrs[cell].roots_active, grid_SXW_ptrs[cell].roots_active_rel, grid_SXW_ptrs[cell].roots_active_sum, grid_SXW_ptrs[cell].phen);
 	}
 }
 
+/***********************************************************/
+static void *_pack_part(size_t *pos, size_t bytes) {
+	// the next part of pack_Buf for _pack_layout(), 8 byte aligned
+	void *p = pack_Buf + *pos;
+	*pos += (bytes + 7) & ~((size_t) 7);
+	return p;
+}
+
+/***********************************************************/
+static void _pack_layout(Grid_Pack_Layout *l) {
+	// lays out the soilwat state of the cell whose SXW is loaded in pack_Buf (the sizes of the arrays depend on the cell's soil layers), making pack_Buf bigger if it has to be
+	size_t pos = 0;
+	
+	l->soilwat = _pack_part(&pos, sizeof(SW_SOILWAT));
+	l->vegprod = _pack_part(&pos, sizeof(SW_VEGPROD));
+	l->transp = _pack_part(&pos, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+	l->swc = _pack_part(&pos, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
+	if(UseSoils) {
+		l->roots.roots_max = _pack_part(&pos, SXW.NGrps * SXW.NTrLyrs * sizeof(RealD));
+		l->roots.rootsXphen = _pack_part(&pos, SXW.NGrps * SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		l->roots.roots_active = _pack_part(&pos, SXW.NGrps * SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		l->roots.roots_active_rel = _pack_part(&pos, SXW.NGrps * SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		l->roots.roots_active_sum = _pack_part(&pos, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+		l->roots.phen = _pack_part(&pos, SXW.NGrps * MAX_MONTHS * sizeof(RealD));
+	}
+	l->size = pos;
+	
+	if(pos > pack_BufSize) { // the first cell with this many layers, so make room and lay it out again
+		if(pos > INT_MAX / 2)
+			LogError(logfp, LOGFATAL, "_pack_layout(): the soilwat state of a cell is too big to pack (%lu bytes)", (unsigned long) pos);
+		Mem_Free(pack_Buf);
+		Mem_Free(pack_Out);
+		pack_BufSize = pos;
+		pack_Buf = Mem_Malloc(pack_BufSize, "_pack_layout()");
+		pack_Out = Mem_Malloc(pack_Bound((int) pack_BufSize), "_pack_layout()");
+		_pack_layout(l);
+	}
+}
+
+/***********************************************************/
+static void _pack_cell(int cell) {
+	// packs the soilwat state that is loaded (SW_Soilwat, SW_VegProd, SXW's transp & swc, and sxw.c's root arrays with the soils input) into the cell's grid_Packed block
+	Grid_Pack_Layout l;
+	Grid_Packed_St *p = &grid_Packed[cell];
+	int size;
+	
+	_pack_layout(&l);
+	*l.soilwat = SW_Soilwat;
+	*l.vegprod = SW_VegProd;
+	memcpy(l.transp, SXW.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+	memcpy(l.swc, SXW.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
+	if(UseSoils) save_sxw_memory(l.roots.roots_max, l.roots.rootsXphen, l.roots.roots_active, l.roots.roots_active_rel, l.roots.roots_active_sum, l.roots.phen);
+	
+	size = pack_Compress(pack_Buf, (int) l.size, pack_Out);
+	if(size > p->cap) { // the block only grows, the size of a cell's packed state doesn't change much from year to year
+		Mem_Free(p->data);
+		p->data = Mem_Malloc(size, "_pack_cell()");
+		p->cap = size;
+	}
+	memcpy(p->data, pack_Out, size);
+	p->size = size;
+}
+
+/***********************************************************/
+static void _unpack_cell(int cell) {
+	// unpacks the cell's grid_Packed block into SW_Soilwat, SW_VegProd, SXW's transp & swc (which must be allocated), and sxw.c's root arrays... SXW must already be the cell's
+	Grid_Pack_Layout l;
+	Grid_Packed_St *p = &grid_Packed[cell];
+	
+	_pack_layout(&l);
+	if(pack_Decompress(p->data, p->size, pack_Buf, (int) l.size) != 0)
+		LogError(logfp, LOGFATAL, "_unpack_cell(): the packed soilwat state of cell %d is damaged", grid_CellNumber[cell]);
+	
+	SW_Soilwat = *l.soilwat;
+	SW_VegProd = *l.vegprod;
+	memcpy(SXW.transp, l.transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+	memcpy(SXW.swc, l.swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
+	if(UseSoils) load_sxw_memory(l.roots.roots_max, l.roots.rootsXphen, l.roots.roots_active, l.roots.roots_active_rel, l.roots.roots_active_sum, l.roots.phen);
+}
+
 /**************************************************************/
 static Bool GetALine2( FILE *f, char buf[], int limit) {
   	//this is similar to the getaline function in filefuncs.c, except this one checks for carriage return characters and doesn't deal with whitespace/... (since excel writes them into .csv files for some aggravating reason)... this one is probably less efficient overall though.
@@ -1024,16 +2150,126 @@ static Bool GetALine2( FILE *f, char buf[], int limit) {
   	return TRUE;
 }
 
+/***********************************************************/
+static void _read_mask_in( void ) {
+	// reads the grid cell mask input file, if there is one, and numbers the cells that are simulated
+	// the file should be something like: "cell,active" with a line for every cell in cell number order, active is 1 for the cells to simulate and 0 for the ones to leave out (water, rock, outside the study area, ...)
+	// without a mask every cell is active, and a cell's index into the grid arrays is its cell number (unless grid_Order puts them along a curve, see _order_cells())
+
+	FILE *f;
+	char buf[1024];
+	int i, cell, active, num;
+	
+	grid_CellIndex = Mem_Calloc(grid_Cells, sizeof(int), "_read_mask_in()");
+	grid_nActive = 0;
+	
+	if(!UseMask) {
+		for(i = 0; i < grid_Cells; i++)
+			grid_CellIndex[i] = grid_nActive++;
+	} else {
+		f = OpenFile(grid_files[9], "r");
+		
+		GetALine2(f, buf, 1024); // gets rid of the first line (since it just defines the columns)
+		for(i = 0; i < grid_Cells; i++) {
+			if(!GetALine2(f, buf, 1024)) break;
+			
+			num = sscanf( buf, "%d,%d", &cell, &active);
+			if(num != 2 || cell != i)
+				LogError(logfp, LOGFATAL, "Invalid %s file line %d wrong", grid_files[9], i+2);
+			grid_CellIndex[i] = (active) ? grid_nActive++ : -1;
+		}
+		if(i != grid_Cells)
+			LogError(logfp, LOGFATAL, "Invalid %s file wrong number of cells", grid_files[9]);
+		if(grid_nActive == 0)
+			LogError(logfp, LOGFATAL, "Invalid %s file, every cell is masked out", grid_files[9]);
+		
+		CloseFile(&f);
+	}
+	
+	grid_CellNumber = Mem_Calloc(grid_nActive, sizeof(int), "_read_mask_in()");
+	for(i = 0; i < grid_Cells; i++)
+		if(grid_CellIndex[i] >= 0)
+			grid_CellNumber[grid_CellIndex[i]] = i;
+	
+	_order_cells();
+}
+
+/***********************************************************/
+static unsigned long long _curve_key(int cell, unsigned long long side) {
+	// the position of the cell along the grid_Order curve through a side x side square (side is a power of 2 at least as big as the rows & the cols)
+	unsigned long long x = _cell_col(cell) - 1, y = _cell_row(cell) - 1, key = 0, s, rx, ry, t;
+	int b;
+	
+	if(grid_Order == GRID_ORDER_MORTON) { // interleaves the bits of the row & col
+		for(b = 0; (side >> b) > 1; b++)
+			key |= (((x >> b) & 1) << (2 * b)) | (((y >> b) & 1) << (2 * b + 1));
+		return key;
+	}
+	
+	for(s = side / 2; s > 0; s /= 2) { // which quadrant at each level, turning the quadrant the same way the curve does
+		rx = (x & s) > 0;
+		ry = (y & s) > 0;
+		key += s * s * ((3 * rx) ^ ry);
+		if(ry == 0) {
+			if(rx == 1) {
+				x = side - 1 - x;
+				y = side - 1 - y;
+			}
+			t = x;
+			x = y;
+			y = t;
+		}
+	}
+	return key;
+}
+
+/***********************************************************/
+static int _compare_keys(const void *a, const void *b) {
+	// for qsort() in _order_cells()
+	const unsigned long long *ka = a, *kb = b; // the key, then the cell number
+	
+	if(ka[0] != kb[0]) return (ka[0] < kb[0]) ? -1 : 1;
+	return (ka[1] < kb[1]) ? -1 : (ka[1] > kb[1]);
+}
+
+/***********************************************************/
+static void _order_cells( void ) {
+	// puts the simulated cells in grid_Order: with a curve, cells that are close on the grid are close in the grid arrays, so the seed dispersal's reads of the cells around a cell & a row's worth of cells (to page in, or to hand to a thread) stay together
+	// grid_CellNumber must be set up in cell number order, and is sorted along with grid_CellIndex
+	unsigned long long side = 1, *keys;
+	int i;
+	
+	if(grid_Order == GRID_ORDER_ROWS) return;
+	
+	while(side < (unsigned long long) grid_Rows || side < (unsigned long long) grid_Cols)
+		side *= 2;
+	
+	keys = Mem_Calloc(2 * grid_nActive, sizeof(unsigned long long), "_order_cells()");
+	for(i = 0; i < grid_nActive; i++) {
+		keys[2 * i] = _curve_key(grid_CellNumber[i], side);
+		keys[2 * i + 1] = grid_CellNumber[i];
+	}
+	qsort(keys, grid_nActive, 2 * sizeof(unsigned long long), _compare_keys);
+	
+	for(i = 0; i < grid_nActive; i++) {
+		grid_CellNumber[i] = (int) keys[2 * i + 1];
+		grid_CellIndex[grid_CellNumber[i]] = i;
+	}
+	Mem_Free(keys);
+}
+
 /***********************************************************/
 static void _read_disturbances_in( void ) {
 	// reads the grid disturbances input file
 	// the file should be something like: "cell,use_fecal_pats,use_ant_mounds,use_animal_burrows,kill_yr"
 	// there should be no spaces in between, just commas separating the values
 	// kill_yr will overwrite the kill year for each RGroup in the cell (0 means don't use, a # > 0 means kill everything at this year)
+	// there is a line for every cell, the lines of masked out cells are skipped
 
 	FILE *f;
 	char buf[1024];
 	int i, cell, num;
+	Grid_Disturb_St d;
 	
     	f = OpenFile(grid_files[2], "r");
     
@@ -1041,9 +2277,11 @@ static void _read_disturbances_in( void ) {
     	for(i = 0; i < grid_Cells; i++) {
     		if(!GetALine2(f, buf, 1024)) break;
 
-    		num = sscanf( buf, "%d,%d,%d,%d,%d", &cell, &grid_Disturb[i].choices[0], &grid_Disturb[i].choices[1], &grid_Disturb[i].choices[2], &grid_Disturb[i].kill_yr);
+    		num = sscanf( buf, "%d,%d,%d,%d,%d", &cell, &d.choices[0], &d.choices[1], &d.choices[2], &d.kill_yr);
 		if(num != 5)
 			LogError(logfp, LOGFATAL, "Invalid %s file line %d wrong", grid_files[2], i+2);
+		if(grid_CellIndex[i] >= 0)
+			grid_Disturb[grid_CellIndex[i]] = d;
 	}
     	if(i != grid_Cells)
     		LogError(logfp, LOGFATAL, "Invalid %s file wrong number of cells", grid_files[2]);	
@@ -1075,10 +2313,16 @@ static void _read_soils_in( void ) {
 	FILE *f;
 	char buf[4096];
 	int i, j, k, cell, num, do_copy, copy_cell, num_layers, depth, depthMin;
+	int *buckets;
 	float d[11];
 	
 	f = OpenFile(grid_files[3], "r");
 	
+	buckets = Mem_Malloc(grid_Cells * sizeof(int), "_read_soils_in()"); //hash buckets for _find_soil_profile()
+	for(i = 0; i < grid_Cells; i++)
+		buckets[i] = -1;
+	grid_nProfiles = 0;
+	
 	GetALine2(f, buf, 4096); // gets rid of the first line (since it just defines the columns)... it's only there for user readability
 	for(i = 0; i < grid_Cells; i++) {
 		if(!GetALine2(f, buf, 4096)) break;
@@ -1096,6 +2340,7 @@ static void _read_soils_in( void ) {
 			for(j = 0; j < grid_Soils[copy_cell].num_layers; j++)
 				grid_Soils[i].lyr[j] = grid_Soils[copy_cell].lyr[j];
 			grid_Soils[i].num_layers = grid_Soils[copy_cell].num_layers;
+			grid_Soils[i].profile = grid_Soils[copy_cell].profile;
 			continue;
 		} else if(do_copy == 1)
 			LogError(logfp, LOGFATAL, "Invalid %s file line %d invalid copy_cell attempt", grid_files[3], i+2);
@@ -1119,7 +2364,9 @@ static void _read_soils_in( void ) {
 			grid_Soils[i].lyr[j].width = depth-depthMin;
 			depthMin = depth;
 		}
+		grid_Soils[i].profile = _find_soil_profile(i, buckets);
 	}
+	Mem_Free(buckets);
 	
 	if(i != grid_Cells)
 		LogError(logfp, LOGFATAL, "Invalid %s file, not enough cells", grid_files[3]);
@@ -1137,83 +2384,126 @@ static void _read_soils_in( void ) {
 }
 
 /***********************************************************/
-static void _init_soil_layers(int cell) {
-	// initializes the soilwat soil layers for the cell correctly based upon the input gathered from our grid_soils input file
+static int _find_soil_profile(int cell, int *buckets) {
+	// returns the index into grid_Profiles of the soil profile of the cell, adding a new profile if no earlier cell had the same layers
+	// buckets is an array of grid_Cells hash chains (-1 when empty) that has to be kept between calls
+	unsigned long h = 2166136261UL; //FNV-1a hash of the layer inputs
+	size_t k, size = grid_Soils[cell].num_layers * sizeof(Grid_Soil_Lyr);
+	unsigned char *c = (unsigned char *) grid_Soils[cell].lyr;
+	int p, b;
+	
+	for(k = 0; k < size; k++)
+		h = (h ^ c[k]) * 16777619UL;
+	b = h % grid_Cells;
+	
+	for(p = buckets[b]; p >= 0; p = grid_Profiles[p].next)
+		if(grid_Profiles[p].hash == h && grid_Soils[grid_Profiles[p].cell].num_layers == grid_Soils[cell].num_layers
+				&& !memcmp(grid_Soils[grid_Profiles[p].cell].lyr, grid_Soils[cell].lyr, size))
+			return p;
+	
+	p = grid_nProfiles++;
+	grid_Profiles[p].cell = cell;
+	grid_Profiles[p].hash = h;
+	grid_Profiles[p].next = buckets[b];
+	buckets[b] = p;
+	return p;
+}
+
+/***********************************************************/
+static void _init_soil_profiles( void ) {
+	// initializes the soilwat soil layers for each unique soil profile based upon the input gathered from our grid_soils input file
 	// pretty much takes the data from grid_Soils (read in in _read_soils_in()) and converts it to what SW_Site needs...
 	// this function does generally the same things that the _read_layers() function in SW_Site.c does, except that it does it in a way that lets us use it in the grid...
-	int i, j;
-	i = cell;
+	// the hydraulic parameters (water_eqn() & init_site_info()) are only computed once per profile, every cell with that profile then shares the layers (see _init_soil_layers())
+	int i, j, p;
+	SW_LAYER_INFO *lyrs;
+	SW_SITE input_site = SW_Site; //put back when we're done, it is used until the cells are loaded in the first iteration (see _load_grid_globals())
 	
-	Bool evap_ok = TRUE, transp_ok_tree = TRUE, transp_ok_shrub = TRUE, transp_ok_grass = TRUE; /* mitigate gaps in layers */
+	for(p = 0; p < grid_nProfiles; p++) {
+		i = grid_Profiles[p].cell;
 	
-	for(j = 0; j < SW_Site.n_layers; j++)
-		Mem_Free(SW_Site.lyr[j]);
-	Mem_Free(SW_Site.lyr);
+		Bool evap_ok = TRUE, transp_ok_tree = TRUE, transp_ok_shrub = TRUE, transp_ok_grass = TRUE; /* mitigate gaps in layers */
 			
-	SW_Site.n_layers = grid_Soils[i].num_layers;
-	SW_Site.n_evap_lyrs = SW_Site.n_transp_lyrs_tree = SW_Site.n_transp_lyrs_shrub = SW_Site.n_transp_lyrs_grass = 0;
+		SW_Site.n_layers = grid_Soils[i].num_layers;
+		SW_Site.n_evap_lyrs = SW_Site.n_transp_lyrs_tree = SW_Site.n_transp_lyrs_shrub = SW_Site.n_transp_lyrs_grass = 0;
 			
-	SW_Site.lyr = Mem_Calloc(SW_Site.n_layers, sizeof(SW_LAYER_INFO *), "_init_grid_globals()");
-    	for(j = 0; j < SW_Site.n_layers; j++) {
-        	SW_Site.lyr[j] = Mem_Calloc(1, sizeof(SW_LAYER_INFO), "_init_grid_globals()");
+		SW_Site.lyr = Mem_Calloc(SW_Site.n_layers, sizeof(SW_LAYER_INFO *), "_init_soil_profiles()");
+		lyrs = Mem_Calloc(SW_Site.n_layers, sizeof(SW_LAYER_INFO), "_init_soil_profiles()"); //one block for all the layers of the profile
+	    	for(j = 0; j < SW_Site.n_layers; j++) {
+	        	SW_Site.lyr[j] = &lyrs[j];
         		
-        	//indexes (for grid_Soils[i].lyr[j].data):
-        	//0		   1		2		3	  4				5			6			7	   8		9		10
-        	//bulkd   fieldc   wiltpt  evco  trco_grass  	trco_shrub  trco_tree  	%sand  %clay imperm soiltemp
-        	SW_Site.lyr[j]->width = grid_Soils[i].lyr[j].width;
-        	SW_Site.lyr[j]->bulk_density = grid_Soils[i].lyr[j].data[0];
-        	SW_Site.lyr[j]->swc_fieldcap = grid_Soils[i].lyr[j].data[1] * SW_Site.lyr[j]->width;
-        	SW_Site.lyr[j]->swc_wiltpt = grid_Soils[i].lyr[j].data[2] * SW_Site.lyr[j]->width;
-        	SW_Site.lyr[j]->evap_coeff = grid_Soils[i].lyr[j].data[3];
-        	SW_Site.lyr[j]->transp_coeff_grass = grid_Soils[i].lyr[j].data[4];
-        	SW_Site.lyr[j]->transp_coeff_shrub = grid_Soils[i].lyr[j].data[5];
-        	SW_Site.lyr[j]->transp_coeff_tree = grid_Soils[i].lyr[j].data[6];
-        	SW_Site.lyr[j]->pct_sand = grid_Soils[i].lyr[j].data[7];
-        	SW_Site.lyr[j]->pct_clay = grid_Soils[i].lyr[j].data[8];
-        	SW_Site.lyr[j]->impermeability = grid_Soils[i].lyr[j].data[9];
-        	SW_Site.lyr[j]->my_transp_rgn_tree = 0;
-        	SW_Site.lyr[j]->my_transp_rgn_shrub = 0;
-        	SW_Site.lyr[j]->my_transp_rgn_grass = 0;
-        	SW_Site.lyr[j]->sTemp = grid_Soils[i].lyr[j].data[10];
+	        	//indexes (for grid_Soils[i].lyr[j].data):
+	        	//0		   1		2		3	  4				5			6			7	   8		9		10
+	        	//bulkd   fieldc   wiltpt  evco  trco_grass  	trco_shrub  trco_tree  	%sand  %clay imperm soiltemp
+	        	SW_Site.lyr[j]->width = grid_Soils[i].lyr[j].width;
+	        	SW_Site.lyr[j]->bulk_density = grid_Soils[i].lyr[j].data[0];
+	        	SW_Site.lyr[j]->swc_fieldcap = grid_Soils[i].lyr[j].data[1] * SW_Site.lyr[j]->width;
+	        	SW_Site.lyr[j]->swc_wiltpt = grid_Soils[i].lyr[j].data[2] * SW_Site.lyr[j]->width;
+	        	SW_Site.lyr[j]->evap_coeff = grid_Soils[i].lyr[j].data[3];
+	        	SW_Site.lyr[j]->transp_coeff_grass = grid_Soils[i].lyr[j].data[4];
+	        	SW_Site.lyr[j]->transp_coeff_shrub = grid_Soils[i].lyr[j].data[5];
+	        	SW_Site.lyr[j]->transp_coeff_tree = grid_Soils[i].lyr[j].data[6];
+	        	SW_Site.lyr[j]->pct_sand = grid_Soils[i].lyr[j].data[7];
+	        	SW_Site.lyr[j]->pct_clay = grid_Soils[i].lyr[j].data[8];
+	        	SW_Site.lyr[j]->impermeability = grid_Soils[i].lyr[j].data[9];
+	        	SW_Site.lyr[j]->my_transp_rgn_tree = 0;
+	        	SW_Site.lyr[j]->my_transp_rgn_shrub = 0;
+	        	SW_Site.lyr[j]->my_transp_rgn_grass = 0;
+	        	SW_Site.lyr[j]->sTemp = grid_Soils[i].lyr[j].data[10];
         
-		if ( evap_ok ) {
-			if ( GT(SW_Site.lyr[j]->evap_coeff, 0.0) )
-				SW_Site.n_evap_lyrs++;
-			else
-				evap_ok = FALSE;
-		}
-		if ( transp_ok_tree ) {
-			if ( GT(SW_Site.lyr[j]->transp_coeff_tree, 0.0) )
-				SW_Site.n_transp_lyrs_tree++;
-			else
-				transp_ok_tree = FALSE;
-		}
-		if ( transp_ok_shrub ) {
-			if ( GT(SW_Site.lyr[j]->transp_coeff_shrub, 0.0) )
-				SW_Site.n_transp_lyrs_shrub++;
-			else
-				transp_ok_shrub = FALSE;
-		}
-		if ( transp_ok_grass ) {
-			if ( GT(SW_Site.lyr[j]->transp_coeff_grass, 0.0) )
-				SW_Site.n_transp_lyrs_grass++;
-			else
-				transp_ok_grass = FALSE;
-		}
+			if ( evap_ok ) {
+				if ( GT(SW_Site.lyr[j]->evap_coeff, 0.0) )
+					SW_Site.n_evap_lyrs++;
+				else
+					evap_ok = FALSE;
+			}
+			if ( transp_ok_tree ) {
+				if ( GT(SW_Site.lyr[j]->transp_coeff_tree, 0.0) )
+					SW_Site.n_transp_lyrs_tree++;
+				else
+					transp_ok_tree = FALSE;
+			}
+			if ( transp_ok_shrub ) {
+				if ( GT(SW_Site.lyr[j]->transp_coeff_shrub, 0.0) )
+					SW_Site.n_transp_lyrs_shrub++;
+				else
+					transp_ok_shrub = FALSE;
+			}
+			if ( transp_ok_grass ) {
+				if ( GT(SW_Site.lyr[j]->transp_coeff_grass, 0.0) )
+					SW_Site.n_transp_lyrs_grass++;
+				else
+					transp_ok_grass = FALSE;
+			}
 		
-		water_eqn(SW_Site.lyr[j]->pct_sand, SW_Site.lyr[j]->pct_clay, j); //in SW_Site.c, called to initialize some layer data...
+			water_eqn(SW_Site.lyr[j]->pct_sand, SW_Site.lyr[j]->pct_clay, j); //in SW_Site.c, called to initialize some layer data...
+		}
+		init_site_info(); //in SW_Site.c, called to initialize layer data...
+	
+		grid_Profiles[p].num_lyrs = grid_Soils[i].num_layers;
+		grid_Profiles[p].site = SW_Site;
 	}
-	init_site_info(); //in SW_Site.c, called to initialize layer data...
-	    
-	free_all_sxw_memory();
-	_init_SXW_inputs(FALSE); //we call this so that SXW can set the correct sizes/values up for the memory dynamically allocated in sxw.c
+	
+	SW_Site = input_site;
+}
 
-	grid_SXW_ptrs[i].roots_max = Mem_Calloc(SXW.NGrps * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
-	grid_SXW_ptrs[i].rootsXphen = Mem_Calloc(SXW.NGrps * SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
-	grid_SXW_ptrs[i].roots_active = Mem_Calloc(SXW.NGrps * SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
-	grid_SXW_ptrs[i].roots_active_rel = Mem_Calloc(SXW.NGrps * SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
-	grid_SXW_ptrs[i].roots_active_sum = Mem_Calloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
-	grid_SXW_ptrs[i].phen = Mem_Calloc(SXW.NGrps * MAX_MONTHS, sizeof(RealD), "_init_soil_layers()");
+/***********************************************************/
+static void _init_soil_layers(int cell) {
+	// sets SW_Site to the cell's soil profile (built in _init_soil_profiles()) and sets up sxw's memory for that cell
+	// cell is the index into the grid arrays, not the cell number
+	int i = cell;
+	
+	SW_Site = grid_Profiles[grid_Soils[grid_CellNumber[i]].profile].site;
+	    
+	SXW_Reset(); //remakes the arrays in sxw.c for this cell's layers from the inputs already read in
+	if(grid_Pack) return; //they're packed along with the rest of the cell's soilwat state, see _load_grid_globals()
+
+	grid_SXW_ptrs[i].roots_max = _store_alloc(SXW.NGrps * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
+	grid_SXW_ptrs[i].rootsXphen = _store_alloc(SXW.NGrps * SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
+	grid_SXW_ptrs[i].roots_active = _store_alloc(SXW.NGrps * SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
+	grid_SXW_ptrs[i].roots_active_rel = _store_alloc(SXW.NGrps * SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
+	grid_SXW_ptrs[i].roots_active_sum = _store_alloc(SXW.NPds * SXW.NTrLyrs, sizeof(RealD), "_init_soil_layers()");
+	grid_SXW_ptrs[i].phen = _store_alloc(SXW.NGrps * MAX_MONTHS, sizeof(RealD), "_init_soil_layers()");
 	
 	save_sxw_memory(grid_SXW_ptrs[i].roots_max, grid_SXW_ptrs[i].rootsXphen, grid_SXW_ptrs[i].roots_active, grid_SXW_ptrs[i].roots_active_rel, grid_SXW_ptrs[i].roots_active_sum, grid_SXW_ptrs[i].phen);
 }
@@ -1252,8 +2542,8 @@ static void _read_seed_dispersal_in( void ) {
 
 	FILE *f;
 	char buf[1024];
-	float sd_Rate, H, VW, VT, MAXD, plotLength, d, pd;
-	int maxCells, i, j, k, MAXDP, row, col, cell;
+	float sd_Rate, H, VW, VT, MAXD, plotLength, d, pd, *prob;
+	int maxCells, i, j, k, MAXDP, row, col, cell, *cells;
 	SppIndex s;
 	
     	// read in the seed dispersal input file to get the constants that we need
@@ -1290,45 +2580,48 @@ static void _read_seed_dispersal_in( void ) {
 		plotLength = sqrt(Globals.plotsize);
 		MAXDP = (int) ceil(MAXD / plotLength); //MAXD in terms of plots... rounds up to the nearest integer
 		maxCells = (int) pow((MAXDP*2) + 1.0, 2.0); //gets the maximum number of cells that a grid cell can possibly disperse seeds to... it ends up being more then the maximum actually...
-		if(grid_Cells < maxCells)
-			maxCells = grid_Cells;
+		if(grid_nActive < maxCells)
+			maxCells = grid_nActive;
 		if(! (Species[s]->use_me && Species[s]->use_dispersal) ) continue;
 		
-		for(i = 0; i < grid_Cells; i++) {
-			grid_SD[s][i].cells = Mem_Calloc(maxCells, sizeof(int), "_read_seed_dispersal_in()"); //the cell number
-			grid_SD[s][i].prob = Mem_Calloc(maxCells, sizeof(float), "_read_seed_dispersal_in()"); //the probability that the cell will disperse seeds to this distance
-			grid_SD[s][i].size = 0; //refers to the number of cells reachable...
-		}
+		cells = Mem_Calloc(maxCells, sizeof(int), "_read_seed_dispersal_in()"); //the cell numbers of one cell's table, copied into the store once it's known how big it is
+		prob = Mem_Calloc(maxCells, sizeof(float), "_read_seed_dispersal_in()"); //the probability that the cell will disperse seeds to this distance
 
 		for(row = 1; row <= grid_Rows; row++)
 			for(col = 1; col <= grid_Cols; col++) {
 
-				cell = col + ( (row-1) * grid_Cols) - 1;
+				cell = _cell_index(row, col);
+				if(cell < 0) continue; //masked out cells neither send nor receive seeds
 				k = 0;
 
 				for(i = 1; i <= grid_Rows; i++)
 					for(j = 1; j <= grid_Cols; j++) {
 						if(i == row && j == col) continue;
+						if(_cell_index(i, j) < 0) continue;
 
 						d = _cell_dist(i, row, j, col, plotLength); //distance
 						pd = (d > MAXD) ? (0.0) : (exp(-sd_Rate*d)); //dispersal probability
 
 						if(!ZRO(pd)) {
-							grid_SD[s][cell].cells[k] = i + ( (j-1) * grid_Cols) - 1;
-							grid_SD[s][cell].prob[k] = pd;
-							grid_SD[s][cell].size++;
+							cells[k] = _cell_index(i, j); //the sending cell is row i, col j
+							prob[k] = pd;
 							k++;
 							//fprintf(stderr, "cell: %d; i: %d; j: %d; dist: %f; pd: %f %d %d\n", i + ( (j-1) * grid_Cols) - 1, i, j, d, pd, row, col); 
 						}
 					}
 				//fprintf(stderr, "size %d index %d maxsize %d\n", grid_SD[cell].size, cell, maxCells);
+				
+				grid_SD[s][cell].size = k; //refers to the number of cells reachable...
+				if(k > 0) {
+					grid_SD[s][cell].cells = _store_alloc(k, sizeof(int), "_read_seed_dispersal_in()");
+					grid_SD[s][cell].prob = _store_alloc(k, sizeof(float), "_read_seed_dispersal_in()");
+					memcpy(grid_SD[s][cell].cells, cells, k * sizeof(int));
+					memcpy(grid_SD[s][cell].prob, prob, k * sizeof(float));
+				}
 			}
-
-		for(i = 0; i < grid_Cells; i++)
-			if(grid_SD[s][i].size > 0) {
-				grid_SD[s][i].cells = Mem_ReAlloc(grid_SD[s][i].cells, grid_SD[s][i].size * sizeof(int));
-				grid_SD[s][i].prob = Mem_ReAlloc(grid_SD[s][i].prob, grid_SD[s][i].size * sizeof(float));
-			}
+		
+		Mem_Free(cells);
+		Mem_Free(prob);
 	}
 }
 
@@ -1339,7 +2632,7 @@ static void _do_seed_dispersal(void ) {
 	SppIndex s;
 
 	if(Globals.currYear == 1) { //since we have no previous data to go off of, use the current years...
-		for(i = 0; i < grid_Cells; i++) 
+		for(i = 0; i < grid_nActive; i++) 
 			ForEachSpecies(s) {
 				if( ! (Species[s]->use_me && Species[s]->use_dispersal) ) continue;	
 				grid_Species[s][i].allow_growth = 1;	// since it's the first year, we have to allow growth...
@@ -1355,15 +2648,15 @@ static void _do_seed_dispersal(void ) {
 			if(! (Species[s]->use_me && Species[s]->use_dispersal) ) continue;
 			
 			// germination probability
-			randomN = RandUni(); 
+			randomN = _sd_rand(&rand_Dispersal); 
 			germ = LE(randomN, Species[s]->seedling_estab_prob);
 
 			year = Globals.currYear - 1;
 			
-			for(i = 0; i < grid_Cells; i++) {
+			for(i = 0; i < grid_nActive; i++) {
 				sgerm = (grid_SD[s][i].seeds_present || grid_SD[s][i].seeds_received) && germ; //refers to whether the species has seeds available from the previous year and conditions are correct for germination this year
 				grid_Species[s][i].allow_growth = FALSE;
-				biomass = grid_Species[s][i].relsize * grid_Species[s][i].mature_biomass;
+				biomass = grid_Species[s][i].relsize * Species[s]->mature_biomass;
 
 				if(UseDisturbances) {
 					if((sgerm ||  year < grid_Disturb[i].kill_yr || grid_Disturb[i].kill_yr <= 0 ||  GT(biomass, 0.0)) && (year != grid_Disturb[i].kill_yr))
@@ -1371,7 +2664,7 @@ static void _do_seed_dispersal(void ) {
 				} else if(sgerm || GT(biomass, 0.0))
 					grid_Species[s][i].allow_growth = TRUE;
 				//if(grid_Species[s][i].allow_growth == TRUE &&  i == 52 && s == 0 && Globals.currIter == 1)
-				//	printf("%s allow_growth:%d year:%d sgerm:%d iter:%d\n", grid_Species[s][i].name, grid_Species[s][i].allow_growth, year, sgerm, Globals.currIter);
+				//	printf("%s allow_growth:%d year:%d sgerm:%d iter:%d\n", Species[s]->name, grid_Species[s][i].allow_growth, year, sgerm, Globals.currIter);
 			}
 		}
 
@@ -1384,20 +2677,20 @@ static void _do_seed_dispersal(void ) {
 		IndivType* indiv;
 
 		// figure out which species in each cell produced seeds...
-		for(i = 0; i < grid_Cells; i++) {
+		for(i = 0; i < grid_nActive; i++) {
 			grid_SD[s][i].seeds_present = grid_SD[s][i].seeds_received = grid_Species[s][i].received_prob = 0;
 			
 			biomass = 0;	//getting the biggest individual in the species...
 			ForEachIndiv(indiv, &grid_Species[s][i])
-				if(indiv->relsize * grid_Species[s][i].mature_biomass > biomass)
-					biomass = indiv->relsize * grid_Species[s][i].mature_biomass;  
+				if(indiv->relsize * Species[s]->mature_biomass > biomass)
+					biomass = indiv->relsize * Species[s]->mature_biomass;  
 
-			if(GE(biomass, grid_Species[s][i].mature_biomass * grid_Species[s][i].sd_Param1)) {
-				randomN = RandUni();
+			if(GE(biomass, Species[s]->mature_biomass * Species[s]->sd_Param1)) {
+				randomN = _sd_rand(&grid_Rand[i]);
 
 				LYPPT = grid_SD[s][i].lyppt;
-				float PPTdry = grid_Species[s][i].sd_PPTdry, PPTwet = grid_Species[s][i].sd_PPTwet;
-				float Pmin = grid_Species[s][i].sd_Pmin, Pmax = grid_Species[s][i].sd_Pmax;
+				float PPTdry = Species[s]->sd_PPTdry, PPTwet = Species[s]->sd_PPTwet;
+				float Pmin = Species[s]->sd_Pmin, Pmax = Species[s]->sd_Pmax;
 
 				//p3 = Pmin, if LYPPT < PPTdry 
 				//p3 = 1 - (1-Pmin) * exp(-d * (LYPPT - PPTdry)) with d = - ln((1 - Pmax)/(1 - Pmin)) / (PPTwet - PPTdry), if PPTdry <= LYPPT <= PPTwet
@@ -1419,7 +2712,7 @@ static void _do_seed_dispersal(void ) {
 		}
 
 		// figure out which species in each cell received seeds...
-		for(i = 0; i < grid_Cells; i++) {
+		for(i = 0; i < grid_nActive; i++) {
 			if(grid_SD[s][i].seeds_present) continue;
 			receivedProb = 0;
 			
@@ -1427,7 +2720,7 @@ static void _do_seed_dispersal(void ) {
 				if(grid_SD[s][grid_SD[s][i].cells[j]].seeds_present)
 					receivedProb += grid_SD[s][i].prob[j];
 
-			randomN = RandUni();
+			randomN = _sd_rand(&grid_Rand[i]);
 			if(LE(randomN, receivedProb) && !ZRO(receivedProb)) 
 				grid_SD[s][i].seeds_received = 1;
 			else
@@ -1438,9 +2731,21 @@ static void _do_seed_dispersal(void ) {
 	}
 } 
 
+/***********************************************************/
+static double _sd_rand( RandStream *stream ) {
+	// a random number for _do_seed_dispersal(), from stream with -j (grid_Rand[] for the draws that are for a cell) & from the model's random numbers otherwise
+	double r;
+	
+	if(!grid_Workers) return RandUni();
+	RandUseStream(stream);
+	r = RandUni();
+	RandUseStream(NULL);
+	return r;
+}
+
 /***********************************************************/
 static void _set_sd_lyppt(int row, int col) {
-	int cell = col + ( (row-1) * grid_Cols) - 1;
+	int cell = _cell_index(row, col);
 	SppIndex s;
 	
 	ForEachSpecies(s)
@@ -1469,7 +2774,7 @@ static void _kill_groups_and_species( void ) {
 static int _do_grid_disturbances( int row, int col ) {
 	// return 1 if a disturbance occurs, else return 0
 	if(UseDisturbances) {
-		int cell = col + ( (row-1) * grid_Cols) - 1;
+		int cell = _cell_index(row, col);
 		if(Globals.currYear == grid_Disturb[cell].kill_yr) {
 			//basically if a disturbance occurs, we kill everything and then don't allow any species to grow for the year
 			_kill_groups_and_species();
@@ -0,0 +1,70 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_gridbin.h
+/*  Type: header
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: Layout of the binary grid output files written
+ *           by stat_Output_Grid_Binary() (ST_stats.c) and
+ *           read back by griddump (ST_griddump.c).
+ *
+ *           One file is written for each kind of output
+ *           (bmass, mort, seed dispersal), holding every cell:
+ *
+ *             GridBin_Header
+ *             header_len bytes of text   the heading line(s) of
+ *                                        each cell's text file
+ *             cols bytes                 GRIDBIN_FMT_* of each column
+ *             int names_len, then names_len bytes of column
+ *                                        names, each '\0' terminated
+ *             long long offset[cols]     index: file position of
+ *                                        each column's chunk
+ *             int cell_number[cells]     only if cells is less than
+ *                                        grid_rows*grid_cols (some
+ *                                        cells were masked out): the
+ *                                        grid cell number of each cell
+ *             cols chunks                each is cells*rows floats,
+ *                                        the rows of cell 0, then of
+ *                                        cell 1, etc
+ *
+ *           so reading one column for the whole grid is a single
+ *           seek and read.  Everything is written in the byte
+ *           order of the machine that ran the model (see order).
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*     (10/18/2026) -- the cell numbers of a masked grid
+/*
+/********************************************************/
+/********************************************************/
+
+#ifndef GRIDBIN_DEF_H
+#define GRIDBIN_DEF_H
+
+#define GRIDBIN_MAGIC   "STGRIDB"   /* 8 bytes with the '\0' */
+#define GRIDBIN_VERSION 1
+#define GRIDBIN_ORDER   0x01020304
+
+/* family */
+#define GRIDBIN_BMASS 0
+#define GRIDBIN_MORT  1
+#define GRIDBIN_SEED  2
+
+/* label at the start of each row */
+#define GRIDBIN_LBL_NONE 0   /* nothing */
+#define GRIDBIN_LBL_YEAR 1   /* "%d%c" year (base1), sep */
+#define GRIDBIN_LBL_AGE  2   /* "Estabs" for row 0, then "%d" age (base1) */
+
+/* how each column's values are written */
+#define GRIDBIN_FMT_REAL  'f'  /* "%f%c" value, sep */
+#define GRIDBIN_FMT_COUNT 'n'  /* "%ld%c" value, sep */
+#define GRIDBIN_FMT_NA    'a'  /* "\"NA\"%c" sep, the value is unused */
+#define GRIDBIN_FMT_MORT  'm'  /* "%c%5.1f" sep, value */
+
+typedef struct {
+  char magic[8];
+  int order, version, family,
+      cells, rows, cols,      /* cells written, rows per cell, columns */
+      grid_rows, grid_cols,
+      label, sep, header_len;
+} GridBin_Header;
+
+#endif
@@ -0,0 +1,133 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_griddump.c
+/*  Type: program
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: griddump converts a binary grid output file
+ *           (see ST_gridbin.h) back into the text files that
+ *           the grid writes for every cell when it isn't asked
+ *           for binary output, so existing scripts still work.
+ *
+ *           usage: griddump file.bin prefix [cell]
+ *
+ *           writes prefix<cell>.out for every cell, or only
+ *           the given cell.  The cells are named with their
+ *           grid cell numbers, so the files of a grid with a
+ *           cell mask are only those of the simulated cells.
+ *           Build with "make griddump"; it doesn't need any of
+ *           the model code.
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*     (10/18/2026) -- reads the cell numbers of a masked grid
+/*
+/********************************************************/
+/********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ST_gridbin.h"
+
+static void _fail(const char *msg, const char *name) {
+  fprintf(stderr, "griddump: %s: %s\n", name, msg);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  GridBin_Header h;
+  FILE *f, *out;
+  char *header, *fmts, name[1024];
+  int names_len, cell, first, last, r, k, *numbers;
+  long long *offsets;
+  float **vals; /* [col][row] of the current cell */
+
+  if (argc != 3 && argc != 4) {
+    fprintf(stderr, "usage: griddump file.bin prefix [cell]\n");
+    return 1;
+  }
+
+  if (NULL == (f = fopen(argv[1], "rb")))
+    _fail("can't open", argv[1]);
+  if (1 != fread(&h, sizeof(h), 1, f)
+      || strcmp(h.magic, GRIDBIN_MAGIC))
+    _fail("not a binary grid output file", argv[1]);
+  if (h.order != GRIDBIN_ORDER)
+    _fail("written with a different byte order", argv[1]);
+  if (h.version != GRIDBIN_VERSION)
+    _fail("unknown version", argv[1]);
+
+  header = (char *) calloc(h.header_len + 1, 1);
+  fmts = (char *) calloc(h.cols + 1, 1);
+  offsets = (long long *) calloc(h.cols + 1, sizeof(long long));
+  vals = (float **) calloc(h.cols + 1, sizeof(float *));
+  numbers = (int *) calloc(h.cells + 1, sizeof(int));
+  if (!header || !fmts || !offsets || !vals || !numbers)
+    _fail("out of memory", argv[1]);
+
+  if (h.header_len != (int) fread(header, 1, h.header_len, f)
+      || h.cols != (int) fread(fmts, 1, h.cols, f)
+      || 1 != fread(&names_len, sizeof(int), 1, f)
+      || fseek(f, names_len, SEEK_CUR)
+      || h.cols != (int) fread(offsets, sizeof(long long), h.cols, f))
+    _fail("truncated header", argv[1]);
+
+  if (h.cells < h.grid_rows * h.grid_cols) {
+    if (h.cells != (int) fread(numbers, sizeof(int), h.cells, f))
+      _fail("truncated header", argv[1]);
+  } else
+    for (cell = 0; cell < h.cells; cell++)
+      numbers[cell] = cell;
+
+  for (k = 0; k < h.cols; k++)
+    if (NULL == (vals[k] = (float *) calloc(h.rows + 1, sizeof(float))))
+      _fail("out of memory", argv[1]);
+
+  first = 0;
+  last = h.cells - 1;
+  if (argc == 4) {
+    k = atoi(argv[3]);
+    for (first = 0; first < h.cells && numbers[first] != k; first++)
+      ;
+    if (first >= h.cells)
+      _fail("no such cell", argv[3]);
+    last = first;
+  }
+
+  for (cell = first; cell <= last; cell++) {
+    for (k = 0; k < h.cols; k++) {
+      if (fseek(f, offsets[k] + (long long) cell * h.rows * sizeof(float), SEEK_SET)
+          || h.rows != (int) fread(vals[k], sizeof(float), h.rows, f))
+        _fail("truncated data", argv[1]);
+    }
+
+    sprintf(name, "%s%d.out", argv[2], numbers[cell]);
+    if (NULL == (out = fopen(name, "w")))
+      _fail("can't create", name);
+
+    fprintf(out, "%s", header);
+    for (r = 0; r < h.rows; r++) {
+      if (h.label == GRIDBIN_LBL_YEAR)
+        fprintf(out, "%d%c", r + 1, h.sep);
+      else if (h.label == GRIDBIN_LBL_AGE) {
+        if (r == 0) fprintf(out, "Estabs");
+        else fprintf(out, "%d", r);
+      }
+      for (k = 0; k < h.cols; k++) {
+        switch (fmts[k]) {
+          case GRIDBIN_FMT_REAL:  fprintf(out, "%f%c", vals[k][r], h.sep); break;
+          case GRIDBIN_FMT_COUNT: fprintf(out, "%ld%c", (long) vals[k][r], h.sep); break;
+          case GRIDBIN_FMT_NA:    fprintf(out, "\"NA\"%c", h.sep); break;
+          case GRIDBIN_FMT_MORT:  fprintf(out, "%c%5.1f", h.sep, vals[k][r]); break;
+        }
+      }
+      fprintf(out, "\n");
+    }
+    fclose(out);
+  }
+
+  fclose(f);
+  for (k = 0; k < h.cols; k++) free(vals[k]);
+  free(vals); free(offsets); free(fmts); free(header); free(numbers);
+
+  return 0;
+}
@@ -8,6 +8,12 @@
 /*     (6/15/2000) -- INITIAL CODING - cwb
  *     15-Apr-02 (cwb) -- added code to interface with SOILWAT
  *	   5-24-2013 (DLM) -- added gridded option to program... see ST_grid.c source file for the rest of the gridded code
+ *     10/18/2026 -- the output is written by a writer thread, see ST_output.c
+ *     10/18/2026 -- added -t option to time the phases of the model, see ST_prof.c
+ *     10/18/2026 -- added -r option to write a trace of the run, see ST_prof.c
+ *     10/18/2026 -- added -h option to count cycles, cache misses, etc by phase, see ST_prof.c
+ *     10/18/2026 -- added -a option to report the memory allocated by each Mem_* tag, see ST_prof.c
+ *     10/18/2026 -- added -j option to simulate the grid cells in worker processes, see ST_grid.c
 /*
 /********************************************************/
 /********************************************************/
@@ -19,10 +25,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <unistd.h>
 #include "ST_steppe.h"
 #include "generic.h"
 #include "filefuncs.h"
 #include "myMemory.h"
+#include "ST_prof.h"
 
 
 #ifdef STEPWAT
@@ -48,6 +57,9 @@
 
   void output_Bmass_Yearly( Int year );
   void output_Mort_Yearly( void );
+  void output_Close( FILE **f );
+  void output_Call( void (*fn)(void) );
+  void output_Finish( void );
 
   void stat_Collect( Int year ) ;
   void stat_Collect_GMort ( void ) ;
@@ -57,6 +69,7 @@
   void stat_Output_AllBmass(void) ;
   
   void runGrid( void ); //for the grid... declared in ST_grid.c
+  void grid_SetWorkers( int n ); //for -j... declared in ST_grid.c
 
 
 #ifdef DEBUG_MEM
@@ -84,13 +97,31 @@ void Debug_AddByYear( Int year);
 /*void chkmem(void);*/
 static void usage(void) {
   char *s ="STEPPE plant community dynamics (SGS-LTER Jan-04).\n"
-           "Usage: steppe [-d startdir] [-f files.in] [-q] [-s] [-e] [-g]\n"
+           "Usage: steppe [-d startdir] [-f files.in] [-q] [-s] [-e] [-g] [-m[quantum]] [-x[n]] [-t[file]] [-r[file]] [-h] [-a[file]] [-j[n]]\n"
            "  -d : supply working directory (default=.)\n"
            "  -f : supply list of input files (default=files.in)\n"
            "  -q : quiet mode, don't print message to check logfile.\n"
            "  -s : use SOILWAT model for resource partitioning.\n"
            "  -e : echo initialization results to logfile\n"
-           "  -g : use gridded mode\n";
+           "  -g : use gridded mode\n"
+           "  -m : with -s, reuse SOILWAT years whose group sizes and\n"
+           "       soil water match to within quantum (default=0.05)\n"
+           "  -x : with -s, estimate SOILWAT years from a fitted surrogate,\n"
+           "       running SOILWAT in full every nth year (default=10)\n"
+           "  -t : write the wall-clock time of each phase of the model\n"
+           "       to file (default=timing.csv)\n"
+           "  -r : write a chrome://tracing (Perfetto) timeline of the\n"
+           "       run to file (default=trace.json); only the first\n"
+           "       1000000 events (about 64 MB) are written\n"
+           "  -h : add the hardware counters (cycles, instructions, cache\n"
+           "       and branch misses) of each phase to the -t file\n"
+           "  -a : write the memory allocated by each part of the model\n"
+           "       to file (default=memory.csv) at the end and when the\n"
+           "       process gets SIGUSR1\n"
+           "  -j : with -g, simulate the cells in n worker processes\n"
+           "       (default=the number of processors); the results are\n"
+           "       the same for any n (-m and -x are turned off when\n"
+           "       the cells are shared out among them)\n";
   fprintf(stderr,"%s", s);
   exit(0);
 }
@@ -142,13 +173,16 @@ int main( int argc, char **argv) {
 
   if(UseGrid == TRUE) {
   	runGrid();
+  	prof_Report();
   	return 0;
   }
 
+  prof_Begin(ProfInit);
   parm_Initialize( 0);
 
   if (UseSoilwat)
     SXW_Init(TRUE);
+  prof_End();
 
   incr = (IntS) ((float)Globals.runModelIterations/10);
   if (incr ==0) incr = 1;
@@ -162,11 +196,14 @@ int main( int argc, char **argv) {
       fprintf(progfp, "%d\n", iter);
     }
 
+      trace_Begin(TraceIter, iter);
+      prof_Begin(ProfInit);
       if (BmassFlags.yearly || MortFlags.yearly)
         parm_Initialize( iter);
 
       Plot_Initialize();
       Globals.currIter = iter;
+      prof_End();
 
    /*Debug_AddByIter( iter); */
 
@@ -177,53 +214,89 @@ int main( int argc, char **argv) {
 
 /* printf("Iter=%d, Year=%d\n", iter, year);  */
           Globals.currYear = year;
+          trace_Begin(TraceYear, year);
+          prof_Poll();
 
+          prof_Begin(ProfEstablish);
           rgroup_Establish();  /* excludes annuals */
+          prof_End();
           chkmem_f;
 
+          prof_Begin(ProfEnviron);
           Env_Generate();
+          prof_End();
 
+          prof_Begin(ProfPartRes);
           rgroup_PartResources();
+          prof_End();
           chkmem_f;
 
+          prof_Begin(ProfGrow);
           rgroup_Grow();
+          prof_End();
 
 #ifdef STEPWAT
          if (!isnull(SXW.debugfile) ) SXW_PrintDebug();
 #endif
 
+          prof_Begin(ProfMort);
           mort_Main( &killedany);
           chkmem_f;
 
           rgroup_IncrAges();
+          prof_End();
 
+          prof_Begin(ProfStats);
           stat_Collect( year);
+          prof_End();
 
+          prof_Begin(ProfOutput);
           if (BmassFlags.yearly)   output_Bmass_Yearly( year);
+          prof_End();
 
           chkmem_t;
+          prof_Begin(ProfMort);
           mort_EndOfYear();
+          prof_End();
           chkmem_t;
+          trace_End(TraceYear);
           
       } /* end model run for this year*/
 
+      prof_Begin(ProfOutput);
       if (BmassFlags.yearly)
-        CloseFile(&Globals.bmass.fp_year);
+        output_Close(&Globals.bmass.fp_year);
+      prof_End();
+      prof_Begin(ProfStats);
       if (MortFlags.summary) {
         stat_Collect_GMort ();
         stat_Collect_SMort ();
       }
+      prof_End();
 
+      prof_Begin(ProfOutput);
       if (MortFlags.yearly)
         output_Mort_Yearly();
+      prof_End();
+      trace_End(TraceIter);
 
   } /* end model run for this iteration*/
 
  /*------------------------------------------------------*/
+  /* written by the output thread after the yearly output */
+  prof_Begin(ProfOutput);
   if (MortFlags.summary)
-    stat_Output_AllMorts( );
+    output_Call( stat_Output_AllMorts);
   if (BmassFlags.summary)
-    stat_Output_AllBmass();
+    output_Call( stat_Output_AllBmass);
+  output_Finish();
+  prof_End();
+  prof_Report();
+
+  if (UseSoilwat) {
+    SXW_MemoFree();
+    SXW_EmuFree();
+  }
 
   fprintf(progfp,"\n");
   return 0;
@@ -323,19 +396,24 @@ static void init_args(int argc, char **argv) {
    *         stderr.
    */
   char str[1024],
-       *opts[]  = {"-d","-f","-q","-s","-e", "-p", "-g"};  /* valid options */
-  int valopts[] = {  1,   1,   0,  -1,   0,    0 ,   0};  /* indicates options with values */
+       *opts[]  = {"-d","-f","-q","-s","-e", "-p", "-g", "-m", "-x", "-t", "-r", "-h", "-a", "-j"};  /* valid options */
+  int valopts[] = {  1,   1,   0,  -1,   0,    0 ,   0,   -1,   -1,   -1,   -1,    0,   -1,   -1};  /* indicates options with values */
                  /* 0=none, 1=required, -1=optional */
   int i, /* looper through all cmdline arguments */
       a, /* current valid argument-value position */
       op, /* position number of found option */
+      workers, /* n of -j */
+      refresh, /* n of -x */
       nopts=sizeof(opts)/sizeof(char *);
-  Bool lastop_noval = FALSE;
+  Bool lastop_noval = FALSE,
+       counters = FALSE;
 
   /* Defaults */
   parm_SetFirstName( DFLT_FIRSTFILE);
   UseSoilwat = QuietMode = EchoInits = UseSeedDispersal = FALSE;
   SXW.debugfile = NULL;
+  SXW.memo_quantum = 0.;
+  SXW.emu_refresh = 0;
   progfp = stderr;
 
 
@@ -408,6 +486,41 @@ static void init_args(int argc, char **argv) {
       
       case 6:  UseGrid = TRUE;				break; /* -g */
 
+      case 7:  SXW.memo_quantum = (*str) ? atof(str) : 0.05;  /* -m */
+               if (!GT(SXW.memo_quantum, 0.)) {
+                 LogError(stderr, LOGFATAL,
+                 "Invalid memo quantum (%s)", str);
+               }
+               break;
+
+      case 8:  refresh = (*str) ? atoi(str) : 10;  /* -x */
+               if (refresh < 2 || refresh > USHRT_MAX) {
+                 LogError(stderr, LOGFATAL,
+                 "Invalid emulator refresh period (%s), it has to be "
+                 "from 2 to %d", str, USHRT_MAX);
+               }
+               SXW.emu_refresh = (IntUS) refresh;
+               break;
+
+      case 9:  prof_Start( (*str) ? str : "timing.csv");  /* -t */
+               break;
+
+      case 10: trace_Start( (*str) ? str : "trace.json");  /* -r */
+               break;
+
+      case 11: counters = TRUE;            break;  /* -h */
+
+      case 12: prof_Memory( (*str) ? str : "memory.csv");  /* -a */
+               break;
+
+      case 13: workers = (*str) ? atoi(str) : (int) sysconf(_SC_NPROCESSORS_ONLN);  /* -j */
+               if (workers < 1) {
+                 LogError(stderr, LOGFATAL,
+                 "Invalid number of worker processes (%s)", str);
+               }
+               grid_SetWorkers(workers);
+               break;
+
       default:
         LogError(logfp, LOGFATAL, "Programmer: bad option in main:init_args:switch");
     }
@@ -416,6 +529,9 @@ static void init_args(int argc, char **argv) {
 
   }  /* end for(i) */
 
+  /* after the loop so that -t can come after -h */
+  if (counters) prof_Counters();
+
 
 }
 
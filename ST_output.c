@@ -8,6 +8,11 @@
 /*
 /*  History:
 /*     (6/15/2000) -- INITIAL CODING - cwb
+/*     (10/18/2026) -- the yearly output is formatted and
+ *           written by a writer thread fed through a
+ *           bounded queue of records.
+ *     (10/18/2026) -- the writer and waits for it are traced
+ *           with -r (ST_prof.c).
 /*
 /********************************************************/
 /********************************************************/
@@ -18,9 +23,17 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include "ST_steppe.h"
 #include "ST_globals.h"
 #include "filefuncs.h"
+#include "myMemory.h"
+#include "ST_prof.h"
+
+/* records the writer thread can hold before the
+ * simulation has to wait for it */
+#define OUT_QUEUE_LEN 64
 
 /******** Modular External Function Declarations ***********/
 /* -- truly global functions are declared in functions.h --*/
@@ -37,6 +50,58 @@
 /* (like C++ friend functions) but have to be declared. */
   void output_Bmass_Yearly( Int year );
   void output_Mort_Yearly( void );
+  void output_Close( FILE **f );
+  void output_Call( void (*fn)(void) );
+  void output_Finish( void );
+
+/************************ Local Structure Defs *************/
+/***********************************************************/
+/* The yearly output is written by a separate thread so that
+ * a slow disk doesn't hold up the model.  The simulation
+ * thread copies the values of each output line into a record
+ * of a fixed ring of OUT_QUEUE_LEN records, and the writer
+ * thread formats and writes them in order.  One semaphore
+ * counts the free records and one the filled ones; with just
+ * one thread on each end, nothing else needs locking.
+ */
+typedef enum {OUT_BMASS, OUT_MORT, OUT_CLOSE, OUT_CALL, OUT_STOP}
+  OutRecordType;
+
+typedef struct {
+  OutRecordType type;
+  FILE *f;
+  void (*call)(void);   /* OUT_CALL */
+
+  /* OUT_BMASS: the values in output_Bmass_Yearly() */
+  int year;
+  DisturbEvent dist;
+  IntS ppt;
+  PPTClass pclass;
+  RealF temp,
+        grp_bmass[MAX_RGROUPS], grp_size[MAX_RGROUPS],
+        grp_pr[MAX_RGROUPS], spp_bmass[MAX_SPECIES];
+  SppIndex spp_count[MAX_SPECIES];
+
+  /* OUT_MORT: estabs of each group and species, then the
+   * kills of each group and species (for max_age each).
+   * The buffer stays with the record and is reused. */
+  IntUS *mort;
+  size_t mort_size;
+} OutRecord;
+
+static OutRecord _queue[OUT_QUEUE_LEN];
+static int _head, _tail;
+static sem_t _free_slots, _full_slots;
+static pthread_t _writer;
+static Bool _running;
+
+/*************** Local Function Declarations ***************/
+/***********************************************************/
+static OutRecord *_queue_get( void );
+static void _queue_put( void );
+static void *_write_records( void *arg );
+static void _write_bmass( OutRecord *r );
+static void _write_mort( OutRecord *r );
 
 
 
@@ -46,7 +111,213 @@ void output_Bmass_Yearly( Int year ) {
 /*======================================================*/
 /* note that year is only printed, not used as index, so
  * we don't need to decrement to make base0
+ *
+ * only takes a copy of this year's values, the writer
+ * thread formats and writes them (see _write_bmass()).
+ */
+  OutRecord *r;
+  GrpIndex rg;
+  SppIndex sp;
+
+  if (!BmassFlags.yearly) return;
+
+  r = _queue_get();
+  r->type = OUT_BMASS;
+  r->f = Globals.bmass.fp_year;
+
+  #ifdef STEPWAT
+    if (UseSoilwat)
+      r->year = SW_Model.year;
+    else
+  #endif
+      r->year = year;
+  r->dist = Plot.disturbance;
+  r->ppt = Env.ppt;
+  r->pclass = Env.wet_dry;
+  r->temp = Env.temp;
+
+  ForEachGroup(rg) {
+    r->grp_bmass[rg] = RGroup_GetBiomass(rg);
+    r->grp_size[rg] = RGroup[rg]->relsize;
+    r->grp_pr[rg] = RGroup[rg]->pr;
+  }
+  ForEachSpecies(sp) {
+    r->spp_bmass[sp] = Species_GetBiomass(sp);
+    r->spp_count[sp] = Species[sp]->est_count;
+  }
+
+  _queue_put();
+}
+
+
+/***********************************************************/
+void output_Mort_Yearly( void ) {
+/*======================================================*/
+/* copies the establishments and kills of the iteration
+ * for the writer thread (see _write_mort()), which also
+ * closes the file after them.
+ */
+  OutRecord *r;
+  IntUS *m;
+  GrpIndex rg;
+  SppIndex sp;
+  size_t n;
+
+  if (!MortFlags.yearly) return;
+
+  r = _queue_get();
+  r->type = OUT_MORT;
+  r->f = Globals.mort.fp_year;
+
+  n = Globals.grpCount + Globals.sppCount;
+  ForEachGroup(rg) n += GrpMaxAge(rg);
+  ForEachSpecies(sp) n += SppMaxAge(sp);
+  if (n > r->mort_size) {
+    r->mort = (IntUS *) (isnull(r->mort)
+                ? Mem_Malloc(n * sizeof(IntUS), "output_Mort_Yearly()")
+                : Mem_ReAlloc(r->mort, n * sizeof(IntUS)));
+    r->mort_size = n;
+  }
+
+  m = r->mort;
+  ForEachGroup(rg) *m++ = RGroup[rg]->estabs;
+  ForEachSpecies(sp) *m++ = Species[sp]->estabs;
+  ForEachGroup(rg) {
+    Mem_Copy(m, RGroup[rg]->kills, GrpMaxAge(rg) * sizeof(IntUS));
+    m += GrpMaxAge(rg);
+  }
+  ForEachSpecies(sp) {
+    Mem_Copy(m, Species[sp]->kills, SppMaxAge(sp) * sizeof(IntUS));
+    m += SppMaxAge(sp);
+  }
+
+  _queue_put();
+  output_Close(&Globals.mort.fp_year);
+}
+
+
+/***********************************************************/
+void output_Close( FILE **f ) {
+/*======================================================*/
+/* closes a file that output records were queued for,
+ * after they've been written.  Like CloseFile(), sets
+ * *f to NULL (right away, so the next one can be opened).
  */
+  OutRecord *r = _queue_get();
+
+  r->type = OUT_CLOSE;
+  r->f = *f;
+  _queue_put();
+  *f = NULL;
+}
+
+
+/***********************************************************/
+void output_Call( void (*fn)(void) ) {
+/*======================================================*/
+/* runs fn (eg stat_Output_AllBmass) on the writer thread,
+ * after the records queued so far.
+ */
+  OutRecord *r = _queue_get();
+
+  r->type = OUT_CALL;
+  r->call = fn;
+  _queue_put();
+}
+
+
+/***********************************************************/
+void output_Finish( void ) {
+/*======================================================*/
+/* waits until everything queued has been written, then
+ * stops the writer thread.  Call before the program ends.
+ */
+  int i;
+
+  if (!_running) return;
+
+  _queue_get()->type = OUT_STOP;
+  _queue_put();
+  pthread_join(_writer, NULL);
+  _running = FALSE;
+
+  for (i = 0; i < OUT_QUEUE_LEN; i++) {
+    if (!isnull(_queue[i].mort)) Mem_Free(_queue[i].mort);
+    _queue[i].mort = NULL;
+    _queue[i].mort_size = 0;
+  }
+  sem_destroy(&_free_slots);
+  sem_destroy(&_full_slots);
+}
+
+
+/***********************************************************/
+static OutRecord *_queue_get( void ) {
+/*======================================================*/
+/* returns the next free record, after waiting for the
+ * writer if the queue is full.  Starts the writer the
+ * first time.  Only the simulation thread queues records,
+ * so the head needs no lock.
+ */
+
+  if (!_running) {
+    _head = _tail = 0;
+    if (sem_init(&_free_slots, 0, OUT_QUEUE_LEN)
+        || sem_init(&_full_slots, 0, 0)
+        || pthread_create(&_writer, NULL, _write_records, NULL))
+      LogError(logfp, LOGFATAL, "Can't start the output writer thread");
+    _running = TRUE;
+  }
+
+  trace_Begin(TraceQueueWait, -1);
+  while (sem_wait(&_free_slots)) ; /* retry if interrupted */
+  trace_End(TraceQueueWait);
+  return &_queue[_head];
+}
+
+
+/***********************************************************/
+static void _queue_put( void ) {
+/*======================================================*/
+/* hands the record from _queue_get() to the writer */
+
+  _head = (_head + 1) % OUT_QUEUE_LEN;
+  sem_post(&_full_slots);
+}
+
+
+/***********************************************************/
+static void *_write_records( void *arg ) {
+/*======================================================*/
+/* the writer thread: formats and writes the records in
+ * the order they were queued until it gets OUT_STOP.
+ */
+  OutRecord *r;
+
+  trace_Thread("writer");
+  for(;;) {
+    while (sem_wait(&_full_slots)) ;
+    r = &_queue[_tail];
+    _tail = (_tail + 1) % OUT_QUEUE_LEN;
+
+    if (r->type != OUT_STOP) trace_Begin(TraceWrite, r->type);
+    switch (r->type) {
+      case OUT_BMASS: _write_bmass(r); break;
+      case OUT_MORT:  _write_mort(r); break;
+      case OUT_CLOSE: CloseFile(&r->f); break;
+      case OUT_CALL:  r->call(); break;
+      case OUT_STOP:  return NULL;
+    }
+    trace_End(TraceWrite);
+
+    sem_post(&_free_slots);
+  }
+}
+
+
+/***********************************************************/
+static void _write_bmass( OutRecord *r ) {
+/*======================================================*/
   char fields[MAX_OUTFIELDS][MAX_FIELDLEN+1];
   GrpIndex rg;
   SppIndex sp;
@@ -54,19 +325,11 @@ void output_Bmass_Yearly( Int year ) {
   char s[MAX_FIELDLEN];
 
 
-  if (!BmassFlags.yearly) return;
-
-  if (BmassFlags.yr) {
-    #ifdef STEPWAT
-      if (UseSoilwat)
-        sprintf(fields[fc++], "%d", SW_Model.year);
-      else
-    #endif
-        sprintf(fields[fc++], "%d", year);
-  }
+  if (BmassFlags.yr)
+    sprintf(fields[fc++], "%d", r->year);
 
   if (BmassFlags.dist) {
-    switch (Plot.disturbance) {
+    switch (r->dist) {
       case NoDisturb: strcpy(s, "None"); break;
       case FecalPat: strcpy(s, "Pat"); break;
       case AntMound: strcpy(s, "Mound"); break;
@@ -77,10 +340,10 @@ void output_Bmass_Yearly( Int year ) {
   }
 
   if (BmassFlags.ppt)
-    sprintf(fields[fc++], "%d", Env.ppt);
+    sprintf(fields[fc++], "%d", r->ppt);
 
   if (BmassFlags.pclass) {
-    switch (Env.wet_dry) {
+    switch (r->pclass) {
       case Ppt_Norm: strcpy(s, "Normal"); break;
       case Ppt_Wet: strcpy(s, "Wet"); break;
       case Ppt_Dry: strcpy(s, "Dry"); break;
@@ -90,46 +353,46 @@ void output_Bmass_Yearly( Int year ) {
   }
 
   if (BmassFlags.tmp)
-    sprintf(fields[fc++], "%0.1f", Env.temp);
+    sprintf(fields[fc++], "%0.1f", r->temp);
 
   if (BmassFlags.grpb) {
     ForEachGroup(rg) {
-      sprintf(fields[fc++], "%f", RGroup_GetBiomass(rg));
+      sprintf(fields[fc++], "%f", r->grp_bmass[rg]);
       if (BmassFlags.size)
-        sprintf(fields[fc++],"%f", RGroup[rg]->relsize);
+        sprintf(fields[fc++],"%f", r->grp_size[rg]);
       if (BmassFlags.pr)
-        sprintf(fields[fc++],"%f", RGroup[rg]->pr);
+        sprintf(fields[fc++],"%f", r->grp_pr[rg]);
     }
   }
 
   if (BmassFlags.sppb) {
     ForEachSpecies(sp) {
-      sprintf(fields[fc++], "%f", Species_GetBiomass(sp));
+      sprintf(fields[fc++], "%f", r->spp_bmass[sp]);
       if (BmassFlags.indv)
-        sprintf(fields[fc++],"%d", Species[sp]->est_count);
+        sprintf(fields[fc++],"%d", r->spp_count[sp]);
     }
   }
 
   /* Write data line to already opened file */
   for (i=0; i< fc-1; i++) {
-    fprintf(Globals.bmass.fp_year,"%s%c", fields[i], BmassFlags.sep);
+    fprintf(r->f,"%s%c", fields[i], BmassFlags.sep);
   }
 
-  if (i) fprintf(Globals.bmass.fp_year,"%s\n", fields[i]);
+  if (i) fprintf(r->f,"%s\n", fields[i]);
 
 
 }
 
 
 /***********************************************************/
-void output_Mort_Yearly( void ) {
+static void _write_mort( OutRecord *r ) {
 /*======================================================*/
 
   IntS age,rg,sp;
-  FILE *f = Globals.mort.fp_year;
-
-
-  if (!MortFlags.yearly) return;
+  FILE *f = r->f;
+  IntUS *estabs = r->mort,
+        *kills = r->mort + Globals.grpCount + Globals.sppCount,
+        *k;
 
 
   /* Note: Header line already printed */
@@ -138,12 +401,12 @@ void output_Mort_Yearly( void ) {
   fprintf(f,"(Estabs)");
   if (MortFlags.group) {
     ForEachGroup(rg)
-      fprintf(Globals.mort.fp_year,"%c%d",
-              MortFlags.sep, RGroup[rg]->estabs);
+      fprintf(f,"%c%d",
+              MortFlags.sep, estabs[rg]);
   }
   if (MortFlags.species) {
     ForEachSpecies(sp)
-      fprintf(f,"%c%d",MortFlags.sep, Species[sp]->estabs);
+      fprintf(f,"%c%d",MortFlags.sep, estabs[Globals.grpCount + sp]);
   }
   fprintf(f,"\n");
 
@@ -151,25 +414,28 @@ void output_Mort_Yearly( void ) {
   /* now print the kill data */
   for(age=0; age < Globals.Max_Age; age++) {
     fprintf(f,"%d", age+1);
+    k = kills;
     if (MortFlags.group) {
       ForEachGroup(rg){
         if(age < GrpMaxAge(rg))
-          fprintf(f,"%c%d", MortFlags.sep, RGroup[rg]->kills[age]);
+          fprintf(f,"%c%d", MortFlags.sep, k[age]);
         else
           fprintf(f, "%c", MortFlags.sep);
+        k += GrpMaxAge(rg);
       }
+    } else {
+      ForEachGroup(rg) k += GrpMaxAge(rg);
     }
     if (MortFlags.species) {
       ForEachSpecies(sp) {
         if (age < SppMaxAge(sp))
-          fprintf(f,"%c%d", MortFlags.sep, Species[sp]->kills[age]);
+          fprintf(f,"%c%d", MortFlags.sep, k[age]);
         else
           fprintf(f, "%c", MortFlags.sep);
+        k += SppMaxAge(sp);
       }
     }
     fprintf(f,"\n");
   }
 
-  CloseFile(&Globals.mort.fp_year);
 }
-
@@ -0,0 +1,212 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_pack.c
+/*  Type: module
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: Fast compression of blocks of memory, for the
+ *           state of the grid cells that aren't being
+ *           simulated (see _pack_cell() in ST_grid.c).  The
+ *           packed blocks are in the LZ4 block format
+ *           (sequences of literals and matches of earlier
+ *           bytes at most 64K back), written by a small greedy
+ *           compressor that looks for 4 byte matches through a
+ *           hash table.  That is not the best ratio, but it is
+ *           fast both ways, and a cell's state is mostly zeros
+ *           and repeated layer values that it packs well
+ *           anyway.  No library is needed.
+ *
+ *           pack_Compress() writes at most pack_Bound(size)
+ *           bytes.  pack_Decompress() checks every length and
+ *           offset against the buffers, so a damaged block
+ *           makes it fail instead of writing past them.
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*
+/********************************************************/
+/********************************************************/
+
+/* =================================================== */
+/*                INCLUDES / DEFINES                   */
+/* --------------------------------------------------- */
+
+#include <string.h>
+#include "ST_pack.h"
+
+/* entries in the hash table of 4 byte sequences */
+#define PACK_HASHLOG 12
+
+/* the shortest match, and how far back a match can be */
+#define PACK_MINMATCH 4
+#define PACK_MAXOFFSET 65535
+
+/* the format ends with at least 5 literals, and the last
+ * match starts at least 12 bytes before the end */
+#define PACK_LASTLITERALS 5
+#define PACK_MFLIMIT 12
+
+/* misses in a row before the compressor starts skipping
+ * ahead, 1 << PACK_SKIPLOG */
+#define PACK_SKIPLOG 6
+
+typedef unsigned char byte_t;
+
+/*************** Local Function Declarations ***************/
+/***********************************************************/
+static unsigned int _read32( const byte_t *p);
+static unsigned int _hash( unsigned int v);
+static byte_t *_put_length( byte_t *op, int len);
+
+/***********************************************************/
+/****************** Begin Function Code ********************/
+/***********************************************************/
+
+static unsigned int _read32( const byte_t *p) {
+/*======================================================*/
+  unsigned int v;
+
+  memcpy(&v, p, sizeof(v)); /* p doesn't have to be aligned */
+  return v;
+}
+
+static unsigned int _hash( unsigned int v) {
+/*======================================================*/
+  return (v * 2654435761U) >> (32 - PACK_HASHLOG);
+}
+
+static byte_t *_put_length( byte_t *op, int len) {
+/*======================================================*/
+/* the rest of a length that didn't fit in the token */
+  for (; len >= 255; len -= 255) *op++ = 255;
+  *op++ = (byte_t) len;
+  return op;
+}
+
+int pack_Bound( int size) {
+/*======================================================*/
+/* the most pack_Compress() can write for size bytes */
+  return size + size / 255 + 16;
+}
+
+int pack_Compress( const void *src, int size, void *dst) {
+/*======================================================*/
+/* packs size bytes of src into dst, which has to have room
+ * for pack_Bound(size) bytes; returns the packed size */
+  const byte_t *base = (const byte_t *) src,
+               *ip = base, *anchor = base, *ref,
+               *iend = base + size,
+               *mflimit = iend - PACK_MFLIMIT,
+               *matchlimit = iend - PACK_LASTLITERALS;
+  byte_t *op = (byte_t *) dst, *token;
+  int table[1 << PACK_HASHLOG], lit, len, misses = 0;
+  unsigned int h;
+  size_t w1, w2;
+
+  if (size > PACK_MFLIMIT) {
+    memset(table, 0xff, sizeof(table)); /* -1, no position yet */
+
+    while (ip < mflimit) {
+      h = _hash(_read32(ip));
+      ref = (table[h] < 0) ? NULL : base + table[h];
+      table[h] = (int) (ip - base);
+
+      if (ref == NULL || ip - ref > PACK_MAXOFFSET
+          || _read32(ref) != _read32(ip)) {
+        ip += 1 + (misses++ >> PACK_SKIPLOG);
+        continue;
+      }
+      misses = 0;
+
+      /* a word at a time, then the last few bytes */
+      for (len = PACK_MINMATCH; ip + len + sizeof(size_t) <= matchlimit; len += sizeof(size_t)) {
+        memcpy(&w1, ref + len, sizeof(size_t));
+        memcpy(&w2, ip + len, sizeof(size_t));
+        if (w1 != w2) break;
+      }
+      for (; ip + len < matchlimit && ref[len] == ip[len]; len++) ;
+
+      /* the literals since the last match, then the match */
+      lit = (int) (ip - anchor);
+      token = op++;
+      *token = (byte_t) ((lit >= 15 ? 15 : lit) << 4);
+      if (lit >= 15) op = _put_length(op, lit - 15);
+      memcpy(op, anchor, lit);
+      op += lit;
+
+      *op++ = (byte_t) ((ip - ref) & 0xff);
+      *op++ = (byte_t) ((ip - ref) >> 8);
+      len -= PACK_MINMATCH;
+      *token |= (byte_t) (len >= 15 ? 15 : len);
+      if (len >= 15) op = _put_length(op, len - 15);
+
+      ip += len + PACK_MINMATCH;
+      anchor = ip;
+    }
+  }
+
+  /* the last literals */
+  lit = (int) (iend - anchor);
+  token = op++;
+  *token = (byte_t) ((lit >= 15 ? 15 : lit) << 4);
+  if (lit >= 15) op = _put_length(op, lit - 15);
+  memcpy(op, anchor, lit);
+  op += lit;
+
+  return (int) (op - (byte_t *) dst);
+}
+
+int pack_Decompress( const void *src, int csize, void *dst, int size) {
+/*======================================================*/
+/* unpacks csize bytes of src, which have to unpack to
+ * exactly size bytes, into dst; returns 0, or -1 if src
+ * isn't a packed block of that size */
+  const byte_t *ip = (const byte_t *) src, *iend = ip + csize, *ref;
+  byte_t *out = (byte_t *) dst, *op = out, *oend = out + size;
+  int lit, len, off, b;
+
+  while (ip < iend) {
+    b = *ip++;
+    lit = b >> 4;
+    len = b & 15;
+
+    if (lit == 15) {
+      do {
+        if (ip >= iend) return -1;
+        b = *ip++;
+        lit += b;
+      } while (b == 255);
+    }
+    if (lit > iend - ip || lit > oend - op) return -1;
+    memcpy(op, ip, lit);
+    op += lit;
+    ip += lit;
+    if (ip == iend) break; /* the last sequence has no match */
+
+    if (iend - ip < 2) return -1;
+    off = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (off == 0 || off > op - out) return -1;
+
+    if (len == 15) {
+      do {
+        if (ip >= iend) return -1;
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    len += PACK_MINMATCH;
+    if (len > oend - op) return -1;
+
+    /* the match can overlap what it writes (eg a run of
+     * zeros is a match 1 byte back) */
+    ref = op - off;
+    if (off == 1)
+      memset(op, *ref, len);
+    else if (off >= len)
+      memcpy(op, ref, len);
+    else
+      for (b = 0; b < len; b++) op[b] = ref[b];
+    op += len;
+  }
+
+  return (op == oend) ? 0 : -1;
+}
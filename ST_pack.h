@@ -0,0 +1,22 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_pack.h
+/*  Type: header
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: Fast compression of blocks of memory, used by
+ *           ST_grid.c to keep the state of the cells that
+ *           aren't being simulated packed (see ST_pack.c).
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*
+/********************************************************/
+/********************************************************/
+
+#ifndef PACK_DEF_H
+#define PACK_DEF_H
+
+int pack_Bound( int size);
+int pack_Compress( const void *src, int size, void *dst);
+int pack_Decompress( const void *src, int csize, void *dst, int size);
+
+#endif
@@ -1077,7 +1077,7 @@ static void _species_init( void) {
          continue;
       }
 
-      x=sscanf( inbuf, "%s %hd %hd %f %f %hd %hd %f %hd %f %f %s %hd %hd %f %hd %hd",
+      x=sscanf( inbuf, "%s %hd %hd %f %f %hd %hd %f %hd %f %f %s %hd %hd %f %hd",
                 name,
                 &rg, &age, &irate, &ratep, &slow, &dist,
                 &estab, &eind, &minb, &maxb, clonal,
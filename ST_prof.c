@@ -0,0 +1,567 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_prof.c
+/*  Type: module
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: Optional wall-clock timing of the phases of the
+ *           model (see ST_prof.h), turned on by the -t
+ *           command line option.  The model marks where each
+ *           phase begins and ends with prof_Begin() and
+ *           prof_End(); phases can nest (eg SOILWAT inside
+ *           SXW inside the environment), and each phase is
+ *           only charged for the time that isn't spent in the
+ *           phases inside it, so the phases add up to the
+ *           whole run.  In the gridded version the time is
+ *           also added up for each cell (prof_SetCell()).
+ *
+ *           prof_Report() writes the totals, the mean per
+ *           cell-year, cell-years per second, and the cost of
+ *           each cell (and the peak resident memory) to the
+ *           file given with -t, as lines of comma separated
+ *           fields whose first field says what the line is.
+ *
+ *           When timing is off each call just returns.
+ *
+ *           The -r option writes a trace of the same phases,
+ *           plus spans for iterations, years, cells, and the
+ *           output threads (trace_Begin(), trace_End()), that
+ *           chrome://tracing or Perfetto can show as a
+ *           timeline.  Each thread puts its events in its own
+ *           ring of TRACE_RINGLEN events, which is only written
+ *           to the file (under a lock) when it fills up and at
+ *           the end, so tracing costs a clock read and a few
+ *           stores per event.  Every phase of every cell-year
+ *           is an event, so the trace stops after
+ *           TRACE_MAXEVENTS events (about 64 MB), with a note
+ *           in the log file, and a big grid only has the
+ *           start of the run in it.
+ *
+ *           The -h option also counts cycles, instructions,
+ *           cache misses, and branch misses (Linux
+ *           perf_event_open(), for this thread in user mode,
+ *           so it doesn't need root) and charges them to the
+ *           phases like the time, for the IPC and misses per
+ *           cell-year of each phase in the timing report.  If
+ *           the counters aren't available (eg in some VMs) a
+ *           warning is logged and only the time is reported.
+ *
+ *           The -a option writes the allocation counters of
+ *           each Mem_* tag (see mymemory.c) to a file at the
+ *           end of the run, after the setup of the grid, and
+ *           at the next year after the process gets SIGUSR1
+ *           (kill -USR1 pid), so the footprint of a long run
+ *           can be looked at while it's running.
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*     (10/18/2026) -- added the trace (-r)
+/*     (10/18/2026) -- added the hardware counters (-h)
+/*     (10/18/2026) -- added the allocation report (-a)
+/*     (10/18/2026) -- cell-years only count the cells that
+ *                     aren't masked out of the grid
+/*     (10/18/2026) -- added prof_Worker() for the worker
+ *                     processes of the grid (-j)
+/*     (10/18/2026) -- the trace stops after TRACE_MAXEVENTS
+ *                     events
+/*     (10/18/2026) -- with -j the phases are only timed for
+ *                     the cells this process simulated, so
+ *                     their cell-years are counted with
+ *                     prof_AddCells()
+/*
+/********************************************************/
+/********************************************************/
+
+/* =================================================== */
+/*                INCLUDES / DEFINES                   */
+/* --------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#ifdef __linux__
+  #include <unistd.h>
+  #include <sys/resource.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <linux/perf_event.h>
+#endif
+#include "ST_steppe.h"
+#include "ST_globals.h"
+#include "filefuncs.h"
+#include "myMemory.h"
+#include "ST_prof.h"
+
+/* deepest nesting of phases */
+#define PROF_MAXDEPTH 16
+
+/* events each thread holds before writing them */
+#define TRACE_RINGLEN 4096
+
+/* most events written to the trace, about 64 bytes each */
+#define TRACE_MAXEVENTS 1000000
+
+/* the hardware counters, in the order of the group */
+#define PROF_NCOUNTERS 4
+
+/*************** Local Variable Declarations ***************/
+/***********************************************************/
+static char *_phase_names[] = {"init", "load_cell", "establish",
+    "environs", "sxw", "soilwat", "part_resources", "grow",
+    "mortality", "stats", "save_cell", "dispersal", "output", "other",
+    /* the TraceSpans */
+    "iteration", "year", "cell", "output_cell", "write", "queue_wait"};
+
+typedef struct trace_ring_st TraceRing;
+struct trace_ring_st {
+  struct {
+    double ts;      /* microseconds since the start */
+    int arg;        /* -1 for none */
+    char ph,        /* 'B'egin or 'E'nd */
+         what;      /* ProfPhase or TraceSpan */
+  } ev[TRACE_RINGLEN];
+  int n, tid;
+  TraceRing *next;
+};
+
+static Bool _tracing;
+static FILE *_trace_fp;
+static double _trace_start;
+static int _trace_nevents, _trace_ntids;
+static volatile Bool _trace_full; /* TRACE_MAXEVENTS have been written */
+static TraceRing *_rings;       /* every thread's ring */
+static pthread_mutex_t _trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread TraceRing *_ring;
+
+static FILE *_mem_fp;           /* the -a file, NULL if not asked for */
+static volatile sig_atomic_t _mem_signaled;
+
+static Bool _on;
+static FILE *_fp;
+static double _start,           /* when prof_Start() was called */
+              _last,            /* when the time was last charged */
+              _total[ProfLastPhase];
+static unsigned long _calls[ProfLastPhase];
+static ProfPhase _stack[PROF_MAXDEPTH];
+static int _depth;
+
+static double *_cell_cost;      /* seconds charged to each cell */
+static int _rows = 1, _cols = 1, _cells = 1, _cell = -1,
+           _own_cells = -1;     /* cells this process simulated (-j),
+                                 * -1 if it simulated all of them */
+
+static char *_counter_names[] = {"cycles", "instructions",
+    "cache_misses", "branch_misses"};
+static int _counter_fd = -1;    /* group leader, -1 if not counting */
+static unsigned long long _counts[ProfLastPhase][PROF_NCOUNTERS],
+                          _last_count[PROF_NCOUNTERS];
+
+/*************** Local Function Declarations ***************/
+/***********************************************************/
+static double _now( void);
+static void _charge( void);
+static Bool _read_counters( unsigned long long *c);
+static void _mem_signal( int sig);
+static void _trace_event( char ph, int what, int arg);
+static void _trace_flush( TraceRing *r);
+static void _trace_finish( void);
+
+/***********************************************************/
+/****************** Begin Function Code ********************/
+/***********************************************************/
+
+static double _now( void) {
+/*======================================================*/
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void _charge( void) {
+/*======================================================*/
+/* adds the time since the last charge to the innermost
+ * phase and to the current cell */
+  double t = _now(), dt = t - _last;
+
+  ProfPhase p = _depth ? _stack[_depth-1] : ProfOther;
+  unsigned long long c[PROF_NCOUNTERS];
+  int i;
+
+  _total[p] += dt;
+  if (_cell >= 0 && !isnull(_cell_cost)) _cell_cost[_cell] += dt;
+  _last = t;
+
+  if (_counter_fd >= 0 && _read_counters(c)) {
+    for (i = 0; i < PROF_NCOUNTERS; i++) {
+      _counts[p][i] += c[i] - _last_count[i];
+      _last_count[i] = c[i];
+    }
+  }
+}
+
+static Bool _read_counters( unsigned long long *c) {
+/*======================================================*/
+/* reads the whole group at once */
+#ifdef __linux__
+  unsigned long long buf[1 + PROF_NCOUNTERS]; /* nr, then the values */
+  int i;
+
+  if (read(_counter_fd, buf, sizeof(buf)) != sizeof(buf)
+      || buf[0] != PROF_NCOUNTERS)
+    return FALSE;
+  for (i = 0; i < PROF_NCOUNTERS; i++) c[i] = buf[i+1];
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+void prof_Counters( void) {
+/*======================================================*/
+/* starts the hardware counters (and the timing, if -t
+ * wasn't given) */
+#ifdef __linux__
+  static unsigned long long config[] = {PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES};
+  struct perf_event_attr pe;
+  int i, fd;
+#endif
+
+  if (!_on) prof_Start("timing.csv");
+
+#ifdef __linux__
+  for (i = 0; i < PROF_NCOUNTERS; i++) {
+    memset(&pe, 0, sizeof(pe));
+    pe.type = PERF_TYPE_HARDWARE;
+    pe.size = sizeof(pe);
+    pe.config = config[i];
+    pe.read_format = PERF_FORMAT_GROUP;
+    pe.disabled = (i == 0);   /* the group starts with the leader */
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    fd = syscall(__NR_perf_event_open, &pe, 0, -1, _counter_fd, 0);
+    if (fd < 0) {
+      LogError(logfp ? logfp : stderr, LOGWARN, "Hardware counter %s isn't "
+               "available (perf_event_open), only timing the phases",
+               _counter_names[i]);
+      if (_counter_fd >= 0) close(_counter_fd); /* closes the group */
+      _counter_fd = -1;
+      return;
+    }
+    if (i == 0) _counter_fd = fd;
+  }
+
+  ioctl(_counter_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(_counter_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  _read_counters(_last_count);
+#else
+  LogError(logfp ? logfp : stderr, LOGWARN, "Hardware counters are only "
+           "available on Linux, only timing the phases");
+#endif
+}
+
+static void _mem_signal( int sig) {
+/*======================================================*/
+/* only notes the signal, prof_Poll() writes the report */
+  _mem_signaled = 1;
+}
+
+void prof_Memory( const char *filename) {
+/*======================================================*/
+/* turns the allocation report on */
+
+  _mem_fp = OpenFile(filename, "w");
+#ifdef SIGUSR1
+  signal(SIGUSR1, _mem_signal);
+#endif
+}
+
+void prof_MemReport( const char *when) {
+/*======================================================*/
+/* writes the allocation counters now, if asked for */
+
+  if (!isnull(_mem_fp)) Mem_Report(_mem_fp, when);
+}
+
+void prof_Poll( void) {
+/*======================================================*/
+/* called once a year, writes the allocation counters if
+ * SIGUSR1 came since the last call */
+
+  if (_mem_signaled) {
+    _mem_signaled = 0;
+    prof_MemReport("signal");
+  }
+}
+
+void prof_Worker( void) {
+/*======================================================*/
+/* called in a process forked off to simulate cells (see
+ * _run_workers() in ST_grid.c): the reports and the trace
+ * are the parent's, so this process doesn't time, trace,
+ * count, or report anything.  The files are left open,
+ * the parent still writes to them. */
+
+  _on = FALSE;
+  _tracing = FALSE;
+  _ring = NULL;
+  _mem_fp = NULL;
+  _counter_fd = -1;
+}
+
+void prof_Start( const char *filename) {
+/*======================================================*/
+/* turns the timing on; the report goes to filename, which
+ * is opened now so it ends up in the starting directory */
+
+  _fp = OpenFile(filename, "w");
+  _on = TRUE;
+  _start = _last = _now();
+}
+
+void prof_SetCells( int rows, int cols, int cells) {
+/*======================================================*/
+/* sets up the cost map of a rows x cols grid, of which
+ * cells are simulated (the others are masked out) */
+
+  if (!_on) return;
+
+  _rows = rows;
+  _cols = cols;
+  _cells = cells;
+  _cell_cost = (double *) Mem_Calloc(rows * cols, sizeof(double),
+                                     "prof_SetCells()");
+}
+
+void prof_AddCells( int cells) {
+/*======================================================*/
+/* counts cells more cells as simulated by this process,
+ * when the worker processes of the grid (-j) share the
+ * cells out; the phases are then reported per cell-year
+ * of these cells only */
+
+  if (!_on) return;
+
+  if (_own_cells < 0) _own_cells = 0;
+  _own_cells += cells;
+}
+
+void prof_SetCell( int cell) {
+/*======================================================*/
+/* charges the following time to cell (base0), or to no
+ * cell if cell < 0 */
+
+  if (!_on) return;
+
+  _charge();
+  _cell = cell;
+}
+
+void prof_Begin( ProfPhase p) {
+/*======================================================*/
+
+  if (!_on && !_tracing) return;
+
+  if (_on) {
+    _charge();
+    _calls[p]++;
+  }
+  if (_depth < PROF_MAXDEPTH) _stack[_depth] = p;
+  _depth++;
+  if (_tracing) _trace_event('B', p, -1);
+}
+
+void prof_End( void) {
+/*======================================================*/
+/* ends the phase of the last prof_Begin() */
+
+  if (!_on && !_tracing) return;
+
+  if (_on) _charge();
+  if (_depth > 0) _depth--;
+  if (_tracing && _depth < PROF_MAXDEPTH) _trace_event('E', _stack[_depth], -1);
+}
+
+void prof_Report( void) {
+/*======================================================*/
+/* writes the timing report and finishes the trace, if
+ * they're on */
+  double wall, cellyrs, owncellyrs;
+  int p, r, c, cells = _cells;
+#ifdef __linux__
+  struct rusage ru;
+#endif
+
+  if (_tracing) _trace_finish();
+  if (!isnull(_mem_fp)) {
+    prof_MemReport("exit");
+    CloseFile(&_mem_fp);
+  }
+  if (!_on) return;
+
+  _charge();
+  wall = _last - _start;
+  cellyrs = (double) Globals.runModelIterations * Globals.runModelYears * cells;
+  owncellyrs = (_own_cells < 0) ? cellyrs
+             : (double) Globals.runModelIterations * Globals.runModelYears * _own_cells;
+
+  fprintf(_fp, "# stepwat timing, all times are wall-clock seconds\n");
+  fprintf(_fp, "summary,wall_seconds,%.6f\n", wall);
+  fprintf(_fp, "summary,cells,%d\n", cells);
+  fprintf(_fp, "summary,cell_years,%.0f\n", cellyrs);
+  fprintf(_fp, "summary,cell_years_per_second,%.3f\n",
+          GT(wall, 0.) ? cellyrs / wall : 0.);
+#ifdef __linux__
+  if (!getrusage(RUSAGE_SELF, &ru))
+    fprintf(_fp, "summary,peak_rss_kb,%ld\n", ru.ru_maxrss);
+#endif
+  if (_own_cells >= 0) {
+    /* the worker processes (-j) aren't timed, so the phases,
+     * counters, and cell costs are only this process's */
+    fprintf(_fp, "summary,timed_cells,%d\n", _own_cells);
+    fprintf(_fp, "summary,timed_cell_years,%.0f\n", owncellyrs);
+  }
+
+  fprintf(_fp, "# phase,name,calls,seconds,percent,microseconds_per_cell_year\n");
+  for (p = 0; p < ProfLastPhase; p++)
+    fprintf(_fp, "phase,%s,%lu,%.6f,%.2f,%.3f\n", _phase_names[p],
+            _calls[p], _total[p],
+            GT(wall, 0.) ? 100. * _total[p] / wall : 0.,
+            GT(owncellyrs, 0.) ? 1e6 * _total[p] / owncellyrs : 0.);
+
+  if (_counter_fd >= 0) {
+    fprintf(_fp, "# counters,name,cycles,instructions,cache_misses,"
+                 "branch_misses,ipc,cycles_per_cell_year,"
+                 "cache_misses_per_cell_year,branch_misses_per_cell_year\n");
+    for (p = 0; p < ProfLastPhase; p++)
+      fprintf(_fp, "counters,%s,%llu,%llu,%llu,%llu,%.3f,%.1f,%.3f,%.3f\n",
+              _phase_names[p], _counts[p][0], _counts[p][1], _counts[p][2],
+              _counts[p][3],
+              _counts[p][0] ? (double) _counts[p][1] / _counts[p][0] : 0.,
+              GT(owncellyrs, 0.) ? _counts[p][0] / owncellyrs : 0.,
+              GT(owncellyrs, 0.) ? _counts[p][2] / owncellyrs : 0.,
+              GT(owncellyrs, 0.) ? _counts[p][3] / owncellyrs : 0.);
+#ifdef __linux__
+    close(_counter_fd);
+#endif
+    _counter_fd = -1;
+  }
+
+  if (!isnull(_cell_cost)) {
+    fprintf(_fp, "# cell,cell,row,col,seconds\n");
+    if (_own_cells >= 0)
+      fprintf(_fp, "# only the timed cells have a cost, the others are 0\n");
+    for (r = 0; r < _rows; r++)
+      for (c = 0; c < _cols; c++)
+        fprintf(_fp, "cell,%d,%d,%d,%.6f\n", r * _cols + c, r + 1, c + 1,
+                _cell_cost[r * _cols + c]);
+    Mem_Free(_cell_cost);
+    _cell_cost = NULL;
+  }
+
+  CloseFile(&_fp);
+  _on = FALSE;
+}
+
+void trace_Start( const char *filename) {
+/*======================================================*/
+/* turns the trace on; like prof_Start() the file is
+ * opened now */
+
+  _trace_fp = OpenFile(filename, "w");
+  fprintf(_trace_fp, "{\"traceEvents\":[\n");
+  _tracing = TRUE;
+  _trace_start = _now();
+  trace_Thread("main");
+}
+
+void trace_Thread( const char *name) {
+/*======================================================*/
+/* gives the calling thread its ring and names it in the
+ * trace.  Threads other than main() must call this before
+ * their first event. */
+
+  if (!_tracing) return;
+
+  pthread_mutex_lock(&_trace_lock);
+  _ring = (TraceRing *) Mem_Calloc(1, sizeof(TraceRing), "trace_Thread()");
+  _ring->tid = ++_trace_ntids;
+  _ring->next = _rings;
+  _rings = _ring;
+  fprintf(_trace_fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+          "\"tid\":%d,\"args\":{\"name\":\"%s\"}}\n",
+          _trace_nevents++ ? "," : "", _ring->tid, name);
+  pthread_mutex_unlock(&_trace_lock);
+}
+
+void trace_Begin( TraceSpan s, int arg) {
+/*======================================================*/
+
+  if (_tracing) _trace_event('B', s, arg);
+}
+
+void trace_End( TraceSpan s) {
+/*======================================================*/
+
+  if (_tracing) _trace_event('E', s, -1);
+}
+
+static void _trace_event( char ph, int what, int arg) {
+/*======================================================*/
+  TraceRing *r = _ring;
+
+  if (isnull(r) || _trace_full) return; /* thread without trace_Thread(), or full */
+
+  if (r->n == TRACE_RINGLEN) _trace_flush(r);
+  r->ev[r->n].ts = (_now() - _trace_start) * 1e6;
+  r->ev[r->n].arg = arg;
+  r->ev[r->n].ph = ph;
+  r->ev[r->n].what = what;
+  r->n++;
+}
+
+static void _trace_flush( TraceRing *r) {
+/*======================================================*/
+/* writes and empties a ring */
+  int i;
+
+  pthread_mutex_lock(&_trace_lock);
+  for (i = 0; i < r->n; i++) {
+    if (_trace_nevents >= TRACE_MAXEVENTS) {
+      _trace_full = TRUE; /* the spans still open are left unended */
+      break;
+    }
+    fprintf(_trace_fp, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,"
+            "\"pid\":1,\"tid\":%d", _trace_nevents++ ? "," : "",
+            _phase_names[(int) r->ev[i].what], r->ev[i].ph, r->ev[i].ts,
+            r->tid);
+    if (r->ev[i].arg >= 0)
+      fprintf(_trace_fp, ",\"args\":{\"n\":%d}", r->ev[i].arg);
+    fprintf(_trace_fp, "}\n");
+  }
+  r->n = 0;
+  pthread_mutex_unlock(&_trace_lock);
+}
+
+static void _trace_finish( void) {
+/*======================================================*/
+/* writes what's left in every ring (the other threads
+ * must be done) and closes the trace */
+  TraceRing *r, *next;
+
+  for (r = _rings; r; r = next) {
+    next = r->next;
+    _trace_flush(r);
+    Mem_Free(r);
+  }
+  _rings = _ring = NULL;
+
+  fprintf(_trace_fp, "]}\n");
+  CloseFile(&_trace_fp);
+  _tracing = FALSE;
+  if (_trace_full)
+    LogError(logfp ? logfp : stderr, LOGNOTE, "The trace (-r) stopped after "
+             "%d events, the rest of the run isn't in it", TRACE_MAXEVENTS);
+}
@@ -0,0 +1,55 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_prof.h
+/*  Type: header
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: Phases of the model that ST_prof.c times and
+ *           traces when asked to on the command line.
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*     (10/18/2026) -- added the trace spans
+/*     (10/18/2026) -- added the hardware counters
+/*     (10/18/2026) -- added the allocation report
+/*     (10/18/2026) -- prof_SetCells() takes the simulated cells
+/*     (10/18/2026) -- added prof_Worker()
+/*     (10/18/2026) -- added prof_AddCells()
+/*
+/********************************************************/
+/********************************************************/
+
+#ifndef PROF_DEF_H
+#define PROF_DEF_H
+
+/* the order is the order of the report; ProfOther is the
+ * time that isn't inside any other phase */
+typedef enum {ProfInit, ProfLoadCell, ProfEstablish, ProfEnviron,
+              ProfSXW, ProfSoilwat, ProfPartRes, ProfGrow, ProfMort,
+              ProfStats, ProfSaveCell, ProfDispersal, ProfOutput,
+              ProfOther, ProfLastPhase}
+  ProfPhase;
+
+/* spans that are only traced, not timed; arg is the
+ * iteration, year, or cell number */
+typedef enum {TraceIter = ProfLastPhase, TraceYear, TraceCell,
+              TraceOutputCell, TraceWrite, TraceQueueWait, TraceLastSpan}
+  TraceSpan;
+
+void prof_Start( const char *filename);
+void prof_SetCells( int rows, int cols, int cells);
+void prof_AddCells( int cells);
+void prof_SetCell( int cell);
+void prof_Begin( ProfPhase p);
+void prof_End( void);
+void prof_Report( void);
+void prof_Counters( void);
+void prof_Memory( const char *filename);
+void prof_MemReport( const char *when);
+void prof_Poll( void);
+void prof_Worker( void);
+
+void trace_Start( const char *filename);
+void trace_Thread( const char *name);
+void trace_Begin( TraceSpan s, int arg);
+void trace_End( TraceSpan s);
+
+#endif
@@ -9,6 +9,14 @@
 //     (6/15/2000) -- INITIAL CODING - cwb
 //   1/9/01 - revised to make extensive use of malloc() */
 //	5/28/2013 (DLM) - added module level variable accumulators (grid_Stat) for the grid and functions to deal with them (stat_Load_Accumulators(), stat_Save_Accumulators() stat_Free_Accumulators(), and stat_Init_Accumulators()).  These functions are called from ST_grid.c and manage the output accumulators so that the gridded version can output correctly.  The accumulators are dynamically allocated, so be careful with them.
+//	10/18/2026 - all of the accumulators (for every cell in the grid) are now in one block, and loading a cell just points the statistics at its slice instead of copying.  Compile with -DSTAT_MMAP to back the block with a temporary file.
+//	10/18/2026 - the accumulators keep a running mean and M2 (Welford) instead of sum and sum of squares, and can be merged with stat_Merge_Accumulators().
+//	10/18/2026 - added stat_Output_Cell() so the grid writes each cell's output files from its slice of the accumulators, without loading the cell first.
+//	10/18/2026 - added stat_Output_Grid_Binary(), which writes one binary file for each kind of grid output instead of a text file for every cell (see ST_gridbin.h).
+//	10/18/2026 - with a cell mask the accumulators are only kept for the simulated cells, and the binary files say which cell number each one is.
+//	10/18/2026 - added stat_Advise_Accumulators() for ST_grid.c's read ahead; -DGRID_MMAP turns on STAT_MMAP.
+//	10/18/2026 - stat_Output_Grid_Binary() writes the cells in cell number order when the grid stores them in another order.
+//	10/18/2026 - added stat_Share_Accumulators() for the grid's worker processes; stat_Init_Accumulators() sets up the statistics too.
 //
 /********************************************************/
 /********************************************************/
@@ -24,6 +32,14 @@
 #include "filefuncs.h"
 #include "myMemory.h"
 #include "ST_structs.h"
+#include "ST_gridbin.h"
+#include <sys/mman.h>
+#if defined(GRID_MMAP) && !defined(STAT_MMAP)
+  #define STAT_MMAP /* the grid's cell state is in a file, so the statistics are too */
+#endif
+#ifdef STAT_MMAP
+  #include <unistd.h>
+#endif
 
 /************ External Variable Declarations ***************/
 /***********************************************************/
@@ -45,17 +61,25 @@
   void stat_Output_AllMorts( void) ;
   void stat_Output_AllBmass(void) ;
   void stat_Output_Seed_Dispersal(const char * filename, const char sep, Bool makeHeader); 
+  void stat_Output_Cell( int cell, const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader);
+  void stat_Output_Grid_Binary( const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader, int gridRows, int gridCols, const int *cellNumbers, const int *cellIndex);
   void stat_free_mem( void ) ;
   
   void stat_Load_Accumulators( int cell, int year ); //these accumulators were added to use in the gridded option... there overall purpose is to save/load data to allow steppe to output correctly when running multiple grid cells
   void stat_Save_Accumulators( int cell, int year );
   void stat_Free_Accumulators( void );
   void stat_Init_Accumulators( void );
+  void stat_Merge_Accumulators( int cell, int from_cell );
+  void stat_Advise_Accumulators( int cell, int ncells, int advice );
+  void stat_Share_Accumulators( void );
 
 /************************ Local Structure Defs *************/
 /***********************************************************/
+/* running mean and sum of squared deviations from the mean
+ * (Welford), which stays accurate for large values over many
+ * iterations and can be merged (Chan et al.), see _merge(). */
 struct accumulators_st {
-  double sum, sum_sq;
+  double mean, m2;
   unsigned long nobs;
 };
 
@@ -66,37 +90,66 @@ struct stat_st {
   *_Grp, *_Gsize, *_Gpr, *_Gmort, *_Gestab,
   *_Spp, *_Indv, *_Smort, *_Sestab, *_Sreceived;
 
-typedef struct  {
-  struct accumulators_st *dist, *temp, *ppt, **grp1, **gsize, **gpr2, 
-  							**gmort, **gestab, **spp, **indv, **smort, **sestab, **sreceived;
-} accumulators_grid_st;
-  
-accumulators_grid_st *grid_Stat;
+/* Every accumulator lives in one block with a slice of
+ * _CellSize accumulators per cell (just one cell if not
+ * gridded).  The .s pointers above point into the slice
+ * of the current cell, see _point_at_cell().
+ */
+static struct accumulators_st *_Block,
+                              *_Cur; /* slice the .s pointers are in */
+static size_t _CellSize;
+static int _NCells;
+static Bool _Shared; /* the block is mapped shared, see stat_Share_Accumulators() */
 
 
 /*************** Local Function Declarations ***************/
 /***********************************************************/
 static void _init( void);
+static size_t _point_at_cell( struct accumulators_st *p);
+static void _make_block( int ncells);
 static RealF _get_avg( struct accumulators_st *p);
 static RealF _get_std( struct accumulators_st *p);
+static void _merge( struct accumulators_st *p, const struct accumulators_st *q);
 static void _make_header( char *buf);
+static void _output_allmorts( FILE *f, struct accumulators_st *c);
+static void _output_allbmass( FILE *f, struct accumulators_st *c);
+static void _output_seed_dispersal( FILE *f, struct accumulators_st *c, const char sep, Bool makeHeader);
+static FILE *_open_buffered( const char *name);
+static void _mort_header( char *buf);
+static void _seed_header( char *buf, const char sep);
+static void _bin_col( struct stat_st *st0, struct stat_st *st, int len, char what, char fmt, const char *name, const char *suffix);
+static void _write_bin( const char *prefix, int family, int rows, int label, char sep, const char *header, int gridRows, int gridCols, const int *cellNumbers, const int *cellIndex);
+
+/* the accumulators of statistic st (a struct stat_st) in the
+ * cell slice c; the same as st.s if c is the current slice */
+#define _at(st, c) ((c) + ((st).s - _Cur))
+
+/* stdio buffer size for the grid output files */
+#define STAT_OUTBUF 65536
+
+/* longest heading line of an output file */
+#define STAT_HDRLEN (MAX_OUTFIELDS * 2 * (MAX_FIELDLEN + 2))
+
+/* the columns of a binary grid output file, see _bin_col() */
+static struct bin_col_st {
+  struct stat_st *st0, /* if not NULL, row 0 is st0's first accumulator */
+                 *st;  /* the other rows, from st's first accumulator */
+  int len;             /* accumulators in st; later rows are 0 */
+  char what,           /* 'm' mean, 's' std dev, 'n' nobs, 0 none */
+       fmt,            /* GRIDBIN_FMT_* */
+       name[MAX_FIELDLEN+8];
+} _BinCols[MAX_OUTFIELDS * 2];
+static int _NBinCols;
 
 /* I'm making this a macro because it gets called a lot, but
 /* note that the syntax checker is obviated, so make sure
 /* you follow the this prototype:
 /* static void _collect_add(struct accumulators_st *p, double v) */
 #define _collect_add(p, v) { \
-   (p)->sum += (v);              \
-   (p)->sum_sq += (v)*(v);       \
-   (p)->nobs++;                  \
-}
-
-// quick macro to make life easier in the load/save accumulators functions... it just copies the data of p into v
-// static void _copy_over(struct accumulators_st *p, struct accumulators_st *v) 
-#define _copy_over(p, v) { \
-	(p)->sum = (v)->sum; \
-	(p)->sum_sq = (v)->sum_sq; \
-	(p)->nobs = (v)->nobs; \
+   double _d = (v) - (p)->mean;    \
+   (p)->nobs++;                    \
+   (p)->mean += _d / (p)->nobs;    \
+   (p)->m2 += _d * ((v) - (p)->mean); \
 }
 
 static Bool firsttime = TRUE;
@@ -175,82 +228,135 @@ void stat_Collect( Int year ) {
 }
 
 
+/***********************************************************/
+static size_t _point_at_cell( struct accumulators_st *p) {
+/* Points the accumulators of every statistic in use into
+ * one cell's slice of _Block starting at p, in the order
+ * listed below.  If p is NULL, only counts the number of
+ * accumulators in a slice.  Each statistic's years (or
+ * ages) are contiguous, as stat_Collect() and the output
+ * functions expect.
+ */
+  SppIndex sp;
+  GrpIndex rg;
+  size_t n = 0;
+
+#define _point(st, len) { if (p) (st).s = p + n; n += (len); }
+
+  if (BmassFlags.dist) _point(_Dist, Globals.runModelYears);
+  if (BmassFlags.ppt)  _point(_Ppt,  Globals.runModelYears);
+  if (BmassFlags.tmp)  _point(_Temp, Globals.runModelYears);
+
+  if (BmassFlags.grpb) {
+    ForEachGroup(rg) {
+      _point(_Grp[rg], Globals.runModelYears);
+      if (BmassFlags.size) _point(_Gsize[rg], Globals.runModelYears);
+      if (BmassFlags.pr)   _point(_Gpr[rg],   Globals.runModelYears);
+    }
+  }
+
+  if (MortFlags.group) {
+    ForEachGroup(rg) {
+      _point(_Gestab[rg], 1);
+      _point(_Gmort[rg],  GrpMaxAge(rg));
+    }
+  }
+
+  if (BmassFlags.sppb) {
+    ForEachSpecies(sp) {
+      _point(_Spp[sp], Globals.runModelYears);
+      if (BmassFlags.indv) _point(_Indv[sp], Globals.runModelYears);
+    }
+  }
+
+  if (MortFlags.species) {
+    ForEachSpecies(sp) {
+      _point(_Sestab[sp], 1);
+      _point(_Smort[sp],  SppMaxAge(sp));
+    }
+  }
+
+  if (UseSeedDispersal && UseGrid) {
+    ForEachSpecies(sp)
+      _point(_Sreceived[sp], Globals.runModelYears);
+  }
+
+#undef _point
+
+  if (p) _Cur = p;
+  return n;
+}
+
+/***********************************************************/
+static void _make_block( int ncells) {
+/* allocate the (zeroed) accumulators for ncells cells */
+  _CellSize = _point_at_cell(NULL);
+  _NCells = ncells;
+
+#ifdef STAT_MMAP
+  {
+    /* back the block with an unlinked temporary file so a
+     * big grid's statistics can be paged out to disk */
+    size_t bytes = max(_CellSize * _NCells, 1) * sizeof(struct accumulators_st);
+    FILE *f = tmpfile();
+    if (f == NULL || ftruncate(fileno(f), bytes) != 0)
+      LogError(logfp, LOGFATAL, "Can't create the %lu byte statistics file "
+                      "in _make_block()", (unsigned long) bytes);
+    _Block = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fileno(f), 0);
+    if (_Block == MAP_FAILED)
+      LogError(logfp, LOGFATAL, "Can't map the %lu byte statistics file "
+                      "in _make_block()", (unsigned long) bytes);
+    fclose(f); /* the mapping keeps the file until munmap() */
+  }
+#else
+  if (_Shared) {
+    size_t bytes = max(_CellSize * _NCells, 1) * sizeof(struct accumulators_st);
+    _Block = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (_Block == MAP_FAILED)
+      LogError(logfp, LOGFATAL, "Can't map the %lu byte shared statistics "
+                      "in _make_block()", (unsigned long) bytes);
+  } else
+    _Block = (struct accumulators_st *)
+             Mem_Calloc( max(_CellSize * _NCells, 1),
+                         sizeof(struct accumulators_st),
+                        "_make_block()");
+#endif
+}
+
 /***********************************************************/
 static void _init( void) {
 /* must be called after model is initialized */
   SppIndex sp;
   GrpIndex rg;
 
-  if (BmassFlags.dist)
-    _Dist.s = (struct accumulators_st *)
-               Mem_Calloc( Globals.runModelYears,
-                           sizeof(struct accumulators_st),
-                          "_stat_init(Dist)");
-  if (BmassFlags.ppt)
-    _Ppt.s  = (struct accumulators_st *)
-               Mem_Calloc( Globals.runModelYears,
-                           sizeof(struct accumulators_st),
-                          "_stat_init(PPT)");
-  if (BmassFlags.tmp)
-    _Temp.s = (struct accumulators_st *)
-               Mem_Calloc( Globals.runModelYears,
-                           sizeof(struct accumulators_st),
-                          "_stat_init(Temp)");
   if (BmassFlags.grpb) {
     _Grp = (struct stat_st *)
            Mem_Calloc( Globals.grpCount,
                        sizeof(struct stat_st),
                       "_stat_init(Grp)");
-    ForEachGroup(rg)
-      _Grp[rg].s = (struct accumulators_st *)
-             Mem_Calloc( Globals.runModelYears,
-                         sizeof(struct accumulators_st),
-                        "_stat_init(Grp[rg].s)");
-
-    if (BmassFlags.size) {
+    if (BmassFlags.size)
       _Gsize = (struct stat_st *)
              Mem_Calloc( Globals.grpCount,
                          sizeof(struct stat_st),
                         "_stat_init(GSize)");
-      ForEachGroup(rg)
-          _Gsize[rg].s = (struct accumulators_st *)
-             Mem_Calloc( Globals.runModelYears,
-                         sizeof(struct accumulators_st),
-                        "_stat_init(GSize[rg].s)");
-    }
-    if (BmassFlags.pr) {
+    if (BmassFlags.pr)
       _Gpr = (struct stat_st *)
              Mem_Calloc( Globals.grpCount,
                          sizeof(struct stat_st),
                         "_stat_init(Gpr)");
-      ForEachGroup(rg)
-          _Gpr[rg].s = (struct accumulators_st *)
-             Mem_Calloc( Globals.runModelYears,
-                         sizeof(struct accumulators_st),
-                        "_stat_init(Gpr[rg].s)");
-    }
   }
 
   if (MortFlags.group) {
-
     _Gestab = (struct stat_st *)
              Mem_Calloc( Globals.grpCount,
                          sizeof(struct stat_st),
                          "_stat_init(Gestab)");
-    ForEachGroup(rg)
-      _Gestab[rg].s = (struct accumulators_st *)
-                     Mem_Calloc( 1, sizeof(struct accumulators_st),
-                                "_stat_init(Gestab[rg].s)");
-
     _Gmort = (struct stat_st *)
            Mem_Calloc( Globals.grpCount,
                        sizeof(struct stat_st),
                       "_stat_init(Gmort)");
-    ForEachGroup(rg)
-        _Gmort[rg].s = (struct accumulators_st *)
-           Mem_Calloc( GrpMaxAge(rg),
-                       sizeof(struct accumulators_st),
-                      "_stat_init(Gmort[rg].s)");
   }
 
   if (BmassFlags.sppb) {
@@ -258,51 +364,27 @@ static void _init( void) {
                Mem_Calloc( Globals.sppCount,
                            sizeof(struct stat_st),
                           "_stat_init(Spp)");
-      ForEachSpecies(sp)
-        _Spp[sp].s = (struct accumulators_st *)
-               Mem_Calloc( Globals.runModelYears,
-                           sizeof(struct accumulators_st),
-                          "_stat_init(Spp[sp].s)");
-
-      if (BmassFlags.indv) {
+      if (BmassFlags.indv)
         _Indv = (struct stat_st *)
                Mem_Calloc( Globals.sppCount,
                            sizeof(struct stat_st),
                           "_stat_init(Indv)");
-        ForEachSpecies(sp)
-          _Indv[sp].s = (struct accumulators_st *)
-               Mem_Calloc( Globals.runModelYears,
-                           sizeof(struct accumulators_st),
-                          "_stat_init(Indv[sp].s)");
-    }
   }
   if (MortFlags.species) {
     _Sestab = (struct stat_st *)
            Mem_Calloc( Globals.sppCount,
                        sizeof(struct stat_st),
                       "_stat_init(Sestab)");
-    ForEachSpecies(sp)
-      _Sestab[sp].s = (struct accumulators_st *)
-                    Mem_Calloc( 1, sizeof(struct accumulators_st),
-                                "_stat_init(Sestab[sp].s)");
-
     _Smort = (struct stat_st *)
            Mem_Calloc( Globals.sppCount,
                        sizeof(struct stat_st),
                       "_stat_init(Smort)");
-    ForEachSpecies(sp)
-      _Smort[sp].s = (struct accumulators_st *)
-                    Mem_Calloc( SppMaxAge(sp),
-                                sizeof(struct accumulators_st),
-                                "_stat_init(Smort[sp].s)");
   }
 
   if (UseSeedDispersal && UseGrid) {
 	  _Sreceived = Mem_Calloc( Globals.sppCount, sizeof(struct stat_st), "_stat_init(Sreceived)");
-	  ForEachSpecies(sp) {
-		  _Sreceived[sp].s = (struct accumulators_st *)Mem_Calloc( Globals.runModelYears, sizeof(struct accumulators_st), "_stat_init(Sreceived[sp].s)");
+	  ForEachSpecies(sp)
 		  _Sreceived[sp].name = &Species[sp]->name[0];
-	  }
   }
 
   /* "appoint" names of columns*/
@@ -322,281 +404,103 @@ static void _init( void) {
     ForEachSpecies(sp)
       _Smort[sp].name = &Species[sp]->name[0];
   }
+
+  /* the gridded version has already made a block for
+   * every cell in stat_Init_Accumulators() */
+  if (isnull(_Block)) _make_block(1);
+  _point_at_cell(_Block);
 }
 
 /***********************************************************/
 void stat_Init_Accumulators( void ) {
-	//allocates memory for all of the grid accumulators
-	grid_Stat = Mem_Calloc(Globals.nCells, sizeof(accumulators_grid_st), "stat_Init_Accumulators()");
-	
-  	int i, j;
-  	for( i = 0; i < Globals.nCells; i++) {
-  		if (BmassFlags.dist) grid_Stat[i].dist = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  		if (BmassFlags.ppt) grid_Stat[i].ppt = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  		if (BmassFlags.tmp) grid_Stat[i].temp = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  		
-  		if (BmassFlags.grpb) {
-  			grid_Stat[i].grp1 = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st*), "stat_Init_Accumulators()"); // gave grp and gpr numbers attached to them so I wouldn't mix them up lol... bad (confusing) variable names on part of the original creator.
-  			if (BmassFlags.size) grid_Stat[i].gsize = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  			if (BmassFlags.pr) grid_Stat[i].gpr2 = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-  		}
-  		if (MortFlags.group) {
-  			grid_Stat[i].gmort = Mem_Calloc(Globals.grpCount, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-  			grid_Stat[i].gestab = Mem_Calloc(Globals.grpCount, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-  			GrpIndex gp;
-  			ForEachGroup(gp) {
-  				grid_Stat[i].gmort[gp] = Mem_Calloc(GrpMaxAge(gp), sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  				grid_Stat[i].gestab[gp] = Mem_Calloc(1, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  			}
-  		}
-  		if(BmassFlags.sppb) {
-  			grid_Stat[i].spp = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-  			if(BmassFlags.indv) grid_Stat[i].indv = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-  		}
-  		if (MortFlags.species) {
-  			grid_Stat[i].smort = Mem_Calloc(Globals.sppCount, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-  			grid_Stat[i].sestab = Mem_Calloc(Globals.sppCount, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-			SppIndex sp;
-			ForEachSpecies(sp) {
-				grid_Stat[i].smort[sp] = Mem_Calloc(SppMaxAge(sp), sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-				grid_Stat[i].sestab[sp] = Mem_Calloc(1, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-			}
-		}
-
-		if(UseSeedDispersal && UseGrid) 
-			grid_Stat[i].sreceived = Mem_Calloc(Globals.runModelYears, sizeof(struct accumulators_st*), "stat_Init_Accumulators()");
-		  		
-  		
-  		for( j = 0; j < Globals.runModelYears; j++) {
-  			if (BmassFlags.grpb) {
-  				grid_Stat[i].grp1[j] = Mem_Calloc(Globals.grpCount, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  				if (BmassFlags.size) grid_Stat[i].gsize[j] = Mem_Calloc(Globals.grpCount, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  				if (BmassFlags.pr) grid_Stat[i].gpr2[j] = Mem_Calloc(Globals.grpCount, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  			}
-  			if(BmassFlags.sppb) {
-  				grid_Stat[i].spp[j] = Mem_Calloc(Globals.sppCount, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  				if(BmassFlags.indv) grid_Stat[i].indv[j] = Mem_Calloc(Globals.sppCount, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  			}
-			if(UseSeedDispersal && UseGrid)
-				grid_Stat[i].sreceived[j] = Mem_Calloc(Globals.sppCount, sizeof(struct accumulators_st), "stat_Init_Accumulators()");
-  		}
-  	}
+	//allocates the accumulators for every cell of the grid in one block (see _point_at_cell() for the layout of a cell's slice), and sets up the statistics so they can be written even if this process never loads a cell
+	_make_block(Globals.nCells);
+	if (firsttime) {
+		firsttime = FALSE;
+		_init();
+	}
 }
 
 /***********************************************************/
 void stat_Load_Accumulators(int cell, int year) {
-	//loads the accumulators for the cell at the given year
+	//makes the cell's accumulators the current ones, so stat_Collect() and the output functions use them directly (for every year, so year isn't needed anymore)
 
 	if (firsttime) {
 		firsttime = FALSE;
 		_init();
 	}
-	IntS age;
-	int yr;
-	yr = year - 1;
-	
-	if(MortFlags.species) {
-		SppIndex sp;
-
-		ForEachSpecies(sp) {
-			if ( !Species[sp]->use_me) continue;
-			_copy_over(&_Sestab[sp].s[0], &grid_Stat[cell].sestab[sp][0]);
-			IntS age;
-			for (age=0; age < SppMaxAge(sp); age++)
-				_copy_over(&_Smort[sp].s[age], &grid_Stat[cell].smort[sp][age]);
-		}
-  	}
-  	if(MortFlags.group) {
-  		GrpIndex rg;
-
-    	ForEachGroup(rg) {
-      		if (!RGroup[rg]->use_me) continue;
-      		_copy_over(&_Gestab[rg].s[0], &grid_Stat[cell].gestab[rg][0]);
-      		for (age=0; age < GrpMaxAge(rg); age++)
-        		_copy_over(&_Gmort[rg].s[age], &grid_Stat[cell].gmort[rg][age]);
-    	}
-  	}
-
-	if (BmassFlags.tmp) _copy_over(&_Temp.s[yr], &grid_Stat[cell].temp[yr]);
-	if (BmassFlags.ppt) _copy_over(&_Ppt.s[yr], &grid_Stat[cell].ppt[yr]);
-	if (BmassFlags.dist) _copy_over(&_Dist.s[yr], &grid_Stat[cell].dist[yr]);	
-	
-	if(BmassFlags.grpb) {
-		GrpIndex c;
-		ForEachGroup(c) {
-			_copy_over(&_Grp[c].s[yr], &grid_Stat[cell].grp1[yr][c]);
-			if (BmassFlags.size) _copy_over(&_Gsize[c].s[yr], &grid_Stat[cell].gsize[yr][c]);
-			if (BmassFlags.pr)	_copy_over(&_Gpr[c].s[yr], &grid_Stat[cell].gpr2[yr][c]);
-		}
-	}
-  
-  	if(BmassFlags.sppb) {
-  		SppIndex s;
-  		ForEachSpecies(s) {
-  			_copy_over(&_Spp[s].s[yr], &grid_Stat[cell].spp[yr][s]);
-  			if (BmassFlags.indv) _copy_over(&_Indv[s].s[yr], &grid_Stat[cell].indv[yr][s]);
-  		}
-  	}
-
-	if(UseGrid && UseSeedDispersal) {
-		SppIndex s;
-		ForEachSpecies(s)
-			_copy_over(&_Sreceived[s].s[yr], &grid_Stat[cell].sreceived[yr][s]);
-	}
+	_point_at_cell(_Block + cell * _CellSize);
 }
 
 /***********************************************************/
 void stat_Save_Accumulators(int cell, int year) {
-	//saves the accumulators for the cell at the given year
+	//nothing to copy back since stat_Collect() writes straight into the cell's accumulators, kept so the grid code can still bracket a cell visit with load/save
 	
 	if (firsttime) {
 		firsttime = FALSE;
 		_init();
 	}
-	IntS age;
-  	int yr;
-  	yr = year - 1;
-  	
-	if(MortFlags.species) {
-		SppIndex sp;
-		
-		ForEachSpecies(sp) {
-			if ( !Species[sp]->use_me) continue;
-			_copy_over(&grid_Stat[cell].sestab[sp][0], &_Sestab[sp].s[0]);
-			for (age=0; age < SppMaxAge(sp); age++)
-				_copy_over(&grid_Stat[cell].smort[sp][age], &_Smort[sp].s[age]);
-		}
-  	}
-	if(MortFlags.group) {
-		GrpIndex rg;
-
-		ForEachGroup(rg) {
-			if (!RGroup[rg]->use_me) continue;
-			_copy_over(&grid_Stat[cell].gestab[rg][0], &_Gestab[rg].s[0]);
-			for (age=0; age < GrpMaxAge(rg); age++)
-				_copy_over(&grid_Stat[cell].gmort[rg][age], &_Gmort[rg].s[age]);
-		}
-	}
-	
-	if (BmassFlags.tmp) _copy_over(&grid_Stat[cell].temp[yr], &_Temp.s[yr]);
-	if (BmassFlags.ppt) _copy_over(&grid_Stat[cell].ppt[yr], &_Ppt.s[yr]);
-	if (BmassFlags.dist) _copy_over(&grid_Stat[cell].dist[yr], &_Dist.s[yr]);
-
-	if(BmassFlags.grpb) {
-		GrpIndex c;
-		ForEachGroup(c) {
-			_copy_over(&grid_Stat[cell].grp1[yr][c], &_Grp[c].s[yr]);
-			if (BmassFlags.size) _copy_over(&grid_Stat[cell].gsize[yr][c], &_Gsize[c].s[yr]);
-			if (BmassFlags.pr)	_copy_over(&grid_Stat[cell].gpr2[yr][c], &_Gpr[c].s[yr]);
-		}
-	}
-  
-  	if(BmassFlags.sppb) {
-  		SppIndex s;
-  		ForEachSpecies(s) {
-  			_copy_over(&grid_Stat[cell].spp[yr][s], &_Spp[s].s[yr]);
-  			if (BmassFlags.indv) _copy_over(&grid_Stat[cell].indv[yr][s], &_Indv[s].s[yr]);
-  		}
-  	}
+}
 
-	if(UseGrid && UseSeedDispersal) {
-		SppIndex s;
-		ForEachSpecies(s)
-			_copy_over(&grid_Stat[cell].sreceived[yr][s], &_Sreceived[s].s[yr]);
-	}
+/***********************************************************/
+void stat_Merge_Accumulators( int cell, int from_cell ) {
+	//merges the observations collected for from_cell into cell's accumulators, to reduce partial results (eg of separate workers or runs that used the same layout) into one
+	struct accumulators_st *p = _Block + cell * _CellSize,
+	                       *q = _Block + from_cell * _CellSize;
+	size_t i;
+
+	for (i = 0; i < _CellSize; i++)
+		_merge(&p[i], &q[i]);
+}
 
+/***********************************************************/
+void stat_Share_Accumulators( void ) {
+	//makes stat_Init_Accumulators() map the block shared, so what the grid's worker processes collect (see _run_workers() in ST_grid.c) ends up in this process's block too... it already is with STAT_MMAP
+	_Shared = TRUE;
+}
+
+/***********************************************************/
+void stat_Advise_Accumulators( int cell, int ncells, int advice ) {
+	//passes madvise() advice on to the accumulators of ncells cells starting at cell... does nothing unless the block is mapped
+#ifdef STAT_MMAP
+	size_t page = (size_t) sysconf(_SC_PAGESIZE);
+	char *first = (char *) (_Block + cell * _CellSize),
+	     *last = (char *) (_Block + (cell + ncells) * _CellSize);
+
+	if (isnull(_Block) || ncells <= 0) return;
+	first = (char *) ((size_t) first / page * page);
+	madvise(first, last - first, advice);
+#endif
 }
 
 /***********************************************************/
 void stat_Free_Accumulators( void ) {
-	//frees all the memory allocated in stat_init_Accumulators()
-
-  	int i, j;
-  	for( i = 0; i < Globals.nCells; i++) {
-  		for( j = 0; j < Globals.runModelYears; j++) {
-  			if(BmassFlags.grpb) {
-  				Mem_Free(grid_Stat[i].grp1[j]);
-  				if (BmassFlags.size) Mem_Free(grid_Stat[i].gsize[j]);
-  				if (BmassFlags.pr) Mem_Free(grid_Stat[i].gpr2[j]);
-  			}
-  			if(BmassFlags.sppb) {
-  				Mem_Free(grid_Stat[i].spp[j]);
-  				if(BmassFlags.indv) Mem_Free(grid_Stat[i].indv[j]);
-  			}
-			if(UseSeedDispersal && UseGrid)
-				Mem_Free(grid_Stat[i].sreceived[j]);
-  		}
-  		
-  		if (BmassFlags.dist) Mem_Free(grid_Stat[i].dist);
-  		if (BmassFlags.ppt) Mem_Free(grid_Stat[i].ppt); 
-  		if (BmassFlags.tmp) Mem_Free(grid_Stat[i].temp);
-  		
-  		if(BmassFlags.grpb) {
-  			Mem_Free(grid_Stat[i].grp1);// gave grp and gpr numbers attached to them so I wouldn't mix them up lol... bad (confusing) variable names on part of the original creator.
-  			if (BmassFlags.size) Mem_Free(grid_Stat[i].gsize);
-  			if (BmassFlags.size) Mem_Free(grid_Stat[i].gpr2);
-  		}
-  		if (MortFlags.group) {
-  			GrpIndex gp;
-  			ForEachGroup(gp) {
-  				Mem_Free(grid_Stat[i].gmort[gp]);
-  				Mem_Free(grid_Stat[i].gestab[gp]);
-  			}
-  			Mem_Free(grid_Stat[i].gmort);
-  			Mem_Free(grid_Stat[i].gestab);
-  		}
-  		if(BmassFlags.sppb) {
-  			Mem_Free(grid_Stat[i].spp);
-  			if(BmassFlags.indv) Mem_Free(grid_Stat[i].indv);
-  		}
-  		if (MortFlags.species) {
-  			SppIndex sp;
-  			ForEachSpecies(sp) {
-  				Mem_Free(grid_Stat[i].smort[sp]);
-  				Mem_Free(grid_Stat[i].sestab[sp]);
-  			}
-  			Mem_Free(grid_Stat[i].smort);
-  			Mem_Free(grid_Stat[i].sestab);
-  		}
-		if(UseSeedDispersal && UseGrid)
-			Mem_Free(grid_Stat[i].sreceived);
-  	}
-  	Mem_Free(grid_Stat);
+	//frees all the memory allocated in stat_Init_Accumulators()
   	stat_free_mem();
 }
 
 /***********************************************************/
 void stat_free_mem( void ) {
 	//frees memory allocated in this module
-	GrpIndex gp;
-	SppIndex sp;
 	
-  	if(BmassFlags.grpb)
-  		ForEachGroup(gp) {
-  			Mem_Free(_Grp[gp].s);
-  			if (BmassFlags.size) Mem_Free(_Gsize[gp].s);
-  			if (BmassFlags.pr) Mem_Free(_Gpr[gp].s);
-  		}
-  	if(BmassFlags.sppb)
-  		ForEachSpecies(sp) {
-  			Mem_Free(_Spp[sp].s);
-  			if(BmassFlags.indv) Mem_Free(_Indv[sp].s);
-  		}
-  		
-  	if (BmassFlags.dist) Mem_Free(_Dist.s);
-  	if (BmassFlags.ppt) Mem_Free(_Ppt.s); 
-  	if (BmassFlags.tmp) Mem_Free(_Temp.s);
-  		
+	if (!isnull(_Block)) {
+#ifdef STAT_MMAP
+		munmap(_Block, max(_CellSize * _NCells, 1) * sizeof(struct accumulators_st));
+#else
+		if (_Shared)
+			munmap(_Block, max(_CellSize * _NCells, 1) * sizeof(struct accumulators_st));
+		else
+			Mem_Free(_Block);
+#endif
+		_Block = NULL;
+	}
+	
   	if(BmassFlags.grpb) {
   		Mem_Free(_Grp);
   		if (BmassFlags.size) Mem_Free(_Gsize);
-  		if (BmassFlags.size) Mem_Free(_Gpr);
+  		if (BmassFlags.pr) Mem_Free(_Gpr);
   	}
   	if (MortFlags.group) {
-  		ForEachGroup(gp) {
-  			Mem_Free(_Gmort[gp].s);
-  			Mem_Free(_Gestab[gp].s);
-  		}
   		Mem_Free(_Gmort);
   		Mem_Free(_Gestab);
   	}
@@ -605,22 +509,11 @@ void stat_free_mem( void ) {
   		if(BmassFlags.indv) Mem_Free(_Indv);
   	}
   	if (MortFlags.species) {
-  		ForEachSpecies(sp) {
-  			Mem_Free(_Smort[sp].s);
-  			Mem_Free(_Sestab[sp].s);
-  		}
   		Mem_Free(_Smort);
   		Mem_Free(_Sestab);
   	}
-
-
-	if (UseSeedDispersal && UseGrid) {
-		ForEachSpecies(sp)
-			Mem_Free(_Sreceived[sp].s);
+	if (UseSeedDispersal && UseGrid)
 		Mem_Free(_Sreceived);
-	}
-
-	
 }
 
 /***********************************************************/
@@ -728,35 +621,35 @@ void stat_Output_YrMorts( void ) {
 /***********************************************************/
 void stat_Output_AllMorts( void) {
   FILE *f;
-  IntS age;
-  GrpIndex rg;
-  SppIndex sp;
-  char sep = MortFlags.sep;
 
   if (!MortFlags.summary) return;
 
   f = OpenFile( Parm_name(F_MortAvg), "w");
+  _output_allmorts(f, _Cur);
+  CloseFile(&f);
+}
 
-  fprintf(f,"Age");
-  if (MortFlags.group) {
-    ForEachGroup(rg) fprintf(f,"%c%s", sep, RGroup[rg]->name);
-  }
-  if (MortFlags.species) {
-    ForEachSpecies(sp)
-      fprintf(f,"%c%s", sep, Species[sp]->name);
-  }
-  fprintf(f,"\n");
+/***********************************************************/
+static void _output_allmorts( FILE *f, struct accumulators_st *c) {
+/* writes the mortality averages of the cell slice c */
+  IntS age;
+  GrpIndex rg;
+  SppIndex sp;
+  char sep = MortFlags.sep, buf[STAT_HDRLEN];
+
+  _mort_header(buf);
+  fprintf(f,"%s", buf);
   /* end of first line */
 
   /* print one line of establishments */
   fprintf(f,"Estabs");
   if (MortFlags.group) {
     ForEachGroup(rg)
-      fprintf(f,"%c%5.1f", sep, _get_avg(_Gestab[rg].s));
+      fprintf(f,"%c%5.1f", sep, _get_avg( _at(_Gestab[rg], c)));
   }
   if (MortFlags.species) {
     ForEachSpecies(sp)
-      fprintf(f,"%c%5.1f", sep, _get_avg( _Sestab[sp].s));
+      fprintf(f,"%c%5.1f", sep, _get_avg( _at(_Sestab[sp], c)));
   }
   fprintf(f,"\n");
 
@@ -766,35 +659,40 @@ void stat_Output_AllMorts( void) {
   if (MortFlags.group) {
       ForEachGroup(rg) 
         fprintf(f,"%c%5.1f", sep, ( age < GrpMaxAge(rg) )
-                                  ? _get_avg(&_Gmort[rg].s[age])
+                                  ? _get_avg( &_at(_Gmort[rg], c)[age])
                                   : 0.);
     }
     if (MortFlags.species) {
       ForEachSpecies(sp) {
       fprintf(f,"%c%5.1f", sep, ( age < SppMaxAge(sp))
-                                ? _get_avg(&_Smort[sp].s[age])
+                                ? _get_avg( &_at(_Smort[sp], c)[age])
                                 : 0.);
     }
     }
   fprintf(f,"\n");
   }
 
-  CloseFile(&f);
 }
 
 
 /***********************************************************/
 void stat_Output_AllBmass(void) {
-
-  char buf[1024], tbuf[80], sep = BmassFlags.sep;
-  IntS yr;
-  GrpIndex rg;
-  SppIndex sp;
   FILE *f;
 
   if (!BmassFlags.summary) return;
 
   f = OpenFile( Parm_name( F_BMassAvg), "w");
+  _output_allbmass(f, _Cur);
+  CloseFile(&f);
+}
+
+/***********************************************************/
+static void _output_allbmass( FILE *f, struct accumulators_st *c) {
+/* writes the biomass averages of the cell slice c */
+  char buf[1024], tbuf[80], sep = BmassFlags.sep;
+  IntS yr;
+  GrpIndex rg;
+  SppIndex sp;
 
   buf[0]='\0';
 
@@ -809,15 +707,15 @@ void stat_Output_AllBmass(void) {
       sprintf(buf, "%d%c", yr, sep);
 
     if (BmassFlags.dist) {
-      sprintf(tbuf, "%ld%c", _Dist.s[yr-1].nobs,
+      sprintf(tbuf, "%lu%c", _at(_Dist, c)[yr-1].nobs,
               sep);
       strcat(buf, tbuf);
     }
 
     if (BmassFlags.ppt) {
       sprintf(tbuf, "%f%c%f%c",
-              _get_avg(&_Ppt.s[yr-1]), sep,
-              _get_std(&_Ppt.s[yr-1]), sep);
+              _get_avg(&_at(_Ppt, c)[yr-1]), sep,
+              _get_std(&_at(_Ppt, c)[yr-1]), sep);
       strcat( buf, tbuf);
     }
 
@@ -828,27 +726,27 @@ void stat_Output_AllBmass(void) {
 
     if (BmassFlags.tmp) {
       sprintf(tbuf, "%f%c%f%c",
-              _get_avg(&_Temp.s[yr-1]), sep,
-              _get_std(&_Temp.s[yr-1]), sep);
+              _get_avg(&_at(_Temp, c)[yr-1]), sep,
+              _get_std(&_at(_Temp, c)[yr-1]), sep);
       strcat( buf, tbuf);
     }
 
     if (BmassFlags.grpb) {
       ForEachGroup(rg) {
         sprintf(tbuf, "%f%c",
-                _get_avg( &_Grp[rg].s[yr-1]), sep);
+                _get_avg( &_at(_Grp[rg], c)[yr-1]), sep);
         strcat( buf, tbuf);
 
         if (BmassFlags.size) {
           sprintf(tbuf, "%f%c",
-                  _get_avg( &_Gsize[rg].s[yr-1]), sep);
+                  _get_avg( &_at(_Gsize[rg], c)[yr-1]), sep);
           strcat( buf, tbuf);
         }
 
         if (BmassFlags.pr) {
           sprintf(tbuf, "%f%c%f%c",
-                  _get_avg( &_Gpr[rg].s[yr-1]), sep,
-                  _get_std( &_Gpr[rg].s[yr-1]), sep);
+                  _get_avg( &_at(_Gpr[rg], c)[yr-1]), sep,
+                  _get_std( &_at(_Gpr[rg], c)[yr-1]), sep);
           strcat( buf, tbuf);
         }
       }
@@ -857,12 +755,12 @@ void stat_Output_AllBmass(void) {
     if (BmassFlags.sppb) {
       ForEachSpecies(sp) {
         sprintf(tbuf, "%f%c",
-                _get_avg( &_Spp[sp].s[yr-1]), sep);
+                _get_avg( &_at(_Spp[sp], c)[yr-1]), sep);
         strcat( buf, tbuf);
 
         if (BmassFlags.indv) {
           sprintf(tbuf, "%f%c",
-                  _get_avg( &_Indv[sp].s[yr-1]), sep);
+                  _get_avg( &_at(_Indv[sp], c)[yr-1]), sep);
           strcat( buf, tbuf);
         }
 
@@ -871,27 +769,28 @@ void stat_Output_AllBmass(void) {
 
     fprintf( f, "%s\n", buf);
   }  /* end of foreach year */
-  CloseFile(&f);
 
 }
 
 /***********************************************************/
 void stat_Output_Seed_Dispersal(const char * filename, const char sep, Bool makeHeader) {
-	//do stuff...
-	char buf[1024], tbuf[80];
-	IntS yr;
-	SppIndex sp;
 	FILE *f;
 
 	f = OpenFile(filename, "w");
+	_output_seed_dispersal(f, _Cur, sep, makeHeader);
+	CloseFile(&f);
+}
+
+/***********************************************************/
+static void _output_seed_dispersal( FILE *f, struct accumulators_st *c, const char sep, Bool makeHeader) {
+	//writes the received seed probabilities of the cell slice c
+	char buf[STAT_HDRLEN], tbuf[80];
+	IntS yr;
+	SppIndex sp;
 
 	if(makeHeader) {
-		fprintf(f,"Year");
-		ForEachSpecies(sp) {
-			fprintf(f, "%c%s_prob", sep, Species[sp]->name);
-			fprintf(f, "%c%s_std", sep, Species[sp]->name);
-		}
-		fprintf(f,"\n");
+		_seed_header(buf, sep);
+		fprintf(f,"%s", buf);
 	}
 
 	for( yr=1; yr<= Globals.runModelYears; yr++) {
@@ -900,36 +799,280 @@ void stat_Output_Seed_Dispersal(const char * filename, const char sep, Bool make
 		sprintf(buf, "%d%c", yr, sep);
 		
 		ForEachSpecies(sp) {
-			sprintf(tbuf, "%f%c%f%c", _get_avg( &_Sreceived[sp].s[yr-1]), sep, _get_std( &_Sreceived[sp].s[yr-1]), sep);
+			sprintf(tbuf, "%f%c%f%c", _get_avg( &_at(_Sreceived[sp], c)[yr-1]), sep, _get_std( &_at(_Sreceived[sp], c)[yr-1]), sep);
 			strcat(buf, tbuf);
 		}
 
 		fprintf(f, "%s\n", buf);
 	}	
+}
+
+/***********************************************************/
+void stat_Output_Cell( int cell, const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader) {
+	//writes the mort, bmass, and (if fileReceivedProb isn't NULL) seed dispersal files of a grid cell straight from its accumulators, without loading the cell.
+	//this only reads the accumulators, so it can be called for different cells from several threads at once, as long as nothing is being collected meanwhile.
+	struct accumulators_st *c = _Block + cell * _CellSize;
+	FILE *f;
+
+	if (MortFlags.summary) {
+		f = _open_buffered(fileMort);
+		_output_allmorts(f, c);
+		CloseFile(&f);
+	}
+	if (BmassFlags.summary) {
+		f = _open_buffered(fileBMass);
+		_output_allbmass(f, c);
+		CloseFile(&f);
+	}
+	if (!isnull(fileReceivedProb)) {
+		f = _open_buffered(fileReceivedProb);
+		_output_seed_dispersal(f, c, sep, makeHeader);
+		CloseFile(&f);
+	}
+}
+
+/***********************************************************/
+void stat_Output_Grid_Binary( const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader, int gridRows, int gridCols, const int *cellNumbers, const int *cellIndex) {
+	//writes the output of every cell into one binary file (the name with ".bin" added) for each of mort, bmass, and (if fileReceivedProb isn't NULL) seed dispersal, instead of a text file for every cell.  See ST_gridbin.h for the layout; griddump turns them back into the text files.
+	//cellNumbers is the cell number of each cell in the files when some of the grid is masked out, or NULL if they're all there.
+	//cellIndex is the index into the accumulators of each cell in the files, when the grid doesn't keep them in cell number order (see _order_cells() in ST_grid.c), or NULL if it does.
+	char buf[STAT_HDRLEN];
+	GrpIndex rg;
+	SppIndex sp;
+
+	if (MortFlags.summary) {
+		_NBinCols = 0;
+		if (MortFlags.group) {
+			ForEachGroup(rg)
+				_bin_col(&_Gestab[rg], &_Gmort[rg], GrpMaxAge(rg), 'm', GRIDBIN_FMT_MORT, RGroup[rg]->name, "");
+		}
+		if (MortFlags.species) {
+			ForEachSpecies(sp)
+				_bin_col(&_Sestab[sp], &_Smort[sp], SppMaxAge(sp), 'm', GRIDBIN_FMT_MORT, Species[sp]->name, "");
+		}
+		_mort_header(buf);
+		_write_bin(fileMort, GRIDBIN_MORT, Globals.Max_Age + 1, GRIDBIN_LBL_AGE, MortFlags.sep, buf, gridRows, gridCols, cellNumbers, cellIndex);
+	}
+
+	if (BmassFlags.summary) {
+		_NBinCols = 0;
+		if (BmassFlags.dist)
+			_bin_col(NULL, &_Dist, Globals.runModelYears, 'n', GRIDBIN_FMT_COUNT, "Disturbs", "");
+		if (BmassFlags.ppt) {
+			_bin_col(NULL, &_Ppt, Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, "PPT", "");
+			_bin_col(NULL, &_Ppt, Globals.runModelYears, 's', GRIDBIN_FMT_REAL, "PPT", "_sd");
+		}
+		if (BmassFlags.pclass)
+			_bin_col(NULL, NULL, 0, 0, GRIDBIN_FMT_NA, "PPTClass", "");
+		if (BmassFlags.tmp) {
+			_bin_col(NULL, &_Temp, Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, "Temp", "");
+			_bin_col(NULL, &_Temp, Globals.runModelYears, 's', GRIDBIN_FMT_REAL, "Temp", "_sd");
+		}
+		if (BmassFlags.grpb) {
+			ForEachGroup(rg) {
+				_bin_col(NULL, &_Grp[rg], Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, RGroup[rg]->name, "");
+				if (BmassFlags.size)
+					_bin_col(NULL, &_Gsize[rg], Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, RGroup[rg]->name, "_RSize");
+				if (BmassFlags.pr) {
+					_bin_col(NULL, &_Gpr[rg], Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, RGroup[rg]->name, "_PR");
+					_bin_col(NULL, &_Gpr[rg], Globals.runModelYears, 's', GRIDBIN_FMT_REAL, RGroup[rg]->name, "_PR_sd");
+				}
+			}
+		}
+		if (BmassFlags.sppb) {
+			ForEachSpecies(sp) {
+				_bin_col(NULL, &_Spp[sp], Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, Species[sp]->name, "");
+				if (BmassFlags.indv)
+					_bin_col(NULL, &_Indv[sp], Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, Species[sp]->name, "_Indv");
+			}
+		}
+		buf[0] = '\0';
+		if (BmassFlags.header) {
+			_make_header(buf);
+			strcat(buf, "\n");
+		}
+		_write_bin(fileBMass, GRIDBIN_BMASS, Globals.runModelYears, BmassFlags.yr ? GRIDBIN_LBL_YEAR : GRIDBIN_LBL_NONE, BmassFlags.sep, buf, gridRows, gridCols, cellNumbers, cellIndex);
+	}
+
+	if (!isnull(fileReceivedProb)) {
+		_NBinCols = 0;
+		ForEachSpecies(sp) {
+			_bin_col(NULL, &_Sreceived[sp], Globals.runModelYears, 'm', GRIDBIN_FMT_REAL, Species[sp]->name, "_prob");
+			_bin_col(NULL, &_Sreceived[sp], Globals.runModelYears, 's', GRIDBIN_FMT_REAL, Species[sp]->name, "_std");
+		}
+		buf[0] = '\0';
+		if (makeHeader) _seed_header(buf, sep);
+		_write_bin(fileReceivedProb, GRIDBIN_SEED, Globals.runModelYears, GRIDBIN_LBL_YEAR, sep, buf, gridRows, gridCols, cellNumbers, cellIndex);
+	}
+}
+
+/***********************************************************/
+static void _bin_col( struct stat_st *st0, struct stat_st *st, int len, char what, char fmt, const char *name, const char *suffix) {
+	//adds a column to _BinCols
+	struct bin_col_st *col = &_BinCols[_NBinCols++];
+
+	col->st0 = st0;
+	col->st = st;
+	col->len = len;
+	col->what = what;
+	col->fmt = fmt;
+	sprintf(col->name, "%s%s", name, suffix);
+}
+
+/***********************************************************/
+static void _write_bin( const char *prefix, int family, int rows, int label, char sep, const char *header, int gridRows, int gridCols, const int *cellNumbers, const int *cellIndex) {
+	//writes the columns in _BinCols for every cell to prefix.bin
+	GridBin_Header h;
+	struct bin_col_st *col;
+	struct stat_st *st;
+	struct accumulators_st *c, *p;
+	char name[1024];
+	float *vals;
+	long long *offsets;
+	int i, k, r, cell, names_len = 0;
+	FILE *f;
+
+	memset(&h, 0, sizeof(h));
+	strcpy(h.magic, GRIDBIN_MAGIC);
+	h.order = GRIDBIN_ORDER;
+	h.version = GRIDBIN_VERSION;
+	h.family = family;
+	h.cells = _NCells;
+	h.rows = rows;
+	h.cols = _NBinCols;
+	h.grid_rows = gridRows;
+	h.grid_cols = gridCols;
+	h.label = label;
+	h.sep = sep;
+	h.header_len = strlen(header);
+
+	sprintf(name, "%s.bin", prefix);
+	f = _open_buffered(name);
+	fwrite(&h, sizeof(h), 1, f);
+	fwrite(header, 1, h.header_len, f);
+	for (k = 0; k < _NBinCols; k++)
+		fputc(_BinCols[k].fmt, f);
+	for (k = 0; k < _NBinCols; k++)
+		names_len += strlen(_BinCols[k].name) + 1;
+	fwrite(&names_len, sizeof(int), 1, f);
+	for (k = 0; k < _NBinCols; k++)
+		fwrite(_BinCols[k].name, 1, strlen(_BinCols[k].name) + 1, f);
+
+	offsets = (long long *) Mem_Calloc(max(_NBinCols, 1), sizeof(long long), "_write_bin()");
+	vals = (float *) Mem_Calloc(max(rows, 1), sizeof(float), "_write_bin()");
+	offsets[0] = ftell(f) + _NBinCols * sizeof(long long);
+	if (!isnull(cellNumbers))
+		offsets[0] += _NCells * sizeof(int);
+	for (k = 1; k < _NBinCols; k++)
+		offsets[k] = offsets[k-1] + (long long) _NCells * rows * sizeof(float);
+	fwrite(offsets, sizeof(long long), _NBinCols, f);
+	if (!isnull(cellNumbers))
+		fwrite(cellNumbers, sizeof(int), _NCells, f);
+
+	for (k = 0; k < _NBinCols; k++) {
+		col = &_BinCols[k];
+		for (cell = 0; cell < _NCells; cell++) {
+			c = _Block + (isnull(cellIndex) ? cell : cellIndex[cell]) * _CellSize;
+			for (r = 0; r < rows; r++) {
+				st = col->st;
+				i = r;
+				if (col->st0) {
+					if (r == 0) st = col->st0;
+					else i = r - 1;
+				}
+				vals[r] = 0.;
+				if (isnull(st) || (st == col->st && i >= col->len)) continue;
+				p = &_at(*st, c)[i];
+				switch (col->what) {
+					case 'm': vals[r] = _get_avg(p); break;
+					case 's': vals[r] = _get_std(p); break;
+					case 'n': vals[r] = (float) p->nobs; break;
+				}
+			}
+			fwrite(vals, sizeof(float), rows, f);
+		}
+	}
+
+	Mem_Free(vals);
+	Mem_Free(offsets);
 	CloseFile(&f);
 }
 
+/***********************************************************/
+static void _mort_header( char *buf) {
+	//the first line of the mort output
+	GrpIndex rg;
+	SppIndex sp;
+	char sep = MortFlags.sep;
+
+	buf += sprintf(buf, "Age");
+	if (MortFlags.group) {
+		ForEachGroup(rg) buf += sprintf(buf, "%c%s", sep, RGroup[rg]->name);
+	}
+	if (MortFlags.species) {
+		ForEachSpecies(sp) buf += sprintf(buf, "%c%s", sep, Species[sp]->name);
+	}
+	sprintf(buf, "\n");
+}
+
+/***********************************************************/
+static void _seed_header( char *buf, const char sep) {
+	//the first line of the seed dispersal output
+	SppIndex sp;
+
+	buf += sprintf(buf, "Year");
+	ForEachSpecies(sp) {
+		buf += sprintf(buf, "%c%s_prob", sep, Species[sp]->name);
+		buf += sprintf(buf, "%c%s_std", sep, Species[sp]->name);
+	}
+	sprintf(buf, "\n");
+}
+
+/***********************************************************/
+static FILE *_open_buffered( const char *name) {
+	//opens an output file with a buffer big enough that a cell's file is usually written in one go
+	FILE *f = OpenFile(name, "w");
+
+	setvbuf(f, NULL, _IOFBF, STAT_OUTBUF);
+	return f;
+}
+
 
 /***********************************************************/
 static RealF _get_avg( struct accumulators_st *p) {
 
 	if (p->nobs == 0) return 0.0;
 
-	return (RealF) (p->sum / (double) p->nobs);
+	return (RealF) p->mean;
 
 }
 
 
 /***********************************************************/
 static RealF _get_std( struct accumulators_st *p) {
-	double s;
 
 	if (p->nobs <= 1) return 0.0;
 
-	s  = (p->nobs * p->sum_sq) - (p->sum * p->sum);
-	s /= p->nobs * (p->nobs -1);
+	return (RealF) sqrt(p->m2 / (double) (p->nobs -1));
 
-	return (RealF) sqrt(s);
+}
+
+
+/***********************************************************/
+static void _merge( struct accumulators_st *p, const struct accumulators_st *q) {
+/* combine the observations of q into p, as if they had
+ * all been collected into p */
+	double d;
+	unsigned long n;
+
+	if (q->nobs == 0) return;
+	if (p->nobs == 0) { *p = *q; return; }
+
+	n = p->nobs + q->nobs;
+	d = q->mean - p->mean;
+	p->mean += d * q->nobs / n;
+	p->m2 += q->m2 + d * d * p->nobs * q->nobs / n;
+	p->nobs = n;
 
 }
 
@@ -0,0 +1,220 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: ST_stattest.c
+/*  Type: program
+/*  Application: STEPPE - plant community dynamics simulator
+/*  Purpose: stattest checks stat_Merge_Accumulators() (see
+ *           ST_stats.c).  It sets up the grid accumulators
+ *           of a made up model of STAT_GROUPS groups and
+ *           STAT_SPECIES species for 3 cells, collects every
+ *           iteration of one stream of values into cell 2,
+ *           and the same stream split between cells 0 and 1
+ *           (at an iteration that changes with the year, so
+ *           for some years cell 0 or cell 1 gets nothing),
+ *           merges cell 1 into cell 0, and writes the bmass
+ *           and seed dispersal files of cells 0 and 2 with
+ *           stat_Output_Cell().  Every number in them
+ *           (counts, means, and standard deviations) has to
+ *           be the same to within the rounding of the files.
+ *
+ *           usage: stattest
+ *
+ *           prints the differences and exits with 1 if there
+ *           are any.  Build and run it with "make statcheck";
+ *           it links ST_stats.o with the generic code only,
+ *           so the few model functions the statistics call
+ *           are defined here.
+/*  History:
+/*     (10/18/2026) -- INITIAL CODING
+/*
+/********************************************************/
+/********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ST_steppe.h"
+#include "generic.h"
+#include "filefuncs.h"
+#include "myMemory.h"
+#include "ST_globals.h"
+
+#define STAT_GROUPS  2
+#define STAT_SPECIES 3
+#define STAT_YEARS   6
+#define STAT_ITERS   40
+
+/* the files of the merged (0) and single (2) cells */
+#define STAT_BMASS0 "stattest_bmass0.out"
+#define STAT_BMASS2 "stattest_bmass2.out"
+#define STAT_SEED0  "stattest_seed0.out"
+#define STAT_SEED2  "stattest_seed2.out"
+
+/************ External Variable Definitions  ***************/
+/*              see ST_globals.h                       */
+/***********************************************************/
+char errstr[1024];
+char inbuf[1024];
+FILE *logfp;
+int logged;
+Bool QuietMode, EchoInits;
+SpeciesType   *Species[MAX_SPECIES];
+GroupType     *RGroup [MAX_RGROUPS];
+SucculentType  Succulent;
+EnvType        Env;
+PlotType       Plot;
+ModelType      Globals;
+BmassFlagsType BmassFlags;
+MortFlagsType  MortFlags;
+
+Bool UseSoilwat;
+Bool UseGrid;
+Bool UseSeedDispersal;
+Bool UseProgressBar;
+
+/* in ST_stats.c */
+void stat_Collect( Int year );
+void stat_Init_Accumulators( void );
+void stat_Load_Accumulators( int cell, int year );
+void stat_Save_Accumulators( int cell, int year );
+void stat_Merge_Accumulators( int cell, int from_cell );
+void stat_Output_Cell( int cell, const char *fileMort, const char *fileBMass, const char *fileReceivedProb, const char sep, Bool makeHeader);
+
+static RealF _biomass[STAT_GROUPS + STAT_SPECIES]; /* groups then species */
+
+/* the model functions ST_stats.c calls, which would pull
+ * in the rest of the model */
+RealF RGroup_GetBiomass( GrpIndex rg) {
+  return _biomass[rg];
+}
+
+RealF Species_GetBiomass( SppIndex sp) {
+  return _biomass[STAT_GROUPS + sp];
+}
+
+char *Parm_name( ST_FileIndex i) {
+  return "";
+}
+
+static double _value( int iter, int year, int k, double base) {
+/* the kth value of an iteration & year, spread around base */
+  return base + ((iter * 37 + year * 11 + k * 5) % 101) * 0.25;
+}
+
+static void _set_year( int iter, int year) {
+/* sets everything stat_Collect() looks at */
+  GrpIndex rg;
+  SppIndex sp;
+  int k = 0;
+
+  Plot.disturbed = (iter + year) % 4 == 0;
+  Env.ppt = (IntS) (_value(iter, year, k++, 300.) * 4);
+  Env.temp = (RealF) _value(iter, year, k++, 10.);
+  ForEachGroup(rg) {
+    _biomass[rg] = (RealF) _value(iter, year, k++, 1000.);
+    RGroup[rg]->relsize = (RealF) _value(iter, year, k++, 0.) / 25.;
+    RGroup[rg]->pr = (RealF) _value(iter, year, k++, 1.);
+  }
+  ForEachSpecies(sp) {
+    _biomass[STAT_GROUPS + sp] = (RealF) _value(iter, year, k++, 500.);
+    Species[sp]->est_count = (SppIndex) _value(iter, year, k++, 0.);
+    Species[sp]->received_prob = (RealF) _value(iter, year, k++, 0.) / 25.;
+  }
+}
+
+static void _collect( int cell, int year) {
+  stat_Load_Accumulators(cell, year);
+  stat_Collect(year);
+  stat_Save_Accumulators(cell, year);
+}
+
+static int _compare( const char *name0, const char *name2) {
+/* compares the numbers of two files written with "%f",
+ * returns how many are different */
+  FILE *f0 = OpenFile(name0, "r"), *f2 = OpenFile(name2, "r");
+  char buf0[4096], buf2[4096], *p0, *p2, *e0, *e2;
+  double v0, v2;
+  int line = 0, field, bad = 0;
+
+  while (fgets(buf0, sizeof(buf0), f0)) {
+    line++;
+    if (!fgets(buf2, sizeof(buf2), f2)) {
+      printf("%s: line %d isn't in %s\n", name0, line, name2);
+      bad++;
+      break;
+    }
+    for (p0 = buf0, p2 = buf2, field = 1; ; p0 = e0, p2 = e2, field++) {
+      v0 = strtod(p0, &e0);
+      v2 = strtod(p2, &e2);
+      if (e0 == p0 || e2 == p2) break;
+      if (fabs(v0 - v2) > 2e-6 + 1e-6 * fabs(v2)) {
+        printf("%s: line %d field %d is %f, %f in %s\n",
+               name0, line, field, v0, v2, name2);
+        bad++;
+      }
+    }
+    if (e0 == p0 && e2 != p2) {
+      printf("%s: line %d has fewer fields than in %s\n", name0, line, name2);
+      bad++;
+    }
+  }
+
+  CloseFile(&f0);
+  CloseFile(&f2);
+  return bad;
+}
+
+int main( void) {
+  GrpIndex rg;
+  SppIndex sp;
+  int iter, year, split, bad;
+
+  logged = FALSE;
+  logfp = stderr;
+
+  /* the model, with every biomass statistic and the seed
+   * dispersal ones turned on */
+  Globals.grpCount = STAT_GROUPS;
+  Globals.sppCount = STAT_SPECIES;
+  Globals.runModelYears = STAT_YEARS;
+  Globals.runModelIterations = STAT_ITERS;
+  Globals.nCells = 3;
+  UseGrid = UseSeedDispersal = TRUE;
+  ForEachGroup(rg) {
+    RGroup[rg] = (GroupType *) Mem_Calloc(1, sizeof(GroupType), "main()");
+    sprintf(RGroup[rg]->name, "g%d", rg % 10);
+  }
+  ForEachSpecies(sp) {
+    Species[sp] = (SpeciesType *) Mem_Calloc(1, sizeof(SpeciesType), "main()");
+    sprintf(Species[sp]->name, "s%d", sp % 10);
+  }
+  BmassFlags.summary = BmassFlags.yr = BmassFlags.dist = BmassFlags.ppt =
+    BmassFlags.tmp = BmassFlags.grpb = BmassFlags.pr = BmassFlags.size =
+    BmassFlags.sppb = BmassFlags.indv = TRUE;
+  BmassFlags.sep = '\t';
+
+  stat_Init_Accumulators();
+
+  for (iter = 0; iter < STAT_ITERS; iter++)
+    for (year = 1; year <= STAT_YEARS; year++) {
+      split = (year % 3 == 0) ? 0 : (year % 3 == 1) ? 17 : STAT_ITERS;
+      _set_year(iter, year);
+      _collect(2, year);
+      _collect((iter < split) ? 0 : 1, year);
+    }
+
+  stat_Merge_Accumulators(0, 1);
+
+  stat_Output_Cell(0, NULL, STAT_BMASS0, STAT_SEED0, '\t', FALSE);
+  stat_Output_Cell(2, NULL, STAT_BMASS2, STAT_SEED2, '\t', FALSE);
+  bad = _compare(STAT_BMASS0, STAT_BMASS2) + _compare(STAT_SEED0, STAT_SEED2);
+  remove(STAT_BMASS0);
+  remove(STAT_BMASS2);
+  remove(STAT_SEED0);
+  remove(STAT_SEED2);
+
+  printf("stat_Merge_Accumulators(): %d iterations of %d years, %d different\n",
+         STAT_ITERS, STAT_YEARS, bad);
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,588 @@
+/********************************************************/
+/********************************************************/
+/*  Application: SOILWAT - soilwater dynamics simulator
+*  Source file: SW_Bench.c
+*  Type: main module
+*  Purpose: Microbenchmark of the SOILWAT kernels on
+*           realistic inputs.  It reads a SOILWAT input set,
+*           runs one year of it while recording the arguments
+*           of every call to the kernels (up to BENCH_MAXREC
+*           calls each), then replays the recorded calls for
+*           many repetitions and writes the ns/call and
+*           calls/second of each kernel to stdout:
+*
+*             petfunc, watrate, pot_soil_evap, pot_transp,
+*             transp_weighted_avg, infiltrate_water_high,
+*             infiltrate_water_low, hydraulic_redistribution,
+*             soil_temperature, SW_SWC_vol2bars, SW_MKV_today
+*
+*           The calls are recorded by linking with
+*           -Wl,--wrap=<kernel> (GNU ld), so the model code
+*           isn't changed: each __wrap_ function saves its
+*           arguments and calls the real kernel.  watrate is
+*           only called from inside SW_Flow_lib.c, so its
+*           arguments are taken from the pot_transp calls, and
+*           SW_MKV_today is just driven day by day.  Soil
+*           temperature and hydraulic redistribution are
+*           turned on for the recorded year so they get calls
+*           even when the inputs turn them off.
+*
+*           Kernels that change their arguments in place get
+*           a fresh copy of them before each call; the time of
+*           making the copies alone is measured and taken out.
+*
+*           SOILWAT's logfile goes to Output/ in the folder of
+*           files.in and the output of the recorded year to
+*           Output/ in dir; they're made if they aren't there.
+*
+*           Build with "make swbench" from the STEPWAT folder.
+*           usage: swbench [-d dir] [-f files.in] [-n reps]
+*                          [-k kernel]
+*             -d : operate (chdir) in dir
+*                  (default=testing/Stepwat Inputs)
+*             -f : SOILWAT files.in, relative to dir
+*                  (default=Input/sxw/files_v23dy.in)
+*             -n : repetitions of the recorded calls (default=1000)
+*             -k : only this kernel
+*
+*  History:
+*     (10/18/2026) -- INITIAL CODING
+*/
+/********************************************************/
+/********************************************************/
+
+/* =================================================== */
+/*                INCLUDES / DEFINES                   */
+/* --------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "generic.h"
+#include "filefuncs.h"
+#include "myMemory.h"
+#include "SW_Defines.h"
+#include "SW_Control.h"
+#include "SW_Model.h"
+#include "SW_Site.h"
+#include "SW_VegProd.h"
+#include "SW_Markov.h"
+#include "SW_SoilWater.h"
+#include "SW_Flow_lib.h"
+
+#define BENCH_MAXREC 4096   /* calls recorded for each kernel */
+
+/* =================================================== */
+/*                  Global Declarations                */
+/* externed by other routines elsewhere in the program */
+/* --------------------------------------------------- */
+
+/* see generic.h and filefuncs.h for more info on these vars */
+char inbuf[1024];   /* buffer used by input statements */
+char errstr[MAX_ERROR];  /* used to compose an error msg    */
+FILE *logfp;        /* file handle for logging messages */
+int logged;         /* boolean: true = we logged a msg */
+Bool QuietMode,
+EchoInits; /* if true, echo inits to logfile */
+
+extern SW_MODEL SW_Model;
+extern SW_SITE SW_Site;
+extern SW_VEGPROD SW_VegProd;
+
+/* =================================================== */
+/*                Module-Level Declarations            */
+/* --------------------------------------------------- */
+
+/* the arguments of one call of each kernel; arrays are
+ * copied, the in/out ones as they were before the call */
+typedef struct {
+  unsigned int doy;
+  double avgtemp, rlat, reflec, humid, windsp, cloudcov, transcoeff;
+} PetArgs;
+
+typedef struct {
+  unsigned int nelyrs;
+  double ecoeff[MAX_LAYERS], totagb, fbse, petday, shift, shape, inflec,
+         range, width[MAX_LAYERS], swc[MAX_LAYERS], Es_param_limit;
+} EvapArgs;
+
+typedef struct {
+  double swpavg, biolive, biodead, fbst, petday, swp_shift, swp_shape,
+         swp_inflec, swp_range, shade_scale, shade_deadmax, shade_xinflex,
+         shade_slope, shade_yinflex, shade_range;
+} TranspArgs;
+
+typedef struct {
+  unsigned int n_tr_rgns, n_layers, tr_regions[MAX_LAYERS];
+  double tr_coeff[MAX_LAYERS], swc[MAX_LAYERS];
+} AvgArgs;
+
+typedef struct {
+  unsigned int nlyrs;
+  double swc[MAX_LAYERS], drain[MAX_LAYERS], drainout, pptleft,
+         swcfc[MAX_LAYERS], swcsat[MAX_LAYERS], impermeability[MAX_LAYERS],
+         standingWater;
+} InfHighArgs;
+
+typedef struct {
+  unsigned int nlyrs;
+  double swc[MAX_LAYERS], drain[MAX_LAYERS], drainout, sdrainpar,
+         sdraindpth, swcfc[MAX_LAYERS], width[MAX_LAYERS], swcmin[MAX_LAYERS],
+         swcsat[MAX_LAYERS], impermeability[MAX_LAYERS], standingWater;
+} InfLowArgs;
+
+typedef struct {
+  unsigned int nlyrs;
+  double swc[MAX_LAYERS], swcwp[MAX_LAYERS], lyrRootCo[MAX_LAYERS],
+         hydred[MAX_LAYERS], maxCondroot, swp50, shapeCond, scale;
+} HydRedArgs;
+
+typedef struct {
+  unsigned int nlyrs, nRgr;
+  double airTemp, pet, aet, biomass, swc[MAX_LAYERS], bDensity[MAX_LAYERS],
+         width[MAX_LAYERS], oldsTemp[MAX_LAYERS], sTemp[MAX_LAYERS],
+         fc[MAX_LAYERS], wp[MAX_LAYERS], bmLimiter, t1Param1, t1Param2,
+         t1Param3, csParam1, csParam2, shParam, snowpack, meanAirTemp, deltaX,
+         theMaxDepth;
+} SoilTempArgs;
+
+typedef struct {
+  RealD lyrvolcm;
+  LyrIndex n;
+} Vol2barsArgs;
+
+static Bool _recording;
+static PetArgs _pet[BENCH_MAXREC];
+static EvapArgs _evap[BENCH_MAXREC];
+static TranspArgs _transp[BENCH_MAXREC];
+static AvgArgs _avg[BENCH_MAXREC];
+static InfHighArgs _infhigh[BENCH_MAXREC];
+static InfLowArgs _inflow[BENCH_MAXREC];
+static HydRedArgs _hydred[BENCH_MAXREC];
+static SoilTempArgs _soiltemp[BENCH_MAXREC];
+static Vol2barsArgs _vol2bars[BENCH_MAXREC];
+static int _npet, _nevap, _ntransp, _navg, _ninfhigh, _ninflow, _nhydred,
+           _nsoiltemp, _nvol2bars;
+
+static char _firstfile[1024];  /* SW_F_construct() changes it */
+static volatile double _sink;  /* keeps the results from being optimized away */
+
+static void usage(void);
+static double _now(void);
+static void _record_year(void);
+static void _report(const char *name, int ncalls, int reps,
+                    double seconds, double copy_seconds);
+static void _bench(const char *only, int reps);
+
+#define _copy(dst, src, n) memcpy((dst), (src), (n) * sizeof(double))
+
+/* =================================================== */
+/*               The recording wrappers                */
+/* --------------------------------------------------- */
+
+double __real_petfunc(unsigned int doy, double avgtemp, double rlat,
+              double reflec, double humid, double windsp,
+              double cloudcov, double transcoeff);
+double __wrap_petfunc(unsigned int doy, double avgtemp, double rlat,
+              double reflec, double humid, double windsp,
+              double cloudcov, double transcoeff);
+void __real_pot_soil_evap( double *bserate, unsigned int nelyrs, double ecoeff[],
+                    double totagb, double fbse, double petday,
+                    double shift, double shape, double inflec,
+                    double range, double width[],  double swc[], double Es_param_limit);
+void __wrap_pot_soil_evap( double *bserate, unsigned int nelyrs, double ecoeff[],
+                    double totagb, double fbse, double petday,
+                    double shift, double shape, double inflec,
+                    double range, double width[],  double swc[], double Es_param_limit);
+void __real_pot_transp(double *bstrate, double swpavg, double biolive,
+                double biodead,  double fbst,   double petday,
+				double swp_shift, double swp_shape, double swp_inflec, double swp_range,
+				double shade_scale, double shade_deadmax, double shade_xinflex, double shade_slope, double shade_yinflex, double shade_range);
+void __wrap_pot_transp(double *bstrate, double swpavg, double biolive,
+                double biodead,  double fbst,   double petday,
+				double swp_shift, double swp_shape, double swp_inflec, double swp_range,
+				double shade_scale, double shade_deadmax, double shade_xinflex, double shade_slope, double shade_yinflex, double shade_range);
+void __real_transp_weighted_avg( double *swp_avg, unsigned int n_tr_rgns,
+                          unsigned int n_layers, unsigned int tr_regions[],
+                          double tr_coeff[], double swc[]);
+void __wrap_transp_weighted_avg( double *swp_avg, unsigned int n_tr_rgns,
+                          unsigned int n_layers, unsigned int tr_regions[],
+                          double tr_coeff[], double swc[]);
+void __real_infiltrate_water_high( double swc[], double drain[],
+                            double *drainout, double pptleft, unsigned int nlyrs,
+                            double swcfc[], double swcsat[],
+                            double impermeability[], double *standingWater);
+void __wrap_infiltrate_water_high( double swc[], double drain[],
+                            double *drainout, double pptleft, unsigned int nlyrs,
+                            double swcfc[], double swcsat[],
+                            double impermeability[], double *standingWater);
+void __real_infiltrate_water_low( double swc[], double drain[],
+                           double *drainout, unsigned int nlyrs,
+                           double sdrainpar, double sdraindpth, double swcfc[],
+                           double width[], double swcmin[], double swcsat[],
+                           double impermeability[], double *standingWater);
+void __wrap_infiltrate_water_low( double swc[], double drain[],
+                           double *drainout, unsigned int nlyrs,
+                           double sdrainpar, double sdraindpth, double swcfc[],
+                           double width[], double swcmin[], double swcsat[],
+                           double impermeability[], double *standingWater);
+void __real_hydraulic_redistribution( double swc[], double swcwp[], double lyrRootCo[],
+                           double hydred[], unsigned int nlyrs, double maxCondroot,
+                           double swp50, double shapeCond, double scale);
+void __wrap_hydraulic_redistribution( double swc[], double swcwp[], double lyrRootCo[],
+                           double hydred[], unsigned int nlyrs, double maxCondroot,
+                           double swp50, double shapeCond, double scale);
+void __real_soil_temperature( double airTemp, double pet, double aet, double biomass,
+						double swc[], double bDensity[], double width[],
+						double oldsTemp[], double sTemp[], unsigned int nlyrs,
+						double fc[], double wp[], double bmLimiter,
+						double t1Param1, double t1Param2, double t1Param3,
+						double csParam1, double csParam2, double shParam,
+						double snowpack, double meanAirTemp, double deltaX,
+						double theMaxDepth, unsigned int nRgr);
+void __wrap_soil_temperature( double airTemp, double pet, double aet, double biomass,
+						double swc[], double bDensity[], double width[],
+						double oldsTemp[], double sTemp[], unsigned int nlyrs,
+						double fc[], double wp[], double bmLimiter,
+						double t1Param1, double t1Param2, double t1Param3,
+						double csParam1, double csParam2, double shParam,
+						double snowpack, double meanAirTemp, double deltaX,
+						double theMaxDepth, unsigned int nRgr);
+RealD __real_SW_SWC_vol2bars(RealD lyrvolcm, LyrIndex n);
+RealD __wrap_SW_SWC_vol2bars(RealD lyrvolcm, LyrIndex n);
+
+double __wrap_petfunc(unsigned int doy, double avgtemp, double rlat,
+              double reflec, double humid, double windsp,
+              double cloudcov, double transcoeff) {
+  if (_recording && _npet < BENCH_MAXREC) {
+    PetArgs *a = &_pet[_npet++];
+    a->doy = doy; a->avgtemp = avgtemp; a->rlat = rlat; a->reflec = reflec;
+    a->humid = humid; a->windsp = windsp; a->cloudcov = cloudcov;
+    a->transcoeff = transcoeff;
+  }
+  return __real_petfunc(doy, avgtemp, rlat, reflec, humid, windsp, cloudcov,
+                        transcoeff);
+}
+
+void __wrap_pot_soil_evap( double *bserate, unsigned int nelyrs, double ecoeff[],
+                    double totagb, double fbse, double petday,
+                    double shift, double shape, double inflec,
+                    double range, double width[],  double swc[], double Es_param_limit) {
+  if (_recording && _nevap < BENCH_MAXREC) {
+    EvapArgs *a = &_evap[_nevap++];
+    a->nelyrs = nelyrs; _copy(a->ecoeff, ecoeff, nelyrs); a->totagb = totagb;
+    a->fbse = fbse; a->petday = petday; a->shift = shift; a->shape = shape;
+    a->inflec = inflec; a->range = range; _copy(a->width, width, nelyrs);
+    _copy(a->swc, swc, nelyrs); a->Es_param_limit = Es_param_limit;
+  }
+  __real_pot_soil_evap(bserate, nelyrs, ecoeff, totagb, fbse, petday, shift,
+                       shape, inflec, range, width, swc, Es_param_limit);
+}
+
+void __wrap_pot_transp(double *bstrate, double swpavg, double biolive,
+                double biodead,  double fbst,   double petday,
+				double swp_shift, double swp_shape, double swp_inflec, double swp_range,
+				double shade_scale, double shade_deadmax, double shade_xinflex, double shade_slope, double shade_yinflex, double shade_range) {
+  if (_recording && _ntransp < BENCH_MAXREC) {
+    TranspArgs *a = &_transp[_ntransp++];
+    a->swpavg = swpavg; a->biolive = biolive; a->biodead = biodead;
+    a->fbst = fbst; a->petday = petday; a->swp_shift = swp_shift;
+    a->swp_shape = swp_shape; a->swp_inflec = swp_inflec;
+    a->swp_range = swp_range; a->shade_scale = shade_scale;
+    a->shade_deadmax = shade_deadmax; a->shade_xinflex = shade_xinflex;
+    a->shade_slope = shade_slope; a->shade_yinflex = shade_yinflex;
+    a->shade_range = shade_range;
+  }
+  __real_pot_transp(bstrate, swpavg, biolive, biodead, fbst, petday,
+                    swp_shift, swp_shape, swp_inflec, swp_range, shade_scale,
+                    shade_deadmax, shade_xinflex, shade_slope, shade_yinflex,
+                    shade_range);
+}
+
+void __wrap_transp_weighted_avg( double *swp_avg, unsigned int n_tr_rgns,
+                          unsigned int n_layers, unsigned int tr_regions[],
+                          double tr_coeff[], double swc[]) {
+  if (_recording && _navg < BENCH_MAXREC) {
+    AvgArgs *a = &_avg[_navg++];
+    a->n_tr_rgns = n_tr_rgns; a->n_layers = n_layers;
+    memcpy(a->tr_regions, tr_regions, n_layers * sizeof(unsigned int));
+    _copy(a->tr_coeff, tr_coeff, n_layers); _copy(a->swc, swc, n_layers);
+  }
+  __real_transp_weighted_avg(swp_avg, n_tr_rgns, n_layers, tr_regions,
+                             tr_coeff, swc);
+}
+
+void __wrap_infiltrate_water_high( double swc[], double drain[],
+                            double *drainout, double pptleft, unsigned int nlyrs,
+                            double swcfc[], double swcsat[],
+                            double impermeability[], double *standingWater) {
+  if (_recording && _ninfhigh < BENCH_MAXREC) {
+    InfHighArgs *a = &_infhigh[_ninfhigh++];
+    a->nlyrs = nlyrs; _copy(a->swc, swc, nlyrs); _copy(a->drain, drain, nlyrs);
+    a->drainout = *drainout; a->pptleft = pptleft;
+    _copy(a->swcfc, swcfc, nlyrs); _copy(a->swcsat, swcsat, nlyrs);
+    _copy(a->impermeability, impermeability, nlyrs);
+    a->standingWater = *standingWater;
+  }
+  __real_infiltrate_water_high(swc, drain, drainout, pptleft, nlyrs, swcfc,
+                               swcsat, impermeability, standingWater);
+}
+
+void __wrap_infiltrate_water_low( double swc[], double drain[],
+                           double *drainout, unsigned int nlyrs,
+                           double sdrainpar, double sdraindpth, double swcfc[],
+                           double width[], double swcmin[], double swcsat[],
+                           double impermeability[], double *standingWater) {
+  if (_recording && _ninflow < BENCH_MAXREC) {
+    InfLowArgs *a = &_inflow[_ninflow++];
+    a->nlyrs = nlyrs; _copy(a->swc, swc, nlyrs); _copy(a->drain, drain, nlyrs);
+    a->drainout = *drainout; a->sdrainpar = sdrainpar;
+    a->sdraindpth = sdraindpth; _copy(a->swcfc, swcfc, nlyrs);
+    _copy(a->width, width, nlyrs); _copy(a->swcmin, swcmin, nlyrs);
+    _copy(a->swcsat, swcsat, nlyrs);
+    _copy(a->impermeability, impermeability, nlyrs);
+    a->standingWater = *standingWater;
+  }
+  __real_infiltrate_water_low(swc, drain, drainout, nlyrs, sdrainpar,
+                              sdraindpth, swcfc, width, swcmin, swcsat,
+                              impermeability, standingWater);
+}
+
+void __wrap_hydraulic_redistribution( double swc[], double swcwp[], double lyrRootCo[],
+                           double hydred[], unsigned int nlyrs, double maxCondroot,
+                           double swp50, double shapeCond, double scale) {
+  if (_recording && _nhydred < BENCH_MAXREC) {
+    HydRedArgs *a = &_hydred[_nhydred++];
+    a->nlyrs = nlyrs; _copy(a->swc, swc, nlyrs); _copy(a->swcwp, swcwp, nlyrs);
+    _copy(a->lyrRootCo, lyrRootCo, nlyrs); _copy(a->hydred, hydred, nlyrs);
+    a->maxCondroot = maxCondroot; a->swp50 = swp50; a->shapeCond = shapeCond;
+    a->scale = scale;
+  }
+  __real_hydraulic_redistribution(swc, swcwp, lyrRootCo, hydred, nlyrs,
+                                  maxCondroot, swp50, shapeCond, scale);
+}
+
+void __wrap_soil_temperature( double airTemp, double pet, double aet, double biomass,
+						double swc[], double bDensity[], double width[],
+						double oldsTemp[], double sTemp[], unsigned int nlyrs,
+						double fc[], double wp[], double bmLimiter,
+						double t1Param1, double t1Param2, double t1Param3,
+						double csParam1, double csParam2, double shParam,
+						double snowpack, double meanAirTemp, double deltaX,
+						double theMaxDepth, unsigned int nRgr) {
+  if (_recording && _nsoiltemp < BENCH_MAXREC) {
+    SoilTempArgs *a = &_soiltemp[_nsoiltemp++];
+    a->nlyrs = nlyrs; a->nRgr = nRgr; a->airTemp = airTemp; a->pet = pet;
+    a->aet = aet; a->biomass = biomass; _copy(a->swc, swc, nlyrs);
+    _copy(a->bDensity, bDensity, nlyrs); _copy(a->width, width, nlyrs);
+    _copy(a->oldsTemp, oldsTemp, nlyrs); _copy(a->sTemp, sTemp, nlyrs);
+    _copy(a->fc, fc, nlyrs); _copy(a->wp, wp, nlyrs);
+    a->bmLimiter = bmLimiter; a->t1Param1 = t1Param1; a->t1Param2 = t1Param2;
+    a->t1Param3 = t1Param3; a->csParam1 = csParam1; a->csParam2 = csParam2;
+    a->shParam = shParam; a->snowpack = snowpack;
+    a->meanAirTemp = meanAirTemp; a->deltaX = deltaX;
+    a->theMaxDepth = theMaxDepth;
+  }
+  __real_soil_temperature(airTemp, pet, aet, biomass, swc, bDensity, width,
+                          oldsTemp, sTemp, nlyrs, fc, wp, bmLimiter, t1Param1,
+                          t1Param2, t1Param3, csParam1, csParam2, shParam,
+                          snowpack, meanAirTemp, deltaX, theMaxDepth, nRgr);
+}
+
+RealD __wrap_SW_SWC_vol2bars(RealD lyrvolcm, LyrIndex n) {
+  if (_recording && _nvol2bars < BENCH_MAXREC) {
+    _vol2bars[_nvol2bars].lyrvolcm = lyrvolcm;
+    _vol2bars[_nvol2bars++].n = n;
+  }
+  return __real_SW_SWC_vol2bars(lyrvolcm, n);
+}
+
+/************  Main() ************************/
+int main ( int argc, char **argv) {
+/* =================================================== */
+  char *dir = "testing/Stepwat Inputs",
+       *firstfile = "Input/sxw/files_v23dy.in",
+       *only = NULL;
+  int i, reps = 1000;
+
+  logged = FALSE;
+  logfp = stderr;
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 >= argc)
+      usage();
+    switch (argv[i][1]) {
+      case 'd': dir = argv[++i]; break;
+      case 'f': firstfile = argv[++i]; break;
+      case 'n': reps = atoi(argv[++i]); break;
+      case 'k': only = argv[++i]; break;
+      default: usage();
+    }
+  }
+  if (reps < 1) usage();
+
+  if (!ChDir(dir)) {
+    fprintf(stderr, "swbench: can't chdir to %s\n", dir);
+    exit(-1);
+  }
+
+  strcpy(_firstfile, firstfile);
+  sprintf(inbuf, "%sOutput", DirName(firstfile) ? DirName(firstfile) : "");
+  MkDir(inbuf);
+  MkDir("Output");
+  _record_year();
+  _bench(only, reps);
+
+  return 0;
+}
+/*********** End of Main() *******************/
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: swbench [-d dir] [-f files.in] [-n reps] [-k kernel]\n"
+          "  -d : operate (chdir) in dir (default=testing/Stepwat Inputs)\n"
+          "  -f : SOILWAT files.in, relative to dir\n"
+          "       (default=Input/sxw/files_v23dy.in)\n"
+          "  -n : repetitions of the recorded calls (default=1000)\n"
+          "  -k : only benchmark this kernel\n");
+  exit(0);
+}
+
+static double _now(void) {
+/* =================================================== */
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void _record_year(void) {
+/* =================================================== */
+/* runs the first year of the inputs with the recording
+ * on; soil temperature and hydraulic redistribution are
+ * turned on so that they're called */
+
+  SW_CTL_init_model(_firstfile);
+
+  SW_Site.use_soil_temp = TRUE;
+  SW_VegProd.grass.flagHydraulicRedistribution = TRUE;
+  SW_VegProd.shrub.flagHydraulicRedistribution = TRUE;
+  SW_VegProd.tree.flagHydraulicRedistribution = TRUE;
+
+  SW_Model.year = SW_Model.startyr;
+  _recording = TRUE;
+  SW_CTL_run_current_year();
+  _recording = FALSE;
+}
+
+static void _report(const char *name, int ncalls, int reps,
+                    double seconds, double copy_seconds) {
+/* =================================================== */
+  double calls = (double) ncalls * reps,
+         t = seconds - copy_seconds;
+
+  if (t < 0.) t = 0.;
+  if (ncalls == 0)
+    printf("%s,0,%d,,\n", name, reps);
+  else
+    printf("%s,%d,%d,%.2f,%.0f\n", name, ncalls, reps, 1e9 * t / calls,
+           GT(t, 0.) ? calls / t : 0.);
+}
+
+/* runs body for every recorded call of a kernel, reps
+ * times, and reports the time less the time of copy,
+ * the part of the body that restores the arguments */
+#define _time_kernel(name, n, copy, body) \
+  if (isnull(only) || !strcmp(only, name)) { \
+    double t0, t1, t2; \
+    int r, i; \
+    t0 = _now(); \
+    for (r = 0; r < reps; r++) \
+      for (i = 0; i < (n); i++) { copy; } \
+    t1 = _now(); \
+    for (r = 0; r < reps; r++) \
+      for (i = 0; i < (n); i++) { copy; body; } \
+    t2 = _now(); \
+    _report(name, n, reps, t2 - t1, t1 - t0); \
+  }
+
+static void _bench(const char *only, int reps) {
+/* =================================================== */
+  double out, swc[MAX_LAYERS], drain[MAX_LAYERS], hydred[MAX_LAYERS],
+         sTemp[MAX_LAYERS], drainout, standingWater, tmax, tmin, rain = 0.;
+
+  printf("kernel,calls_recorded,reps,ns_per_call,calls_per_second\n");
+
+  _time_kernel("petfunc", _npet, ,
+    PetArgs *a = &_pet[i];
+    _sink += petfunc(a->doy, a->avgtemp, a->rlat, a->reflec, a->humid,
+                     a->windsp, a->cloudcov, a->transcoeff));
+
+  _time_kernel("watrate", _ntransp, ,
+    TranspArgs *a = &_transp[i];
+    _sink += watrate(a->swpavg, a->petday, a->swp_shift, a->swp_shape,
+                     a->swp_inflec, a->swp_range));
+
+  _time_kernel("pot_soil_evap", _nevap, ,
+    EvapArgs *a = &_evap[i];
+    pot_soil_evap(&out, a->nelyrs, a->ecoeff, a->totagb, a->fbse, a->petday,
+                  a->shift, a->shape, a->inflec, a->range, a->width, a->swc,
+                  a->Es_param_limit);
+    _sink += out);
+
+  _time_kernel("pot_transp", _ntransp, ,
+    TranspArgs *a = &_transp[i];
+    pot_transp(&out, a->swpavg, a->biolive, a->biodead, a->fbst, a->petday,
+               a->swp_shift, a->swp_shape, a->swp_inflec, a->swp_range,
+               a->shade_scale, a->shade_deadmax, a->shade_xinflex,
+               a->shade_slope, a->shade_yinflex, a->shade_range);
+    _sink += out);
+
+  _time_kernel("transp_weighted_avg", _navg, ,
+    AvgArgs *a = &_avg[i];
+    transp_weighted_avg(&out, a->n_tr_rgns, a->n_layers, a->tr_regions,
+                        a->tr_coeff, a->swc);
+    _sink += out);
+
+  _time_kernel("infiltrate_water_high", _ninfhigh,
+    InfHighArgs *a = &_infhigh[i];
+    _copy(swc, a->swc, a->nlyrs); _copy(drain, a->drain, a->nlyrs);
+    drainout = a->drainout; standingWater = a->standingWater,
+    infiltrate_water_high(swc, drain, &drainout, a->pptleft, a->nlyrs,
+                          a->swcfc, a->swcsat, a->impermeability,
+                          &standingWater);
+    _sink += drainout);
+
+  _time_kernel("infiltrate_water_low", _ninflow,
+    InfLowArgs *a = &_inflow[i];
+    _copy(swc, a->swc, a->nlyrs); _copy(drain, a->drain, a->nlyrs);
+    drainout = a->drainout; standingWater = a->standingWater,
+    infiltrate_water_low(swc, drain, &drainout, a->nlyrs, a->sdrainpar,
+                         a->sdraindpth, a->swcfc, a->width, a->swcmin,
+                         a->swcsat, a->impermeability, &standingWater);
+    _sink += drainout);
+
+  _time_kernel("hydraulic_redistribution", _nhydred,
+    HydRedArgs *a = &_hydred[i];
+    _copy(swc, a->swc, a->nlyrs); _copy(hydred, a->hydred, a->nlyrs),
+    hydraulic_redistribution(swc, a->swcwp, a->lyrRootCo, hydred, a->nlyrs,
+                             a->maxCondroot, a->swp50, a->shapeCond, a->scale);
+    _sink += hydred[0]);
+
+  _time_kernel("soil_temperature", _nsoiltemp, ,
+    SoilTempArgs *a = &_soiltemp[i];
+    soil_temperature(a->airTemp, a->pet, a->aet, a->biomass, a->swc,
+                     a->bDensity, a->width, a->oldsTemp, sTemp, a->nlyrs,
+                     a->fc, a->wp, a->bmLimiter, a->t1Param1, a->t1Param2,
+                     a->t1Param3, a->csParam1, a->csParam2, a->shParam,
+                     a->snowpack, a->meanAirTemp, a->deltaX, a->theMaxDepth,
+                     a->nRgr);
+    _sink += sTemp[0]);
+
+  _time_kernel("SW_SWC_vol2bars", _nvol2bars, ,
+    _sink += SW_SWC_vol2bars(_vol2bars[i].lyrvolcm, _vol2bars[i].n));
+
+  _time_kernel("SW_MKV_today", 365, ,
+    SW_MKV_today(i, &tmax, &tmin, &rain);
+    _sink += tmax + tmin + rain);
+}
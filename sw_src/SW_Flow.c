@@ -78,6 +78,7 @@
 	05/25/2012  (DLM) added module level variables lyroldsTemp [MAX_LAYERS] & lyrsTemp [MAX_LAYERS] to keep track of soil temperatures, added lyrbDensity to keep track of the bulk density for each layer
 	05/25/2012  (DLM) edited records2arrays(void); & arrays2records(void); functions to move values to / from lyroldsTemp & lyrTemp & lyrbDensity
 	05/25/2012  (DLM) added call to soil_temperature function in SW_Water_Flow(void)
+	10/18/2026	added SW_FLW_get_pools() & SW_FLW_set_pools() so the grid can keep the intercepted & standing water of each cell
 */
 /********************************************************/
 /********************************************************/
@@ -680,6 +681,38 @@ int  doy, month;
 }  /* END OF WATERFLOW */
 
 
+void SW_FLW_get_pools(double pools[]) {
+/* copies the water that is carried over from one day to
+* the next outside of SW_Soilwat (intercepted by the
+* vegetation & litter, and standing on the surface) into
+* pools, which holds SW_FLW_NPOOLS values.  For the grid
+* (ST_grid.c), where each cell has its own.
+*/
+	int i;
+
+	for (i = 0; i < TWO_DAYS; i++) {
+		pools[i] = tree_h2o_qum[i];
+		pools[TWO_DAYS + i] = shrub_h2o_qum[i];
+		pools[2 * TWO_DAYS + i] = grass_h2o_qum[i];
+		pools[3 * TWO_DAYS + i] = litter_h2o_qum[i];
+		pools[4 * TWO_DAYS + i] = standingWater[i];
+	}
+}
+
+void SW_FLW_set_pools(const double pools[]) {
+/* the reverse of SW_FLW_get_pools() */
+	int i;
+
+	for (i = 0; i < TWO_DAYS; i++) {
+		tree_h2o_qum[i] = pools[i];
+		shrub_h2o_qum[i] = pools[TWO_DAYS + i];
+		grass_h2o_qum[i] = pools[2 * TWO_DAYS + i];
+		litter_h2o_qum[i] = pools[3 * TWO_DAYS + i];
+		standingWater[i] = pools[4 * TWO_DAYS + i];
+	}
+}
+
+
 
 static void records2arrays(void) {
 /* some values are unchanged by the water subs but
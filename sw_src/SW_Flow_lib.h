@@ -26,6 +26,7 @@
 	09/21/2011	(drs)	reduce_rates_by_unmetEvapDemand() is obsolete, complete E and T scaling in SW_Flow.c
 	05/25/2012  (DLM) added function soil_temperature to header file
 	05/31/2012  (DLM) added ST_RGR_VALUES struct to keep track of variables used in the soil_temperature function
+	10/18/2026	added SW_FLW_get_pools() & SW_FLW_set_pools() (they're in SW_Flow.c)
 */
 /********************************************************/
 /********************************************************/
@@ -149,4 +150,9 @@ void soil_temperature(	double airTemp, double pet, double aet, double biomass,
 						double theMaxDepth, unsigned int nRgr );
 								
 
+/* the water SW_Flow.c carries from day to day, for the grid */
+#define SW_FLW_NPOOLS (5 * TWO_DAYS)
+void SW_FLW_get_pools(double pools[]);
+void SW_FLW_set_pools(const double pools[]);
+
 #endif
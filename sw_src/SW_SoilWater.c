@@ -19,6 +19,7 @@
 	01/20/2012	(drs)	in function 'SW_SnowDepth': catching division by 0 if snowdensity is 0
 	02/03/2012	(drs)	added function 'RealD SW_SWC_SWCres(RealD sand, RealD clay, RealD porosity)': which calculates 'Brooks-Corey' residual volumetric soil water based on Rawls & Brakensiek (1985)
 	05/25/2012  (DLM) edited SW_SWC_read(void) function to get the initial values for soil temperature from SW_Site
+	10/18/2026	the snow temperature in SW_SWC_adjust_snow() is module level, so the grid can keep it for each cell (SW_SWC_get_temp_snow())
 */
 /********************************************************/
 /********************************************************/
@@ -60,6 +61,7 @@ SW_SOILWAT SW_Soilwat;  /* declared here, externed elsewhere */
 /*                Module-Level Variables               */
 /* --------------------------------------------------- */
 static char *MyFileName;
+static RealD temp_snow = 0.; /* used in SW_SWC_adjust_snow(), carries from day to day */
 
 
 /* =================================================== */
@@ -377,8 +379,6 @@ RealD	*snowpack = &SW_Soilwat.snowpack[Today],
 		doy = SW_Model.doy,
 		temp_ave, Rmelt, snow_cov = 1., cov_soil = 0.5,
 		SnowAccu = 0., SnowMelt = 0., SnowLoss = 0.;
-		
-static RealD temp_snow = 0.;
 
 temp_ave = (temp_min+temp_max)/2.;
 /* snow accumulation */
@@ -410,6 +410,19 @@ if ( GT(*snowpack, 0.) ) {
 }
 
 
+RealD SW_SWC_get_temp_snow(void) {
+/* =================================================== */
+/* the snow temperature carries from one day (and year) to
+* the next; for the grid, where each cell has its own */
+	return temp_snow;
+}
+
+void SW_SWC_set_temp_snow(RealD t) {
+/* =================================================== */
+	temp_snow = t;
+}
+
+
 RealD SW_SnowDepth( RealD SWE, RealD snowdensity) {
 /*---------------------
 	08/22/2011	(drs)	calculates depth of snowpack
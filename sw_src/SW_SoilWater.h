@@ -29,6 +29,7 @@
 	09/12/2011	(drs) added RealD snowdepth [TWO_DAYS] to struct SW_SOILWAT_OUTPUTS and SW_SOILWAT
 	02/03/2012	(drs)	added function 'RealD SW_SWC_SWCres(RealD sand, RealD clay, RealD porosity)': which calculates 'Brooks-Corey' residual volumetric soil water based on Rawls & Brakensiek (1985)
 	05/25/2012  (DLM) added sTemp[MAX_LAYERS] var to SW_SOILWAT_OUTPUTS struct & SW_SOILWAT struct to keep track of the soil temperatures 
+	10/18/2026	added SW_SWC_get_temp_snow() and SW_SWC_set_temp_snow()
 */
 /********************************************************/
 /********************************************************/
@@ -124,6 +125,8 @@ void SW_SWC_end_day( void);
 RealD SW_SWC_vol2bars(RealD lyrvolcm, LyrIndex n);
 RealD SW_SWC_bars2vol(RealD bars, LyrIndex n);
 RealD SW_SWC_SWCres(RealD sand, RealD clay, RealD porosity);
+RealD SW_SWC_get_temp_snow(void);
+void SW_SWC_set_temp_snow(RealD t);
 
 #ifdef DEBUG_MEM
 void SW_SWC_SetMemoryRefs(void);
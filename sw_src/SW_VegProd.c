@@ -27,6 +27,7 @@
 	09/26/2011	(drs)	added calls to Times.c:interpolate_monthlyValues() in SW_VPD_init() for each monthly input variable; replaced monthly loop with a daily loop for additional daily variables; adjusted _echo_inits()
 	10/17/2011	(drs)	in SW_VPD_init(): v->tree.total_agb_daily[doy] = v->tree.litter_daily[doy] + v->tree.biolive_daily[doy] instead of = v->tree.litter_daily[doy] + v->tree.biomass_daily[doy] to adjust for better scaling of potential bare-soil evaporation
 	02/04/2012	(drs) 	added input in SW_VPD_read() of RealD SWPcrit
+	10/18/2026	SW_VPD_init() keeps the monthly inputs of its last call in SW_VegProd and only redoes the vegetation types and months that changed
 */
 /********************************************************/
 /********************************************************/
@@ -68,6 +69,7 @@ static RealD lai_standing;  /*standing crop lai (g/m**2)     */
 /* --------------------------------------------------- */
 
 static void _echo_inits(void);
+static void _init_vegtype(VegType *veg, RealD fraction, Bool isTree);
 
 /* =================================================== */
 /* =================================================== */
@@ -457,6 +459,7 @@ void SW_VPD_read(void) {
 
 	CloseFile(&f);
 
+	SW_VegProd.daily_valid = FALSE;
 	SW_VPD_init();
 
 	if (EchoInits) _echo_inits();
@@ -494,105 +497,87 @@ void SW_VPD_init(void) {
   */
 
   SW_VEGPROD *v = &SW_VegProd;  /* convenience */
-  TimeInt doy; /* base1 */
-  
-	if( GT(v->fractionGrass, 0.) ) {
-		interpolate_monthlyValues(v->grass.litter, v->grass.litter_daily);
-		interpolate_monthlyValues(v->grass.biomass, v->grass.biomass_daily);
-		interpolate_monthlyValues(v->grass.pct_live, v->grass.pct_live_daily);
-		interpolate_monthlyValues(v->grass.lai_conv, v->grass.lai_conv_daily);
+
+	_init_vegtype(&v->grass, v->fractionGrass, FALSE);
+	_init_vegtype(&v->shrub, v->fractionShrub, FALSE);
+	_init_vegtype(&v->tree,  v->fractionTree,  TRUE);
+	
+	v->daily_lastdoy = Time_lastDOY();
+	v->daily_valid = TRUE;
+}
+
+
+static void _init_vegtype(VegType *veg, RealD fraction, Bool isTree) {
+/* ================================================== */
+/* daily values for one vegetation type, see SW_VPD_init().
+ * Only the months whose interpolated days could have changed
+ * since the previous call are redone: a month whose inputs
+ * changed, plus its neighbors, which interpolate toward it.
+ */
+	TimeInt doy, first, lastdoy; /* base1 */
+	Months m;
+	VegLast *last = &veg->last;
+	Bool on = GT(fraction, 0.), changed[MAX_MONTHS], redo[MAX_MONTHS], any = FALSE;
+	
+	if (!SW_VegProd.daily_valid || SW_VegProd.daily_lastdoy != Time_lastDOY() || on != last->on) {
+		for (m = Jan; m <= Dec; m++) changed[m] = TRUE;
+	} else if (!on) {
+		return; /* still off, daily values are still zero */
+	} else {
+		for (m = Jan; m <= Dec; m++)
+			changed[m] = (veg->litter[m] != last->litter[m] || veg->biomass[m] != last->biomass[m]
+			              || veg->pct_live[m] != last->pct_live[m] || veg->lai_conv[m] != last->lai_conv[m]);
 	}
-  
-	if( GT(v->fractionShrub, 0.) ) {
-		interpolate_monthlyValues(v->shrub.litter, v->shrub.litter_daily);
-		interpolate_monthlyValues(v->shrub.biomass, v->shrub.biomass_daily);
-		interpolate_monthlyValues(v->shrub.pct_live, v->shrub.pct_live_daily);
-		interpolate_monthlyValues(v->shrub.lai_conv, v->shrub.lai_conv_daily);
+	
+	for (m = Jan; m <= Dec; m++) {
+		redo[m] = changed[m] || changed[(m == Jan) ? Dec : m-1] || changed[(m == Dec) ? Jan : m+1];
+		any = any || redo[m];
 	}
-  
-	if( GT(v->fractionTree, 0.) ) {
-		interpolate_monthlyValues(v->tree.litter, v->tree.litter_daily);
-		interpolate_monthlyValues(v->tree.biomass, v->tree.biomass_daily);
-		interpolate_monthlyValues(v->tree.pct_live, v->tree.pct_live_daily);
-		interpolate_monthlyValues(v->tree.lai_conv, v->tree.lai_conv_daily);
+	if (!any) return;
+	
+	last->on = on;
+	memcpy(last->litter, veg->litter, sizeof(last->litter));
+	memcpy(last->biomass, veg->biomass, sizeof(last->biomass));
+	memcpy(last->pct_live, veg->pct_live, sizeof(last->pct_live));
+	memcpy(last->lai_conv, veg->lai_conv, sizeof(last->lai_conv));
+	
+	if (on) {
+		interpolate_monthlyValues_masked(veg->litter, veg->litter_daily, redo);
+		interpolate_monthlyValues_masked(veg->biomass, veg->biomass_daily, redo);
+		interpolate_monthlyValues_masked(veg->pct_live, veg->pct_live_daily, redo);
+		interpolate_monthlyValues_masked(veg->lai_conv, veg->lai_conv_daily, redo);
 	}
-  
-	for(doy = 1; doy <= MAX_DAYS; doy++){
-		if ( GT(v->fractionGrass, 0.) ) {
-			lai_standing    = v->grass.biomass_daily[doy] / v->grass.lai_conv_daily[doy];
-			v->grass.pct_cover_daily[doy]	= lai_standing / v->grass.conv_stcr;
-			if( GT(v->grass.canopy_height_constant, 0.) ) {
-				v->grass.veg_height_daily[doy] = v->grass.canopy_height_constant;
-			} else {
-				v->grass.veg_height_daily[doy]	= tanfunc(v->grass.biomass_daily[doy],
-										 v->grass.cnpy.xinflec,
-										 v->grass.cnpy.yinflec,
-										 v->grass.cnpy.range,
-										 v->grass.cnpy.slope); /* used for vegcov and for snowdepth_scale */
-			}
-			v->grass.lai_live_daily[doy]  = lai_standing  * v->grass.pct_live_daily[doy];
-			v->grass.vegcov_daily[doy]    = v->grass.pct_cover_daily[doy] * v->grass.veg_height_daily[doy];	/* used for vegetation interception */
-			v->grass.biolive_daily[doy]   = v->grass.biomass_daily[doy] * v->grass.pct_live_daily[doy];
-			v->grass.biodead_daily[doy]   = v->grass.biomass_daily[doy] - v->grass.biolive_daily[doy];	/* used for transpiration */
-			v->grass.total_agb_daily[doy] = v->grass.litter_daily[doy] + v->grass.biomass_daily[doy];	/* used for bare-soil evaporation */
-		} else {
-			v->grass.lai_live_daily[doy]  = 0.;
-			v->grass.vegcov_daily[doy]    = 0.;
-			v->grass.biolive_daily[doy]   = 0.;
-			v->grass.biodead_daily[doy]   = 0.;
-			v->grass.total_agb_daily[doy] = 0.;
-		}
-		
-		if ( GT(v->fractionShrub, 0.) ) {
-			lai_standing    = v->shrub.biomass_daily[doy] / v->shrub.lai_conv_daily[doy];
-			v->shrub.pct_cover_daily[doy]	= lai_standing / v->shrub.conv_stcr;
-			if( GT(v->shrub.canopy_height_constant, 0.) ) {
-				v->shrub.veg_height_daily[doy] = v->shrub.canopy_height_constant;
-			} else {
-				v->shrub.veg_height_daily[doy]	= tanfunc(v->shrub.biomass_daily[doy],
-										 v->shrub.cnpy.xinflec,
-										 v->shrub.cnpy.yinflec,
-										 v->shrub.cnpy.range,
-										 v->shrub.cnpy.slope); /* used for vegcov and for snowdepth_scale */
-			}
-			v->shrub.lai_live_daily[doy]  = lai_standing  * v->shrub.pct_live_daily[doy];
-			v->shrub.vegcov_daily[doy]    = v->shrub.pct_cover_daily[doy] * v->shrub.veg_height_daily[doy];	/* used for vegetation interception */
-			v->shrub.biolive_daily[doy]   = v->shrub.biomass_daily[doy] * v->shrub.pct_live_daily[doy];
-			v->shrub.biodead_daily[doy]   = v->shrub.biomass_daily[doy] - v->shrub.biolive_daily[doy];	/* used for transpiration */
-			v->shrub.total_agb_daily[doy] = v->shrub.litter_daily[doy] + v->shrub.biomass_daily[doy];	/* used for bare-soil evaporation */
-		} else {
-			v->shrub.lai_live_daily[doy]  = 0.;
-			v->shrub.vegcov_daily[doy]    = 0.;
-			v->shrub.biolive_daily[doy]   = 0.;
-			v->shrub.biodead_daily[doy]   = 0.;
-			v->shrub.total_agb_daily[doy] = 0.;
-		}
-		
-		if ( GT(v->fractionTree, 0.) ) {
-			lai_standing    = v->tree.biomass_daily[doy] / v->tree.lai_conv_daily[doy];
-			v->tree.pct_cover_daily[doy]	= lai_standing / v->tree.conv_stcr;
-			if( GT(v->tree.canopy_height_constant, 0.) ) {
-				v->tree.veg_height_daily[doy] = v->tree.canopy_height_constant;
+	
+	for (m = Jan; m <= Dec; m++) {
+		if (!redo[m]) continue;
+		Time_month_doys(m, &first, &lastdoy);
+		for(doy = first; doy <= lastdoy; doy++){
+			if ( on ) {
+				lai_standing    = veg->biomass_daily[doy] / veg->lai_conv_daily[doy];
+				veg->pct_cover_daily[doy]	= lai_standing / veg->conv_stcr;
+				if( GT(veg->canopy_height_constant, 0.) ) {
+					veg->veg_height_daily[doy] = veg->canopy_height_constant;
+				} else {
+					veg->veg_height_daily[doy]	= tanfunc(veg->biomass_daily[doy],
+											 veg->cnpy.xinflec,
+											 veg->cnpy.yinflec,
+											 veg->cnpy.range,
+											 veg->cnpy.slope); /* used for vegcov and for snowdepth_scale */
+				}
+				veg->lai_live_daily[doy]  = lai_standing  * veg->pct_live_daily[doy];	/* used for vegetation interception of trees */
+				veg->vegcov_daily[doy]    = veg->pct_cover_daily[doy] * veg->veg_height_daily[doy];	/* used for vegetation interception */
+				veg->biolive_daily[doy]   = veg->biomass_daily[doy] * veg->pct_live_daily[doy];
+				veg->biodead_daily[doy]   = veg->biomass_daily[doy] - veg->biolive_daily[doy];	/* used for transpiration */
+				veg->total_agb_daily[doy] = veg->litter_daily[doy]	/* used for bare-soil evaporation */
+				                          + (isTree ? veg->biolive_daily[doy] : veg->biomass_daily[doy]);
 			} else {
-				v->tree.veg_height_daily[doy]	= tanfunc(v->tree.biomass_daily[doy],
-										 v->tree.cnpy.xinflec,
-										 v->tree.cnpy.yinflec,
-										 v->tree.cnpy.range,
-										 v->tree.cnpy.slope); /* used for vegcov and for snowdepth_scale */
+				veg->lai_live_daily[doy]  = 0.;
+				veg->vegcov_daily[doy]    = 0.;
+				veg->biolive_daily[doy]   = 0.;
+				veg->biodead_daily[doy]   = 0.;
+				veg->total_agb_daily[doy] = 0.;
 			}
-			v->tree.lai_live_daily[doy]  = lai_standing  * v->tree.pct_live_daily[doy];	/* used for vegetation interception */
-			v->tree.vegcov_daily[doy]    = v->tree.pct_cover_daily[doy] * v->tree.veg_height_daily[doy];	
-			v->tree.biolive_daily[doy]   = v->tree.biomass_daily[doy] * v->tree.pct_live_daily[doy];
-			v->tree.biodead_daily[doy]   = v->tree.biomass_daily[doy] - v->tree.biolive_daily[doy];	/* used for transpiration */
-			v->tree.total_agb_daily[doy] = v->tree.litter_daily[doy] + v->tree.biolive_daily[doy];	/* used for bare-soil evaporation */
-		} else {
-			v->tree.lai_live_daily[doy]  = 0.;
-			v->tree.vegcov_daily[doy]    = 0.;
-			v->tree.biolive_daily[doy]   = 0.;
-			v->tree.biodead_daily[doy]   = 0.;
-			v->tree.total_agb_daily[doy] = 0.;
 		}
-     
 	}
 }
 
@@ -23,6 +23,7 @@
 	09/26/2011	(drs)	added a daily variable for each monthly input in struct VegType: RealD litter_daily, biomass_daily, pct_live_daily, veg_height_daily, lai_conv_daily, lai_conv_daily, lai_live_daily, pct_cover_daily, vegcov_daily, biolive_daily, biodead_daily, total_agb_daily each of [MAX_DAYS]
 	09/26/2011	(dsr)	removed monthly variables RealD veg_height, lai_live, pct_cover, vegcov, biolive, biodead, total_agb each [MAX_MONTHS] from struct VegType because replaced with daily records
 	02/04/2012	(drs)	added variable RealD SWPcrit to struct VegType: critical soil water potential below which vegetation cannot sustain transpiration
+	10/18/2026	the monthly inputs SW_VPD_init() last used are in struct VegType and SW_VEGPROD, so each grid cell keeps its own
 */
 /********************************************************/
 /********************************************************/
@@ -31,6 +32,14 @@
 #define SW_VEGPROD_H
 
 #include "SW_Defines.h"    /* for MAX_MONTHS and tanfunc_t*/
+#include "Times.h"         /* for TimeInt */
+
+/* monthly inputs of a vegetation type as of the last
+ * SW_VPD_init(), so it can skip what hasn't changed */
+typedef struct {
+	Bool on;
+	RealD litter[MAX_MONTHS], biomass[MAX_MONTHS], pct_live[MAX_MONTHS], lai_conv[MAX_MONTHS];
+} VegLast;
 
 typedef struct  {
     RealD		conv_stcr;	/* divisor for lai_standing gives pct_cover */
@@ -75,6 +84,8 @@ typedef struct  {
 
 	RealD	Es_param_limit; /* parameter for scaling and limiting bare soil evaporation rate */
 
+	VegLast	last;	/* what the daily values were made from */
+
 } VegType;
 
 typedef struct  {
@@ -84,6 +95,9 @@ typedef struct  {
 			fractionShrub,	/* shrub component fraction of total vegetation */
 			fractionTree;	/* tree component fraction of total vegetation */
 	
+	Bool	daily_valid;	/* FALSE forces SW_VPD_init() to redo everything */
+	TimeInt	daily_lastdoy;	/* calendar the daily values were made for */
+	
 } SW_VEGPROD;
 
 void SW_VPD_read(void);
@@ -26,6 +26,7 @@
 	09/30/2011	(drs)	weather name prefix no longer read in from file weathersetup.in with function SW_WTH_read(), but extracted from SW_Files.c:SW_WeatherPrefix()
 	01/13/2011	(drs)	function '_read_hist' didn't close opened files: after reaching OS-limit of openend connections, no files could be read any more -> added 'fclose(f);' to close open connections after use
 	06/01/2012  (DLM) edited _read_hist() function to calculate the yearly avg air temperature & the monthly avg air temperatures...
+	10/18/2026	the position in the running average list is module level, so the grid can keep it for each cell (SW_WTH_get_runavg_tail())
 */
 /********************************************************/
 /********************************************************/
@@ -60,6 +61,7 @@ SW_WEATHER SW_Weather;  /* declared here, externed elsewhere */
 /* --------------------------------------------------- */
 static char *MyFileName;
 static RealD *runavg_list; /* used in run_tmp_avg() */
+static TimeInt runavg_tail = 0; /* where the next day goes in runavg_list */
 static Bool weth_found;    /* TRUE=success reading this years weather file */
 
 /* =================================================== */
@@ -100,9 +102,8 @@ static RealD _runavg_temp(RealD avg) {
 /* --------------------------------------------------- */
 int i, cnt, numdays;
 RealD sum=0.;
-static TimeInt tail = 0;
 
-runavg_list[tail] = avg;
+runavg_list[runavg_tail] = avg;
 numdays = (SW_Model.doy < SW_Weather.days_in_runavg)
 ? SW_Model.doy
 : SW_Weather.days_in_runavg;
@@ -112,7 +113,7 @@ if (!missing(runavg_list[i]))  {
 sum += runavg_list[i];
 }
 }
-tail = (tail < SW_Weather.days_in_runavg-1) ? tail +1 : 0;
+runavg_tail = (runavg_tail < SW_Weather.days_in_runavg-1) ? runavg_tail +1 : 0;
 return ((cnt) ? sum/cnt : WTH_MISSING);
 }
 
@@ -366,6 +367,19 @@ void SW_WTH_free_runavg(void) {
 	Mem_Free(runavg_list);
 }
 
+TimeInt SW_WTH_get_runavg_tail(void) {
+/* =================================================== */
+/* the list is cleared every year but the position isn't,
+* so it carries from one year to the next; for the grid,
+* where each cell has its own */
+	return runavg_tail;
+}
+
+void SW_WTH_set_runavg_tail(TimeInt tail) {
+/* =================================================== */
+	runavg_tail = tail;
+}
+
 
 static Bool _read_hist( TimeInt year) {
 /* =================================================== */
@@ -14,6 +14,7 @@
 		02/19/2011	(drs) added variable 'runoff' to SW_WEATHER_2DAYS and to SW_WEATHER_OUTPUTS
 						moved soil_inf from SW_Soilwat to SW_Weather (added to SW_WEATHER and to SW_WEATHER_OUTPUTS)
 		06/01/2012  (DLM) added temp_year_avg variable to SW_WEATHER_HIST struct & temp_month_avg[MAX_MONTHS] variable
+		10/18/2026	added SW_WTH_get_runavg_tail() & SW_WTH_set_runavg_tail()
 
 */
 /********************************************************/
@@ -109,6 +110,8 @@ void SW_WTH_new_year(void);
 void SW_WTH_sum_today( void ) ;
 void SW_WTH_end_day(void);
 void SW_WTH_free_runavg(void);
+TimeInt SW_WTH_get_runavg_tail(void);
+void SW_WTH_set_runavg_tail(TimeInt tail);
 
 
 #ifdef DEBUG_MEM
@@ -335,12 +335,24 @@ TimeInt yearto4digit( TimeInt yr) {
 
 
 
+void Time_month_doys(Months month, TimeInt *first, TimeInt *last) {
+/* =================================================== */
+/* base1 range of doys that doy2month() puts in month for
+ * the current year.  Dec runs to MAX_DAYS, as in doy2month().
+ */
+
+  *first = (month == Jan) ? 1 : cum_monthdays[month-1] +1;
+  *last  = (month == Dec) ? MAX_DAYS : min(cum_monthdays[month], MAX_DAYS);
+
+}
+
 void interpolate_monthlyValues( double monthlyValues[], double dailyValues[] ){
 /**********************************************************************
 PURPOSE: linear interpolation of monthly value; monthly values are assumed to representative for the 15th of a month
 
 HISTORY:
 	09/22/2011 (drs)
+	10/18/2026	now a wrapper around interpolate_monthlyValues_masked() for all months
 	
 INPUTS:
 monthlyValues - record with values for each month
@@ -349,26 +361,45 @@ OUTPUTS:
 dailyValues - linear interpolation for each day
 **********************************************************************/
 
-	unsigned int doy, mday, month, month2=NoMonth;
-	double sign = 1.;
+	static const Bool all[MAX_MONTHS] = {TRUE, TRUE, TRUE, TRUE, TRUE, TRUE,
+	                                     TRUE, TRUE, TRUE, TRUE, TRUE, TRUE};
+
+	interpolate_monthlyValues_masked(monthlyValues, dailyValues, all);
+}
+
+void interpolate_monthlyValues_masked( double monthlyValues[], double dailyValues[], const Bool months[] ){
+/**********************************************************************
+PURPOSE: as interpolate_monthlyValues(), but only the days of the months
+	for which months[month] is TRUE are (re)computed.  The days of a month
+	are done in two runs, before and after the 15th, each with a constant
+	slope, so the inner loops are simple enough to vectorize; the
+	arithmetic is the same as the original day-by-day version.
+**********************************************************************/
+
+	TimeInt doy, first, last, mid;
+	Months month, month2;
+	double base, slope;
 	
-	for (doy = 1; doy <= MAX_DAYS; doy++){
-		mday = doy2mday(doy);
-		month = doy2month(doy);
+	for (month = Jan; month <= Dec; month++) {
+		if (!months[month]) continue;
+		Time_month_doys(month, &first, &last);
+		mid  = (month == Jan) ? 15 : cum_monthdays[month-1] + 15;	/* doy of the 15th */
+		base = monthlyValues[month];
+		
+		/* before the 15th: toward the previous month */
+		month2 = (month == Jan) ? Dec : month-1;
+		slope = -1. * (monthlyValues[month2]-monthlyValues[month])/(monthdays[month]);
+		for (doy = first; doy < mid && doy <= last; doy++)
+			dailyValues[doy] = base + slope*((double)doy - mid);
+		
+		if (mid >= first && mid <= last)
+			dailyValues[mid] = base;
 		
-		if(mday == 15) {
-			dailyValues[doy] = monthlyValues[month];
-		} else {
-			if(mday >= 15) {
-				month2 = (month == Dec) ? Jan : month+1;
-				sign = 1;
-			} else {
-				month2 = (month == Jan) ? Dec : month-1;
-				sign = -1;
-			}
-			
-			dailyValues[doy] = monthlyValues[month] + sign * (monthlyValues[month2]-monthlyValues[month])/(monthdays[month])*(mday-15.);
-		}
+		/* after the 15th: toward the next month */
+		month2 = (month == Dec) ? Jan : month+1;
+		slope = 1. * (monthlyValues[month2]-monthlyValues[month])/(monthdays[month]);
+		for (doy = max(mid+1, first); doy <= last; doy++)
+			dailyValues[doy] = base + slope*((double)doy - mid);
 	}
 }
 
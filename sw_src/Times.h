@@ -33,6 +33,8 @@
  *    19-Sep-03 (cwb) Imported a bunch of new routines
  *       and added the facility for model time.
 	09/26/2011	(drs)	added function interpolate_monthlyValues()
+	10/18/2026	added Time_month_doys() and interpolate_monthlyValues_masked() so callers can
+						redo only the days of some months; interpolate_monthlyValues() now works month by month
 */
 /********************************************************/
 /********************************************************/
@@ -105,6 +107,8 @@ TimeInt yearto4digit( TimeInt yr);
 Bool isleapyear_now( void );
 Bool isleapyear( const TimeInt year );
 
+void Time_month_doys(Months month, TimeInt *first, TimeInt *last);
 void interpolate_monthlyValues( double monthlyValues[], double dailyValues[] );
+void interpolate_monthlyValues_masked( double monthlyValues[], double dailyValues[], const Bool months[] );
 
 #endif
@@ -5,6 +5,7 @@
 #ifndef MYMEMORY_H
 #define MYMEMORY_H
 
+#include <stdio.h>
 #include <memory.h>
 #include "generic.h"
 
@@ -19,5 +20,6 @@ void *Mem_ReAlloc( void *block, size_t sizeNew) ;
 void Mem_Free( void *block);
 void Mem_Set( void *block, byte c, size_t n) ;
 void Mem_Copy( void *dest, const void *src, size_t n) ;
+void Mem_Report( FILE *f, const char *when);
 
 #endif
@@ -23,7 +23,18 @@
   * depending on the context.
   * IF 'DEBUG_MEM' IS DEFINED, MAKE SURE 'DEBUG' IS DEFINED ALSO.
 
-* - CWBennett 7/17/01 */
+* - CWBennett 7/17/01
+
+  * 10/18/2026 - added allocation accounting that is always on
+  * and cheap enough for production runs: every block carries a
+  * small header (MEM_HEADSIZE) with its size and the slot of
+  * the funcname it was allocated with, and each funcname (the
+  * "tag") has counters of calls, frees, live bytes, and peak
+  * live bytes.  Mem_ReAlloc() keeps the block's tag.  The
+  * counters are updated with atomic adds because the output
+  * threads also allocate.  Mem_Report() writes them.  Memory
+  * from Mem_* must be freed with Mem_Free() and never with
+  * free(), and vice versa. */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,6 +42,31 @@
 #include "generic.h"
 #include "myMemory.h"
 
+/* the accounting header in front of every block; 16 keeps
+ * the block as aligned as malloc() made it */
+#define MEM_HEADSIZE 16
+#define MEM_NTAGS 512   /* distinct funcnames counted separately */
+
+typedef struct {
+  size_t size;
+  int tag;
+} MemHead;
+
+typedef struct {
+  const char *name;   /* NULL while the slot is free */
+  size_t calls, frees, live, peak, total;
+} MemTag;
+
+static MemTag _mem_tags[MEM_NTAGS + 1]; /* the last collects the overflow */
+static size_t _mem_live, _mem_peak;
+
+static int _mem_tag( const char *funcname);
+static void _mem_add( MemTag *t, size_t size);
+static void _mem_sub( MemTag *t, size_t size);
+static void *_mem_alloc( size_t size, const char *funcname);
+static void *_mem_realloc( void *block, size_t sizeNew);
+static void _mem_free( void *block);
+
 /*  not sure how to handle this block migrated from gen_funcs.c */
 #ifdef DEBUG_MEM_X
   struct mem_debug_st {
@@ -48,6 +84,151 @@
 
 /* Note that errstr[] is externed via generic.h */
 
+/*****************************************************/
+static int _mem_tag( const char *funcname) {
+/*-------------------------------------------
+  Find or claim the slot of funcname.  The
+  slots are claimed with compare-and-swap so
+  two threads can't take the same one.
+ -------------------------------------------*/
+  const char *s, *name;
+  unsigned h = 5381;
+  int i, n;
+
+  if (funcname == NULL) funcname = "(none)";
+  for (s = funcname; *s; s++) h = h * 33 + (unsigned char) *s;
+
+  for (i = h % MEM_NTAGS, n = 0; n < MEM_NTAGS;
+       i = (i + 1) % MEM_NTAGS, n++) {
+    name = __atomic_load_n(&_mem_tags[i].name, __ATOMIC_ACQUIRE);
+    if (name == NULL) {
+      if (__atomic_compare_exchange_n(&_mem_tags[i].name, &name, funcname,
+                                      FALSE, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE))
+        return i;
+      /* another thread got it first, name is now its tag */
+    }
+    if (name == funcname || 0 == strcmp(name, funcname))
+      return i;
+  }
+
+  _mem_tags[MEM_NTAGS].name = "(other)";
+  return MEM_NTAGS;
+}
+
+/*****************************************************/
+static void _mem_add( MemTag *t, size_t size) {
+/*-------------------------------------------*/
+  size_t live, peak;
+
+  live = __atomic_add_fetch(&t->live, size, __ATOMIC_RELAXED);
+  peak = __atomic_load_n(&t->peak, __ATOMIC_RELAXED);
+  while (live > peak &&
+         !__atomic_compare_exchange_n(&t->peak, &peak, live, TRUE,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+  __atomic_add_fetch(&t->total, size, __ATOMIC_RELAXED);
+
+  live = __atomic_add_fetch(&_mem_live, size, __ATOMIC_RELAXED);
+  peak = __atomic_load_n(&_mem_peak, __ATOMIC_RELAXED);
+  while (live > peak &&
+         !__atomic_compare_exchange_n(&_mem_peak, &peak, live, TRUE,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+}
+
+/*****************************************************/
+static void _mem_sub( MemTag *t, size_t size) {
+/*-------------------------------------------*/
+  __atomic_sub_fetch(&t->live, size, __ATOMIC_RELAXED);
+  __atomic_sub_fetch(&_mem_live, size, __ATOMIC_RELAXED);
+}
+
+/*****************************************************/
+static void *_mem_alloc( size_t size, const char *funcname) {
+/*-------------------------------------------
+  malloc() with the accounting header.
+ -------------------------------------------*/
+  byte *p;
+  MemHead *h;
+  int tag;
+
+  if (NULL == (p = (byte *) malloc(size + MEM_HEADSIZE)))
+    return NULL;
+
+  tag = _mem_tag(funcname);
+  h = (MemHead *) p;
+  h->size = size;
+  h->tag = tag;
+  __atomic_add_fetch(&_mem_tags[tag].calls, 1, __ATOMIC_RELAXED);
+  _mem_add(&_mem_tags[tag], size);
+
+  return p + MEM_HEADSIZE;
+}
+
+/*****************************************************/
+static void *_mem_realloc( void *block, size_t sizeNew) {
+/*-------------------------------------------*/
+  byte *p = (byte *) block - MEM_HEADSIZE;
+  MemHead *h;
+  size_t sizeOld = ((MemHead *) p)->size;
+
+  if (NULL == (p = (byte *) realloc(p, sizeNew + MEM_HEADSIZE)))
+    return NULL;
+
+  h = (MemHead *) p;
+  h->size = sizeNew;
+  if (sizeNew > sizeOld)
+    _mem_add(&_mem_tags[h->tag], sizeNew - sizeOld);
+  else
+    _mem_sub(&_mem_tags[h->tag], sizeOld - sizeNew);
+
+  return p + MEM_HEADSIZE;
+}
+
+/*****************************************************/
+static void _mem_free( void *block) {
+/*-------------------------------------------*/
+  MemHead *h;
+
+  if (block == NULL) return;
+
+  h = (MemHead *) ((byte *) block - MEM_HEADSIZE);
+  __atomic_add_fetch(&_mem_tags[h->tag].frees, 1, __ATOMIC_RELAXED);
+  _mem_sub(&_mem_tags[h->tag], h->size);
+  free(h);
+}
+
+/*****************************************************/
+void Mem_Report( FILE *f, const char *when) {
+/*-------------------------------------------
+  Write the allocation counters of every tag
+  as comma separated lines, the first field
+  of each saying what the line is; when is
+  put on every line so several reports can
+  go to one file.  Tags with nothing live and
+  a peak under 1KB are left out of the list
+  but not out of the totals.
+
+  10/18/2026
+ -------------------------------------------*/
+  MemTag *t;
+  int i;
+
+  fprintf(f, "# memory,when,live_bytes,peak_bytes\n");
+  fprintf(f, "memory,%s,%lu,%lu\n", when,
+          (unsigned long) _mem_live, (unsigned long) _mem_peak);
+  fprintf(f, "# tag,when,name,calls,frees,live_bytes,peak_bytes,total_bytes\n");
+  for (i = 0; i <= MEM_NTAGS; i++) {
+    t = &_mem_tags[i];
+    if (t->name == NULL || (t->live == 0 && t->peak < 1024))
+      continue;
+    fprintf(f, "tag,%s,\"%s\",%lu,%lu,%lu,%lu,%lu\n", when, t->name,
+            (unsigned long) t->calls, (unsigned long) t->frees,
+            (unsigned long) t->live, (unsigned long) t->peak,
+            (unsigned long) t->total);
+  }
+  fflush(f);
+}
+
 /*****************************************************/
 char *Str_Dup( const char *s) {
 /*-------------------------------------------
@@ -104,7 +285,7 @@ void *Mem_Malloc( size_t size, const char *funcname) {
   #endif
 
 
-  p = malloc( size);
+  p = _mem_alloc( size, funcname);
 
   #ifdef DEBUG_MEM_LOG
     if( NULL==(f=fopen("memory.log","a")) ) {
@@ -217,7 +398,7 @@ void *Mem_ReAlloc( void *block, size_t sizeNew) {
    }
    #endif
 
-   pNew = (byte *)realloc(p, sizeNew);
+   pNew = (byte *)_mem_realloc(p, sizeNew);
 
    if (pNew != NULL) {
        #ifdef DEBUG_MEM
@@ -268,7 +449,7 @@ void Mem_Free( void *block) {
   }
   #endif
 
-  free(block);
+  _mem_free(block);
 
 }
 
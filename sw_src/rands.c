@@ -10,6 +10,10 @@
 
 long _randseed =0L;
 
+static RandStream *_stream = NULL; /* the stream in use, see RandUseStream() */
+
+static double _stream_uni( void);
+
 /*****************************************************/
 void RandSeed( signed long seed ) {
 /*-------------------------------------------
@@ -36,11 +40,11 @@ void RandSeed( signed long seed ) {
 /*    _randseed %= 0xffff; */
     _randseed *= -1;
   } else {
-    _randseed = abs(seed) * -1;
+    _randseed = labs(seed) * -1;
   }
 
   #if RAND_FAST
-    srand(abs(_randseed));
+    srand(labs(_randseed));
   #endif
 
 }
@@ -69,6 +73,7 @@ double RandUni_fast( void ) {
  static double y, rmax = RAND_MAX;
  int i,j;
 
+  if (_stream) return _stream_uni();
 
   if (first_time ) {
     first_time = 0;
@@ -121,6 +126,7 @@ double RandUni_good( void ) {
 
   static long ix1, ix2, ix3;
 
+  if (_stream) return _stream_uni();
 
   if (_randseed == 0L) {
     fprintf(stderr, "RandUni() error: seed not set\n");
@@ -128,7 +134,7 @@ double RandUni_good( void ) {
   }
   if (first_time || _randseed < 0) {
       first_time = 0;
-      ix1 = abs(ic1 - abs(_randseed)) % im1;
+      ix1 = labs(ic1 - labs(_randseed)) % im1;
       ix1 = (ia1*ix1+ic1) % im1;
       ix2 = ix1 % im2;
       ix2 = (ia2*ix2+ic2) % im2; /* looks like a typo in the book */
@@ -289,21 +295,78 @@ double RandNorm( double mean, double stddev) {
 
   static double v1, v2, r, fac, gset, gasdev;
 
-  if (!set) {
+  /* a stream keeps its own second number */
+  short *isset = (_stream) ? &_stream->set : &set;
+  double *spare = (_stream) ? &_stream->gset : &gset;
+
+  if (!*isset) {
     do {
       v1 = 2.0 * RandUni() -1.0;
       v2 = 2.0 * RandUni() -1.0;
       r = v1*v1 + v2*v2;
     } while( r >= 1.0 );
     fac = sqrt(-2.0 *log(r)/r);
-    gset = v1 * fac;
+    *spare = v1 * fac;
     gasdev = v2 * fac;
-    set = 1;
+    *isset = 1;
   } else {
-    gasdev = gset;
-    set = 0;
+    gasdev = *spare;
+    *isset = 0;
   }
 
 
   return mean + gasdev * stddev;
 }
+
+
+/*****************************************************/
+static unsigned long long _splitmix( unsigned long long *x) {
+/*-------------------------------------------
+ the next number of the splitmix64 sequence x
+ (Steele, Lea & Flood, 2014), which is also
+ good for scrambling seeds.
+ -------------------------------------------*/
+  unsigned long long z = (*x += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+
+/*****************************************************/
+static double _stream_uni( void ) {
+/*-------------------------------------------
+ a uniform random variate in [0,1) from the
+ stream in use, from the top 53 bits.
+ -------------------------------------------*/
+  return (_splitmix(&_stream->state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+/*****************************************************/
+void RandSeedStream( RandStream *s, unsigned long seed,
+                     unsigned long n) {
+/*-------------------------------------------
+ starts stream s as the nth stream of seed;
+ every (seed, n) gives a different stream,
+ and the same one every time.
+ -------------------------------------------*/
+  unsigned long long x = seed;
+
+  x = _splitmix(&x) ^ n;
+  s->state = _splitmix(&x);
+  s->set = 0;
+}
+
+
+/*****************************************************/
+void RandUseStream( RandStream *s) {
+/*-------------------------------------------
+ draws the following random numbers from s,
+ or from the RandSeed() generator again if s
+ is NULL.  The stream is used in place, so it
+ has to stay where it is until it's changed.
+ -------------------------------------------*/
+  _stream = s;
+}
@@ -7,6 +7,7 @@
  */
 /* Chris Bennett @ LTER-CSU 6/15/2000            */
 /*    - 5/19/2001 - split from gen_funcs.c       */
+/*    - 10/18/2026 - added the streams (RandStream) */
 
 
 #ifndef RANDS_H
@@ -36,6 +37,20 @@
 
 typedef long RandListType;
 
+/* A stream of random numbers of its own (eg one for each
+ cell of the grid), so that what is drawn from it doesn't
+ depend on what was drawn from anything else.  While a
+ stream is in use (RandUseStream()), RandUni() and everything
+ built on it draw from the stream instead of the generator
+ seeded with RandSeed().  Streams are a splitmix64 sequence,
+ so they're the same with RAND_FAST or not.
+ */
+typedef struct {
+  unsigned long long state;
+  double gset;   /* RandNorm()'s second number */
+  short  set;    /* gset is there */
+} RandStream;
+
 /***************************************************
  * Function definitions
  ***************************************************/
@@ -46,6 +61,8 @@ double RandUni_fast( void);
 int RandUniRange( const long first, const long last);
 double RandNorm( double mean, double stddev);
 void RandUniList( long, long, long, RandListType []);
+void RandSeedStream( RandStream *s, unsigned long seed, unsigned long n);
+void RandUseStream( RandStream *s);
 
 #if RAND_FAST
   #define RandUni RandUni_fast
@@ -41,6 +41,14 @@
  *         appropriate casting measures.
  *
  *		07-16-12 (DLM) - made a ton of changes to try and get it to compile with the new updated version of soilwat (version 23)
+ *
+ *      18-Oct-26 - roots and phenology inputs are kept as read so
+ *         that SXW_Reset() can remake the layer arrays for a new
+ *         set of soil layers (grid cells) without rereading any
+ *         input files.
+ *
+ *      18-Oct-26 - SXW_Run_SOILWAT() marks its time and the
+ *         time in SOILWAT itself for the -t timing (ST_prof.c).
 /*
 /********************************************************/
 /********************************************************/
@@ -61,6 +69,7 @@
 #include "sxw.h"
 #include "sxw_funcs.h"
 #include "sxw_module.h"
+#include "ST_prof.h"
 #include "SW_Control.h"
 #include "SW_Model.h"
 #include "SW_Site.h"
@@ -121,6 +130,15 @@ static char **_files[SXW_NFILES];
 static char _debugout[256];
 static TimeInt _debugyrs[100], _debugyrs_cnt;
 
+/* roots and phenology as read from their files.  These
+ * don't depend on the soil layers, so they are read once
+ * by SXW_Init() and copied into _roots_max and _phen
+ * whenever the arrays are remade (see SXW_Reset()).
+ */
+static RealD _roots_max_in[MAX_RGROUPS * MAX_LAYERS], /* indexed g*MAX_LAYERS+lyr */
+              _phen_in[MAX_RGROUPS * MAX_MONTHS];     /* indexed by Igp() */
+static IntUS _roots_nlyrs_in[MAX_RGROUPS];
+
 
 /*************** Local Function Declarations ***************/
 /***********************************************************/
@@ -133,6 +151,7 @@ static void _read_prod(void);
 static void _read_bvt(void);
 static void _read_watin(void);
 static void _make_arrays(void);
+static void _init_arrays(void);
 static void _make_roots_arrays(void);
 static void _make_phen_arrays(void);
 static void _make_transp_arrays(void);
@@ -186,16 +205,6 @@ void SXW_Init( Bool init_SW ) {
   _write_sw_outin();
 
   if(init_SW) SW_CTL_init_model(SXW.f_watin);
-  
-  SXW.NTrLyrs = SW_Site.n_transp_lyrs_tree;
-  if(SW_Site.n_transp_lyrs_shrub > SXW.NTrLyrs)
-  	SXW.NTrLyrs = SW_Site.n_transp_lyrs_shrub;
-  if(SW_Site.n_transp_lyrs_grass > SXW.NTrLyrs)
-  	SXW.NTrLyrs = SW_Site.n_transp_lyrs_grass;
-  	
-  if (*SXW.debugfile) SXW.NSoLyrs = SW_Site.n_layers;
-
-  _make_arrays();
 
   _read_roots_max();
   _read_phen();
@@ -205,7 +214,7 @@ void SXW_Init( Bool init_SW ) {
 
 /*  _recover_names(); */
 
-  _sxw_root_phen();
+  _init_arrays();
 
 
 
@@ -216,6 +225,22 @@ void SXW_Init( Bool init_SW ) {
 }
 
 
+void SXW_Reset (void) {
+/*======================================================*/
+/* Remake the layer-dimensioned arrays for the current
+ * SW_Site (eg, after the grid code has loaded a cell's
+ * soil layers) from the inputs SXW_Init() already read,
+ * without touching the input files again.
+ */
+
+  free_sxw_memory();
+  Mem_Free(SXW.transp);
+  if (*SXW.debugfile) Mem_Free(SXW.swc);
+
+  _init_arrays();
+}
+
+/* =================================================== */
 void SXW_InitPlot (void) {
 /*======================================================*/
 /* Call this from main::Plot_Init() after killing everything
@@ -257,24 +282,45 @@ void SXW_Run_SOILWAT (void) {
  *             gets done once during init plot.
  */
 
+  Bool reused = FALSE;  /* results supplied without running soilwat */
 #ifndef SXW_BYMAXSIZE
   GrpIndex g;
   RealF sizes[MAX_RGROUPS];
+#endif
+
+  prof_Begin(ProfSXW);
+#ifndef SXW_BYMAXSIZE
   /* compute production values for transp based on current plant sizes */
   ForEachGroup(g) sizes[g] = RGroup[g]->relsize;
   _sxw_update_root_tables(sizes);
-  _sxw_sw_setup(sizes);
+
+  /* optionally reuse a cached year with similar inputs, see sxw_memo.c,
+   * or estimate the year from the surrogate, see sxw_emulator.c */
+  if (GT(SXW.memo_quantum, 0.))
+    reused = _sxw_memo_fetch(sizes);
+  if (!reused && SXW.emu_refresh)
+    reused = _sxw_emu_fetch(sizes);
+  if (!reused)
+    _sxw_sw_setup(sizes);
 #endif
 
-  SXW.aet = 0.;  /* used to be in sw_setup() but it needs clearing each run */
-  _sxw_sw_run();
+  if (!reused) {
+    SXW.aet = 0.;  /* used to be in sw_setup() but it needs clearing each run */
+    prof_Begin(ProfSoilwat);
+    _sxw_sw_run();
+    prof_End();
+#ifndef SXW_BYMAXSIZE
+    if (GT(SXW.memo_quantum, 0.)) _sxw_memo_store();
+    if (SXW.emu_refresh) _sxw_emu_train();
+#endif
+  }
 
   /* now compute resource availability for the given plant sizes */
   _sxw_update_resource();
 
   /* and set environmental variables */
   _sxw_set_environs();
-
+  prof_End();
 
 }
 
@@ -371,9 +417,14 @@ static void  _read_roots_max(void) {
     cnt++;
     lyr = 0;
     while ( (p=strtok(NULL," \t")) ) {
-      _roots_max[Ilg(lyr,g)] = atof(p);
+      if (lyr >= MAX_LAYERS) {
+        LogError(logfp, LOGFATAL,
+                 "%s: More than %d layers found.", MyFileName, MAX_LAYERS);
+      }
+      _roots_max_in[g * MAX_LAYERS + lyr] = atof(p);
       lyr++;
     }
+    _roots_nlyrs_in[g] = lyr;
 
   }
 
@@ -412,7 +463,7 @@ static void _read_phen(void) {
         LogError(logfp, LOGFATAL,
                  "%s: More than 12 months of data found.", MyFileName);
       }
-      _phen[Igp(g,m)] = atof(p);
+      _phen_in[Igp(g,m)] = atof(p);
       m++;
     }
 
@@ -569,6 +620,32 @@ static void _make_arrays(void) {
 
 }
 
+static void _init_arrays(void) {
+/*======================================================*/
+/* size the arrays for the current soil layers and fill
+ * them from the values read in SXW_Init().
+ */
+  GrpIndex g;
+  LyrIndex l;
+
+  SXW.NTrLyrs = SW_Site.n_transp_lyrs_tree;
+  if(SW_Site.n_transp_lyrs_shrub > SXW.NTrLyrs)
+  	SXW.NTrLyrs = SW_Site.n_transp_lyrs_shrub;
+  if(SW_Site.n_transp_lyrs_grass > SXW.NTrLyrs)
+  	SXW.NTrLyrs = SW_Site.n_transp_lyrs_grass;
+
+  if (*SXW.debugfile) SXW.NSoLyrs = SW_Site.n_layers;
+
+  _make_arrays();
+
+  ForEachGroup(g)
+    for (l = 0; l < _roots_nlyrs_in[g] && l < SXW.NTrLyrs; l++)
+      _roots_max[Ilg(l,g)] = _roots_max_in[g * MAX_LAYERS + l];
+  memcpy(_phen, _phen_in, SXW.NGrps * MAX_MONTHS * sizeof(RealD));
+
+  _sxw_root_phen();
+}
+
 static void _make_roots_arrays(void) {
 /*======================================================*/
   int size;
@@ -52,6 +52,11 @@ struct stepwat_st {
   RealF *swc, /* dynamic array(Ilp) of SWC from SOILWAT */
          aet;     /* soilwat's evapotranspiration for the year */
 
+  /* memo cache of soilwat years, see sxw_memo.c */
+  RealF memo_quantum; /* relsize/swc quantization step, 0 = no cache */
+  /* soilwat surrogate, see sxw_emulator.c */
+  IntUS emu_refresh;  /* run soilwat in full every nth year, 0 = no surrogate */
+
 
 };
 
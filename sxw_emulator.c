@@ -0,0 +1,381 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: sxw_emulator.c
+ *
+/*  Type: module
+ *
+/*  Purpose: Optional surrogate for SOILWAT for fast
+ *           exploratory runs.  The first full SOILWAT years
+ *           of a run are used as training samples for a
+ *           linear (ridge) regression from
+ *             annual ppt, annual temp, soil water holding
+ *             capacity, starting soil water, and the group
+ *             relsizes
+ *           to every element of SXW.transp, aet, and the soil
+ *           water and snowpack at the end of the year.  Once
+ *           trained, the regression stands in for
+ *           SW_CTL_run_current_year() in SXW_Run_SOILWAT()
+ *           except that every SXW.emu_refresh-th year is still
+ *           run in full.  Those refresh years are compared to
+ *           the prediction (the error is reported at the end
+ *           of the run) and then added to the training set.
+ *
+ *           ppt and temp only depend on the weather year (and
+ *           on the iteration, when the markov generator makes
+ *           up missing weather), so they are remembered from
+ *           the first full run of each year; a year that hasn't
+ *           been run in full yet is never emulated.
+ *
+ *           An emulated year leaves soilwat's soil water and
+ *           snowpack at their predicted end of year values, as
+ *           a full run would, for the year after it.
+ *
+/*  Dependency:  sxw.c
+ *
+/*  Application: STEPWAT - plant community dynamics simulator
+ *               coupled with the  SOILWAT model.
+ *
+/*  History:
+/*     (18-Oct-2026) -- INITIAL CODING
+/*     (18-Oct-2026) -- a training sample's features are the ones of
+/*                      the start of its year, like a prediction's
+/*     (18-Oct-2026) -- emulated years predict and set the soil water
+/*                      and snowpack they end with
+/*     (18-Oct-2026) -- with the markov generator on, a year's ppt and
+/*                      temp are only reused in the same iteration
+/*
+/********************************************************/
+/********************************************************/
+
+/* =================================================== */
+/*                INCLUDES / DEFINES                   */
+/* --------------------------------------------------- */
+
+#include <stdio.h>
+#include <math.h>
+#include "generic.h"
+#include "filefuncs.h"
+#include "myMemory.h"
+#include "ST_steppe.h"
+#include "ST_globals.h"
+#include "SW_Defines.h"
+#include "sxw.h"
+#include "sxw_module.h"
+#include "sxw_funcs.h"
+#include "SW_Model.h"
+#include "SW_Site.h"
+#include "SW_SoilWater.h"
+#include "SW_Weather.h"
+
+/* features ahead of the group relsizes, see _get_features() */
+#define EMU_NFIXED 5
+/* minimum number of full runs before emulating; the
+ * actual number is the larger of this and EMU_TRAINX
+ * times the number of features */
+#define EMU_MINTRAIN 50
+#define EMU_TRAINX 4
+/* ridge penalty, relative to the mean diagonal of X'X */
+#define EMU_RIDGE 1e-6
+
+/*************** Global Variable Declarations ***************/
+/***********************************************************/
+extern SXW_t SXW;
+
+extern SW_SITE SW_Site;
+extern SW_MODEL SW_Model;
+extern SW_SOILWAT SW_Soilwat;
+extern SW_WEATHER SW_Weather;
+
+/*************** Local Variable Declarations ***************/
+/***********************************************************/
+static int _nf,       /* number of features (EMU_NFIXED + NGrps) */
+           _nout,     /* number of outputs, see _emu_setup() */
+           _iaet, _iswc, _isnow, /* where aet, the soil water of
+                         * each layer, and the snowpack are in them */
+           _ntrain;   /* full runs needed before emulating */
+static IntUS _ntrlyrs; /* NTrLyrs the model was set up for */
+static LyrIndex _nsolyrs; /* and the number of soil layers */
+
+static RealD *_xtx,   /* nf x nf accumulated X'X */
+             *_xty,   /* nf x nout accumulated X'Y */
+             *_beta,  /* nf x nout fitted coefficients */
+             *_chol,  /* nf x nf scratch for the cholesky factor */
+             *_x,     /* features of the current year, as of its start */
+             *_pred;  /* prediction for the current refresh year */
+
+static RealF *_wth_ppt, *_wth_temp; /* by model year, base0 */
+static IntUS *_wth_iter; /* iteration they are from, 0 = not known yet */
+
+static Bool _fitted, _check;
+static unsigned long _nsamples, _nfull, _nemulated, _ncalls,
+                     _nchecks, _naetchecks;
+static RealD _err_sum, _err_max, _aeterr_sum;
+
+/*************** Local Function Declarations ***************/
+/***********************************************************/
+static void _emu_setup(void);
+static Bool _wth_known(int y);
+static void _get_features(RealF sizes[]);
+static void _predict(RealD *out);
+static void _fit(void);
+
+/***********************************************************/
+/****************** Begin Function Code ********************/
+/***********************************************************/
+
+static void _emu_setup(void) {
+/*======================================================*/
+  char *fstr = "_emu_setup()";
+
+  /* the outputs are transp (indexed by Ilp()), aet, the
+   * end of year swc of each layer, and the end of year
+   * snowpack */
+  _nf = EMU_NFIXED + SXW.NGrps;
+  _ntrlyrs = SXW.NTrLyrs;
+  _nsolyrs = SW_Site.n_layers;
+  _iaet = SXW.NPds * SXW.NTrLyrs;
+  _iswc = _iaet + 1;
+  _isnow = _iswc + _nsolyrs;
+  _nout = _isnow + 1;
+  _ntrain = max(EMU_MINTRAIN, EMU_TRAINX * _nf);
+
+  _xtx  = (RealD *) Mem_Calloc(_nf * _nf, sizeof(RealD), fstr);
+  _chol = (RealD *) Mem_Calloc(_nf * _nf, sizeof(RealD), fstr);
+  _xty  = (RealD *) Mem_Calloc(_nf * _nout, sizeof(RealD), fstr);
+  _beta = (RealD *) Mem_Calloc(_nf * _nout, sizeof(RealD), fstr);
+  _x    = (RealD *) Mem_Calloc(_nf, sizeof(RealD), fstr);
+  _pred = (RealD *) Mem_Calloc(_nout, sizeof(RealD), fstr);
+
+  _wth_ppt  = (RealF *) Mem_Calloc(Globals.runModelYears, sizeof(RealF), fstr);
+  _wth_temp = (RealF *) Mem_Calloc(Globals.runModelYears, sizeof(RealF), fstr);
+  _wth_iter = (IntUS *) Mem_Calloc(Globals.runModelYears, sizeof(IntUS), fstr);
+
+}
+
+static Bool _wth_known(int y) {
+/*======================================================*/
+/* TRUE if ppt and temp of model year y (base0) are known
+ * for the current iteration.  Weather from the files is
+ * the same in every iteration, but the markov generator
+ * makes up different weather each time. */
+
+  return (Bool) (_wth_iter[y]
+                 && (!SW_Weather.use_markov || _wth_iter[y] == Globals.currIter));
+}
+
+static void _get_features(RealF sizes[]) {
+/*======================================================*/
+/* fills _x for the current year from the state before
+ * it is run.  ppt and temp are zero if they aren't known
+ * for the year yet (see _wth_known()); _sxw_emu_train() puts
+ * in the ones of the run. */
+  LyrIndex s;
+  GrpIndex g;
+  int y = Globals.currYear -1;
+  RealD whc = 0., swc = 0.;
+
+  ForEachSoilLayer(s) {
+    whc += SW_Site.lyr[s]->swc_fieldcap - SW_Site.lyr[s]->swc_wiltpt;
+    swc += SW_Soilwat.swc[Yesterday][s];
+  }
+
+  _x[0] = 1.;
+  _x[1] = _wth_known(y) ? _wth_ppt[y] : 0.;
+  _x[2] = _wth_known(y) ? _wth_temp[y] : 0.;
+  _x[3] = whc;
+  _x[4] = swc;
+  ForEachGroup(g) _x[EMU_NFIXED + g] = sizes[g];
+
+}
+
+static void _predict(RealD *out) {
+/*======================================================*/
+  int i, j;
+
+  for (j = 0; j < _nout; j++) out[j] = 0.;
+  for (i = 0; i < _nf; i++)
+    for (j = 0; j < _nout; j++)
+      out[j] += _x[i] * _beta[i * _nout + j];
+
+  /* transpiration and aet can't be negative */
+  for (j = 0; j < _nout; j++)
+    if (LT(out[j], 0.)) out[j] = 0.;
+
+}
+
+static void _fit(void) {
+/*======================================================*/
+/* solve (X'X + rI) B = X'Y by cholesky decomposition */
+  int i, j, k;
+  RealD sum, ridge = 0.;
+
+  for (i = 0; i < _nf; i++) ridge += _xtx[i * _nf + i];
+  ridge = EMU_RIDGE * ridge / _nf;
+
+  for (i = 0; i < _nf; i++) {
+    for (j = 0; j <= i; j++) {
+      sum = _xtx[i * _nf + j] + ((i == j) ? ridge : 0.);
+      for (k = 0; k < j; k++) sum -= _chol[i * _nf + k] * _chol[j * _nf + k];
+      if (i == j) {
+        if (!GT(sum, 0.)) { _fitted = FALSE; return; }
+        _chol[i * _nf + i] = sqrt(sum);
+      } else
+        _chol[i * _nf + j] = sum / _chol[j * _nf + j];
+    }
+  }
+
+  for (j = 0; j < _nout; j++) {
+    /* forward substitution L z = X'y, z kept in _beta */
+    for (i = 0; i < _nf; i++) {
+      sum = _xty[i * _nout + j];
+      for (k = 0; k < i; k++) sum -= _chol[i * _nf + k] * _beta[k * _nout + j];
+      _beta[i * _nout + j] = sum / _chol[i * _nf + i];
+    }
+    /* back substitution L' b = z */
+    for (i = _nf - 1; i >= 0; i--) {
+      sum = _beta[i * _nout + j];
+      for (k = i + 1; k < _nf; k++) sum -= _chol[k * _nf + i] * _beta[k * _nout + j];
+      _beta[i * _nout + j] = sum / _chol[i * _nf + i];
+    }
+  }
+
+  _fitted = TRUE;
+}
+
+Bool _sxw_emu_fetch(RealF sizes[]) {
+/*======================================================*/
+/* call before running soilwat.  Returns TRUE and fills
+ * SXW's transp, aet, ppt and temp, and soilwat's soil
+ * water and snowpack, from the surrogate if
+ * this year can be emulated; FALSE if soilwat must run
+ * (in which case _sxw_emu_train() must follow the run,
+ * and trains on the features kept in _x here).
+ */
+  int i, j;
+  int y = Globals.currYear -1;
+  LyrIndex s;
+  RealD swc;
+
+  if (isnull(_xtx)) _emu_setup();
+
+  _check = FALSE;
+  _get_features(sizes);
+  if (!_fitted || SXW.NTrLyrs != _ntrlyrs || SW_Site.n_layers != _nsolyrs
+      || !_wth_known(y))
+    return FALSE;
+
+  if (0 == (++_ncalls % SXW.emu_refresh)) {
+    /* refresh year: keep the prediction to compare after the run */
+    _predict(_pred);
+    _check = TRUE;
+    return FALSE;
+  }
+
+  _predict(_pred);
+  for (i = 0; i < SXW.NTrLyrs; i++)
+    for (j = 0; j < SXW.NPds; j++)
+      SXW.transp[Ilp(i,j)] = _pred[Ilp(i,j)];
+  SXW.aet  = _pred[_iaet];
+  SXW.ppt  = _wth_ppt[y];
+  SXW.temp = _wth_temp[y];
+
+  /* the year after starts from where this one would have
+   * ended, as with a memo hit (see sxw_memo.c) */
+  ForEachSoilLayer(s) {
+    swc = fmin(fmax(_pred[_iswc + s], SW_Site.lyr[s]->swc_min),
+               SW_Site.lyr[s]->swc_saturated);
+    SW_Soilwat.swc[Today][s] = SW_Soilwat.swc[Yesterday][s] = swc;
+  }
+  SW_Soilwat.snowpack[Today] = SW_Soilwat.snowpack[Yesterday] = _pred[_isnow];
+  SW_Model.year = SW_Model.startyr + Globals.currYear -1;
+  _nemulated++;
+
+  return TRUE;
+}
+
+void _sxw_emu_train(void) {
+/*======================================================*/
+/* call after each full soilwat run to add it to the
+ * training set and refit the surrogate.  The features
+ * are the ones _sxw_emu_fetch() kept before the run, since
+ * soilwat has moved the soil water on to the end of the
+ * year by now. */
+  int i, j, ny = SXW.NPds * SXW.NTrLyrs;
+  int y = Globals.currYear -1;
+  RealD diff = 0., tot = 0., err, yv;
+
+  _nfull++;
+  if (!_wth_known(y)) {
+    _wth_ppt[y]  = SXW.ppt;
+    _wth_temp[y] = SXW.temp;
+    _wth_iter[y] = Globals.currIter;
+  }
+  if (SXW.NTrLyrs != _ntrlyrs || SW_Site.n_layers != _nsolyrs) return;
+
+  if (_check) {
+    for (j = 0; j < ny; j++) {
+      diff += fabs(_pred[j] - SXW.transp[j]);
+      tot  += fabs(SXW.transp[j]);
+    }
+    err = GT(tot, 0.) ? diff / tot : 0.;
+    _err_sum += err;
+    _err_max = fmax(_err_max, err);
+    if (GT(SXW.aet, 0.)) {
+      _aeterr_sum += fabs(_pred[_iaet] - SXW.aet) / SXW.aet;
+      _naetchecks++;
+    }
+    _nchecks++;
+    _check = FALSE;
+  }
+
+  _x[1] = SXW.ppt;
+  _x[2] = SXW.temp;
+  for (i = 0; i < _nf; i++) {
+    for (j = 0; j < _nf; j++)
+      _xtx[i * _nf + j] += _x[i] * _x[j];
+    for (j = 0; j < _nout; j++) {
+      if (j < ny)
+        yv = SXW.transp[j];
+      else if (j == _iaet)
+        yv = SXW.aet;
+      else if (j < _isnow)
+        yv = SW_Soilwat.swc[Yesterday][j - _iswc];
+      else
+        yv = SW_Soilwat.snowpack[Yesterday];
+      _xty[i * _nout + j] += _x[i] * yv;
+    }
+  }
+  _nsamples++;
+
+  if (_nsamples >= _ntrain) _fit();
+
+}
+
+void SXW_EmuFree(void) {
+/*======================================================*/
+/* report the surrogate's use and error to the logfile
+ * and release its memory.  Does nothing if it wasn't used. */
+
+  if (isnull(_xtx)) return;
+
+  LogError(logfp, LOGNOTE, "SOILWAT emulator (refresh=%d): %lu full runs "
+                  "(%lu training samples), %lu emulated years",
+                  SXW.emu_refresh, _nfull, _nsamples, _nemulated);
+  if (_nchecks)
+    LogError(logfp, LOGNOTE, "SOILWAT emulator error over %lu refresh years: "
+                    "transp mean %.1f%% max %.1f%%, aet mean %.1f%%",
+                    _nchecks, 100. * _err_sum / _nchecks, 100. * _err_max,
+                    _naetchecks ? 100. * _aeterr_sum / _naetchecks : 0.);
+
+  Mem_Free(_xtx); Mem_Free(_chol); Mem_Free(_xty); Mem_Free(_beta);
+  Mem_Free(_x); Mem_Free(_pred);
+  Mem_Free(_wth_ppt); Mem_Free(_wth_temp); Mem_Free(_wth_iter);
+  _xtx = _chol = _xty = _beta = _x = _pred = NULL;
+  _wth_ppt = _wth_temp = NULL;
+  _wth_iter = NULL;
+
+  _fitted = _check = FALSE;
+  _nsamples = _nfull = _nemulated = _ncalls = _nchecks = _naetchecks = 0;
+  _err_sum = _err_max = _aeterr_sum = 0.;
+
+}
@@ -21,9 +21,12 @@ RealF SXW_GetPR( GrpIndex rg) ;
 
 RealF SXW_ResourceAvailable (void);
 void SXW_Init( Bool init_SW );
+void SXW_Reset (void);
 void SXW_Run_SOILWAT (void);
 void SXW_InitPlot (void);
 void SXW_PrintDebug(void) ;
+void SXW_MemoFree(void);
+void SXW_EmuFree(void);
 
 #ifdef DEBUG_MEM
  void SXW_SetMemoryRefs(void);
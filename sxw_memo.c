@@ -0,0 +1,288 @@
+/********************************************************/
+/********************************************************/
+/*  Source file: sxw_memo.c
+ *
+/*  Type: module
+ *
+/*  Purpose: Optional memo cache of SOILWAT years.  When
+ *           SXW_Run_SOILWAT() is about to run a year of
+ *           SOILWAT, the inputs that drive that run are
+ *           reduced to a key made of the soil profile, the
+ *           weather year, a bucket of the starting soil water
+ *           state, and the group relsizes quantized to
+ *           SXW.memo_quantum.  If an earlier run (in any cell
+ *           or iteration) had the same key, its transpiration,
+ *           aet, ppt, temp, and ending soil water are reused
+ *           instead of running SOILWAT again.
+ *
+ *           This is an approximation: two runs sharing a key
+ *           generally had slightly different inputs, so the
+ *           quantum is a speed/accuracy knob for exploratory
+ *           runs.  It is off (quantum=0) unless requested on
+ *           the command line with -m.
+ *
+/*  Dependency:  sxw.c
+ *
+/*  Application: STEPWAT - plant community dynamics simulator
+ *               coupled with the  SOILWAT model.
+ *
+/*  History:
+/*     (18-Oct-2026) -- INITIAL CODING
+/*
+/********************************************************/
+/********************************************************/
+
+/* =================================================== */
+/*                INCLUDES / DEFINES                   */
+/* --------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "generic.h"
+#include "filefuncs.h"
+#include "myMemory.h"
+#include "ST_steppe.h"
+#include "ST_globals.h"
+#include "SW_Defines.h"
+#include "sxw.h"
+#include "sxw_module.h"
+#include "sxw_funcs.h"
+#include "SW_Model.h"
+#include "SW_Site.h"
+#include "SW_SoilWater.h"
+
+/* number of hash buckets (prime) and the most entries
+ * kept before the cache stops growing */
+#define MEMO_NBUCKETS   4099
+#define MEMO_MAXENTRIES 50000
+
+/*************** Global Variable Declarations ***************/
+/***********************************************************/
+extern SXW_t SXW;
+
+extern SW_SITE SW_Site;
+extern SW_MODEL SW_Model;
+extern SW_SOILWAT SW_Soilwat;
+
+/*************** Local Variable Declarations ***************/
+/***********************************************************/
+typedef struct memo_entry_st MemoEntry;
+struct memo_entry_st {
+  unsigned long hash;
+  IntL *key;       /* see _make_key() for the layout */
+  int nkey;
+  IntUS ntrlyrs;   /* size of transp is NPds * ntrlyrs */
+  RealD *transp,   /* copy of SXW.transp, indexed by Ilp() */
+        *swc_end,  /* soilwat's swc[Yesterday] at the end of the year */
+        snow_end;  /* soilwat's snowpack[Yesterday] at the end of the year */
+  RealF *swc,      /* copy of SXW.swc if it is in use */
+        aet, ppt, temp;
+  MemoEntry *next;
+};
+
+static MemoEntry *_buckets[MEMO_NBUCKETS];
+static unsigned long _nentries, _nhits, _nmisses;
+
+static IntL *_key;   /* key of the current lookup */
+static int _nkey;
+static unsigned long _hash;
+
+/*************** Local Function Declarations ***************/
+/***********************************************************/
+static IntL _quantize(RealD x);
+static IntL _profile_hash(void);
+static void _make_key(RealF sizes[]);
+static MemoEntry *_find_entry(void);
+
+/***********************************************************/
+/****************** Begin Function Code ********************/
+/***********************************************************/
+
+static IntL _quantize(RealD x) {
+/*======================================================*/
+  return (IntL) floor(x / SXW.memo_quantum + 0.5);
+}
+
+static IntL _profile_hash(void) {
+/*======================================================*/
+/* soils are the same for every year in a cell but can
+ * differ between cells, so reduce the layer parameters
+ * that soilwat uses to a single FNV-1a hash. */
+  unsigned long h = 2166136261UL;
+  LyrIndex s;
+  RealD v[6];
+  size_t i;
+  unsigned char *c;
+
+  ForEachSoilLayer(s) {
+    v[0] = SW_Site.lyr[s]->width;
+    v[1] = SW_Site.lyr[s]->pct_sand;
+    v[2] = SW_Site.lyr[s]->pct_clay;
+    v[3] = SW_Site.lyr[s]->bulk_density;
+    v[4] = SW_Site.lyr[s]->swc_saturated;
+    v[5] = SW_Site.lyr[s]->evap_coeff;
+    c = (unsigned char *) v;
+    for (i = 0; i < sizeof(v); i++)
+      h = (h ^ c[i]) * 16777619UL;
+  }
+
+  return (IntL) (h & 0x7fffffffUL);
+}
+
+static void _make_key(RealF sizes[]) {
+/*======================================================*/
+/* layout of the key:
+ *   [0]            soil profile hash
+ *   [1]            weather year
+ *   [2]            1 if soilwat resets swc this year, else 0
+ *   [3..3+nl-1]    quantized relative swc of each layer
+ *                  (all zero when [2] is 1)
+ *   [3+nl..]       quantized relsize of each group
+ */
+  LyrIndex s;
+  GrpIndex g;
+  int n = 0;
+  TimeInt year = SW_Model.startyr + Globals.currYear -1;
+  Bool reset = (SW_Site.reset_yr || year == SW_Model.startyr);
+
+  _nkey = 3 + SW_Site.n_layers + SXW.NGrps;
+  if (isnull(_key))
+    _key = (IntL *) Mem_Calloc(3 + MAX_LAYERS + MAX_RGROUPS, sizeof(IntL),
+                               "_make_key()");
+
+  _key[n++] = _profile_hash();
+  _key[n++] = year;
+  _key[n++] = reset;
+  ForEachSoilLayer(s)
+    _key[n++] = reset ? 0
+              : _quantize(SW_Soilwat.swc[Yesterday][s]
+                          / SW_Site.lyr[s]->swc_saturated);
+  ForEachGroup(g)
+    _key[n++] = _quantize(sizes[g]);
+
+  _hash = 2166136261UL;
+  for (n = 0; n < _nkey; n++)
+    _hash = (_hash ^ (unsigned long) _key[n]) * 16777619UL;
+
+}
+
+static MemoEntry *_find_entry(void) {
+/*======================================================*/
+  MemoEntry *e;
+
+  for (e = _buckets[_hash % MEMO_NBUCKETS]; e; e = e->next) {
+    if (e->hash == _hash && e->nkey == _nkey
+        && e->ntrlyrs == SXW.NTrLyrs
+        && 0 == memcmp(e->key, _key, _nkey * sizeof(IntL)))
+      return e;
+  }
+
+  return NULL;
+}
+
+Bool _sxw_memo_fetch(RealF sizes[]) {
+/*======================================================*/
+/* call before running soilwat.  If the current inputs
+ * match a cached year, copy its results into SXW and
+ * soilwat's carry-over soil water and return TRUE;
+ * otherwise remember the key for _sxw_memo_store()
+ * and return FALSE.
+ */
+  MemoEntry *e;
+  LyrIndex s;
+
+  _make_key(sizes);
+  if (NULL == (e = _find_entry())) {
+    _nmisses++;
+    return FALSE;
+  }
+  _nhits++;
+
+  SW_Model.year = SW_Model.startyr + Globals.currYear -1;
+  Mem_Copy(SXW.transp, e->transp, SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
+  if (!isnull(e->swc) && !isnull(SXW.swc))
+    Mem_Copy(SXW.swc, e->swc, SXW.NPds * SXW.NSoLyrs * sizeof(RealF));
+  SXW.aet  = e->aet;
+  SXW.ppt  = e->ppt;
+  SXW.temp = e->temp;
+
+  ForEachSoilLayer(s)
+    SW_Soilwat.swc[Today][s] = SW_Soilwat.swc[Yesterday][s] = e->swc_end[s];
+  SW_Soilwat.snowpack[Today] = SW_Soilwat.snowpack[Yesterday] = e->snow_end;
+
+  return TRUE;
+}
+
+void _sxw_memo_store(void) {
+/*======================================================*/
+/* call after a soilwat run that _sxw_memo_fetch() missed */
+  MemoEntry *e;
+  LyrIndex s;
+  char *fstr = "_sxw_memo_store()";
+  int size;
+
+  if (_nentries >= MEMO_MAXENTRIES) return;
+
+  e = (MemoEntry *) Mem_Calloc(1, sizeof(MemoEntry), fstr);
+  e->hash = _hash;
+  e->nkey = _nkey;
+  e->key  = (IntL *) Mem_Malloc(_nkey * sizeof(IntL), fstr);
+  Mem_Copy(e->key, _key, _nkey * sizeof(IntL));
+
+  e->ntrlyrs = SXW.NTrLyrs;
+  size = SXW.NPds * SXW.NTrLyrs;
+  e->transp = (RealD *) Mem_Malloc(size * sizeof(RealD), fstr);
+  Mem_Copy(e->transp, SXW.transp, size * sizeof(RealD));
+  if (!isnull(SXW.swc)) {
+    size = SXW.NPds * SXW.NSoLyrs;
+    e->swc = (RealF *) Mem_Malloc(size * sizeof(RealF), fstr);
+    Mem_Copy(e->swc, SXW.swc, size * sizeof(RealF));
+  }
+  e->aet  = SXW.aet;
+  e->ppt  = SXW.ppt;
+  e->temp = SXW.temp;
+
+  e->swc_end = (RealD *) Mem_Calloc(SW_Site.n_layers, sizeof(RealD), fstr);
+  ForEachSoilLayer(s)
+    e->swc_end[s] = SW_Soilwat.swc[Yesterday][s];
+  e->snow_end = SW_Soilwat.snowpack[Yesterday];
+
+  e->next = _buckets[_hash % MEMO_NBUCKETS];
+  _buckets[_hash % MEMO_NBUCKETS] = e;
+  _nentries++;
+
+}
+
+void SXW_MemoFree(void) {
+/*======================================================*/
+/* report hit/miss counts to the logfile and release
+ * the cache.  Does nothing if the cache wasn't used. */
+  MemoEntry *e, *next;
+  int b;
+
+  if (!GT(SXW.memo_quantum, 0.)) return;
+
+  LogError(logfp, LOGNOTE, "SOILWAT memo (quantum=%g): %lu hits, "
+                  "%lu misses (%.1f%% hit rate), %lu entries cached",
+                  SXW.memo_quantum, _nhits, _nmisses,
+                  (_nhits + _nmisses)
+                    ? 100. * _nhits / (_nhits + _nmisses) : 0.,
+                  _nentries);
+
+  for (b = 0; b < MEMO_NBUCKETS; b++) {
+    for (e = _buckets[b]; e; e = next) {
+      next = e->next;
+      Mem_Free(e->key);
+      Mem_Free(e->transp);
+      if (!isnull(e->swc)) Mem_Free(e->swc);
+      Mem_Free(e->swc_end);
+      Mem_Free(e);
+    }
+    _buckets[b] = NULL;
+  }
+  if (!isnull(_key)) Mem_Free(_key);
+  _key = NULL;
+  _nentries = _nhits = _nmisses = 0;
+
+}
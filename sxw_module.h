@@ -37,6 +37,14 @@ void  _sxw_sw_setup(RealF sizes[]);
 void  _sxw_sw_run(void);
 void  _sxw_sw_clear_transp(void);
 
+/* These functions are found in sxw_memo.c */
+Bool _sxw_memo_fetch(RealF sizes[]);
+void _sxw_memo_store(void);
+
+/* These functions are found in sxw_emulator.c */
+Bool _sxw_emu_fetch(RealF sizes[]);
+void _sxw_emu_train(void);
+
 /* These functions are found in sxw_environs.c */
 void _sxw_set_environs(void);
 
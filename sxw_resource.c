@@ -89,29 +89,48 @@ void _print_debuginfo(void);
 static void _transp_contribution_by_group(
                RealD *transp,
                RealF use_by_group[]);
+static void _get_group_lyrs(int nlyrs[]);
 
 
 /***********************************************************/
 /****************** Begin Function Code ********************/
 /***********************************************************/
 
+static void _get_group_lyrs(int nlyrs[]) {
+/*======================================================*/
+/* number of transpiration layers each group's roots can
+ * reach, looked up once per call of the loops below
+ * rather than in the innermost loop.
+ */
+  GrpIndex g;
+
+  ForEachGroup(g)
+    nlyrs[g] = getNTranspLayers(RGroup[g]->veg_prod_type);
+}
+
 void _sxw_root_phen(void) {
 /*======================================================*/
 /* should only be called once, after root distr. and
  * phenology tables are read
+ *
+ * the loops in this file all run period-innermost over
+ * rows of the Iglp/Ilp tables so they are contiguous.
  */
 
   LyrIndex y;
   GrpIndex g;
   TimeInt p;
+  int nlyrs[MAX_RGROUPS];
+  RealD r, *rxp, *phen;
 
+  _get_group_lyrs(nlyrs);
   ForEachGroup(g) {
-  	int nLyrs = getNTranspLayers(RGroup[g]->veg_prod_type);
-  	for( y=0; y<nLyrs; y++) {
-    //ForEachTranspLayer(y) {
-      ForEachTrPeriod(p) {
-        _rootsXphen[Iglp(g,y,p)] = _roots_max[Ilg(y,g)] * _phen[Igp(g,p)];
-      }
+    phen = _phen + Igp(g,0);
+    for( y=0; y<nlyrs[g]; y++) {
+      r = _roots_max[Ilg(y,g)];
+      rxp = _rootsXphen + Iglp(g,y,0);
+      ForEachTrPeriod(p)
+        rxp[p] = r * phen[p];
     }
   }
 }
@@ -170,20 +189,24 @@ void _sxw_update_root_tables( RealF sizes[] ) {
   GrpIndex g;
   LyrIndex l;
   TimeInt p;
-  RealD x;
+  int nlyrs[MAX_RGROUPS];
+  RealD x, size, *rxp, *act, *rel, *sum;
 
   /* set some things to zero */
   Mem_Set( _roots_active_sum, 0,
            SXW.NPds * SXW.NTrLyrs * sizeof(RealD));
 
+  _get_group_lyrs(nlyrs);
   ForEachGroup(g) {
-  	int nLyrs = getNTranspLayers(RGroup[g]->veg_prod_type);
-  	for( l=0; l<nLyrs; l++) {
-    //ForEachTranspLayer(l) {
+    size = sizes[g];
+    for( l=0; l<nlyrs[g]; l++) {
+      rxp = _rootsXphen + Iglp(g,l,0);
+      act = _roots_active + Iglp(g,l,0);
+      sum = _roots_active_sum + Ilp(l,0);
       ForEachTrPeriod(p) {
-        x = _rootsXphen[Iglp(g,l,p)] * sizes[g];
-        _roots_active[Iglp(g,l,p)] = x;
-        _roots_active_sum[Ilp(l,p)] += x;
+        x = rxp[p] * size;
+        act[p] = x;
+        sum[p] += x;
       }
     }
   }
@@ -193,16 +216,12 @@ void _sxw_update_root_tables( RealF sizes[] ) {
    * given layer in a given month is obtained by dividing
    * the cross product by the totals from above */
   ForEachGroup(g) {
-  	int nLyrs = getNTranspLayers(RGroup[g]->veg_prod_type);
-  	for( l=0; l<nLyrs; l++) {
-    //ForEachTranspLayer(l) {
-      ForEachTrPeriod(p) {
-        _roots_active_rel[Iglp(g,l,p)] =
-                       ZRO(_roots_active_sum[Ilp(l,p)])
-                       ? 0.
-                       : _roots_active[Iglp(g,l,p)]
-                         / _roots_active_sum[Ilp(l,p)];
-      }
+    for( l=0; l<nlyrs[g]; l++) {
+      act = _roots_active + Iglp(g,l,0);
+      rel = _roots_active_rel + Iglp(g,l,0);
+      sum = _roots_active_sum + Ilp(l,0);
+      ForEachTrPeriod(p)
+        rel[p] = ZRO(sum[p]) ? 0. : act[p] / sum[p];
     }
   }
 
@@ -228,21 +247,34 @@ static void _transp_contribution_by_group(
    * its phenology (activity).
    */
 
+  /* the products are formed a layer (contiguous row) at a
+   * time, but they're still summed period by period, layer
+   * within period, in single precision; the results are
+   * sensitive to that order.
+   */
+
  GrpIndex g;
  TimeInt p;
  LyrIndex l;
+ int nlyrs[MAX_RGROUPS];
+ RealF part[MAX_LAYERS * MAX_DAYS], sum, *pp;
+ RealD *rel, *tr;
 
+  _get_group_lyrs(nlyrs);
   ForEachGroup(g) {
-    use_by_group[g] = 0.;  /* clear */
+    for( l=0; l<nlyrs[g]; l++) {
+      rel = _roots_active_rel + Iglp(g,l,0);
+      tr  = transp + Ilp(l,0);
+      pp  = part + Ilp(l,0);
+      ForEachTrPeriod(p)
+        pp[p] = (RealF) (rel[p] * tr[p]);
+    }
+    sum = 0.;
     ForEachTrPeriod(p) {
-    	int nLyrs = getNTranspLayers(RGroup[g]->veg_prod_type);
-  		for( l=0; l<nLyrs; l++) {
-      //ForEachTranspLayer(l) {
-        use_by_group[g] += (RealF)
-          (_roots_active_rel[Iglp(g,l,p)]
-          * transp[Ilp(l,p)]);
-      }
+      for( l=0; l<nlyrs[g]; l++)
+        sum += part[Ilp(l,p)];
     }
+    use_by_group[g] = sum;
   }
 
 }
@@ -31,6 +31,7 @@
  *                 other affected variables.  See notes in
  *                 sxw.c.
  *		08/01/2012 - DLM - updated _update_productivity() function to use the 3 different VegProds now used in soilwat...
+ *		10/18/2026 - _prod_conv is declared extern here, it's defined in sxw.c (the second definition only linked as a common symbol)
 /*
 /********************************************************/
 /********************************************************/
@@ -69,7 +70,7 @@ extern SW_VEGPROD SW_VegProd;
 /***********************************************************/
 extern RealD *_roots_max,
              *_phen;          /* phenology read from file */
-       RealF _prod_conv[MAX_MONTHS][3];
+extern RealF _prod_conv[MAX_MONTHS][3];
 
 #ifdef SXW_BYMAXSIZE
 extern RealF _Grp_BMass[];  /* added 2/28/03 */
@@ -0,0 +1,192 @@
+#!/bin/sh
+# golden.sh - golden-output determinism check for STEPWAT.
+#
+# Runs the inputs in this folder with a fixed seed in each configuration
+# (classic, -s, -g, -g -s), and either stores every bmass, mort, and seed
+# dispersal output file as the golden results (record), or compares the
+# output of a new build or mode with them (check).  Each file that isn't
+# identical is compared field by field: numbers may differ by the given
+# tolerance, and for every column with differences the number of rows, the
+# largest absolute and relative difference, and the first row are reported.
+# Use it before turning on a parallel, cached, or vectorized mode: record
+# with a trusted build, then check the mode with -x.
+#
+# usage: sh golden.sh record|check [-b stepwat] [-G golddir] [-w workdir]
+#                     [-c "configs"] [-x "flags"] [-t tol] [-i iters]
+#                     [-y years] [-z seed] [-k]
+#
+#   -b : stepwat binary (default=../stepwat)
+#   -G : folder of the golden results (default=golden)
+#   -w : folder for the runs (default=golden_runs)
+#   -c : configurations to run (default="classic soilwat grid gridsoilwat")
+#   -x : more stepwat options for every run, eg the mode being checked
+#   -t : tolerance, numbers are the same if |a-b| <= tol*max(1,|a|,|b|)
+#        (default=0, exactly the same)
+#   -i : iterations (default=2)
+#   -y : years of each iteration (default=10)
+#   -z : random number seed (default=42)
+#   -k : keep the runs
+#
+# check exits with 1 if any output is different.  "make golden-record" and
+# "make golden" in the top folder run this with the defaults.
+
+cmd=$1
+case $cmd in record|check) shift ;; *) cmd= ;; esac
+
+bin=../stepwat
+gold=golden
+work=golden_runs
+configs="classic soilwat grid gridsoilwat"
+extra=
+tol=0
+iters=2
+years=10
+seed=42
+keep=0
+
+while getopts "b:G:w:c:x:t:i:y:z:k" opt; do
+	case $opt in
+		b) bin=$OPTARG ;;
+		G) gold=$OPTARG ;;
+		w) work=$OPTARG ;;
+		c) configs=$OPTARG ;;
+		x) extra=$OPTARG ;;
+		t) tol=$OPTARG ;;
+		i) iters=$OPTARG ;;
+		y) years=$OPTARG ;;
+		z) seed=$OPTARG ;;
+		k) keep=1 ;;
+		*) cmd= ;;
+	esac
+done
+if [ -z "$cmd" ]; then
+	sed -n '/^# usage/,/^#   -k/p' "$0" | sed 's/^# \{0,1\}//' >&2
+	exit 2
+fi
+
+here=$(cd "$(dirname "$0")" && pwd)
+case $bin in /*) ;; *) bin=$(pwd)/$bin ;; esac
+case $gold in /*) ;; *) gold=$(pwd)/$gold ;; esac
+case $work in /*) ;; *) work=$(pwd)/$work ;; esac
+if [ ! -x "$bin" ]; then
+	echo "golden: no stepwat binary at $bin (run make first)" >&2
+	exit 2
+fi
+if [ $cmd = check ] && [ ! -d "$gold" ]; then
+	echo "golden: no golden results in $gold (run record first)" >&2
+	exit 2
+fi
+
+# run config dir: runs one configuration in a copy of the inputs, leaving
+# its output files in dir/out
+run() {
+	config=$1; d=$2
+
+	rm -rf "$d"
+	mkdir -p "$d"
+	cp -R "$here/Stepwat Inputs" "$here/Grid Inputs" "$here/files.in" "$d/"
+	rm -rf "$d/Output" "$d/Stepwat Inputs/Output"
+	mkdir -p "$d/Output" "$d/Stepwat Inputs/Output" "$d/out"
+
+	tr -d '\r' < "$here/Stepwat Inputs/Input/model.in" \
+	| awk -v l="$iters $years $seed" '!/^#/ && NF == 3 && !done { print l; done = 1; next } { print }' \
+		> "$d/Stepwat Inputs/Input/model.in"
+
+	case $config in
+		classic)     dir="$d/Stepwat Inputs"; flags= ;;
+		soilwat)     dir="$d/Stepwat Inputs"; flags="-s" ;;
+		grid)        dir="$d"; flags="-g" ;;
+		gridsoilwat) dir="$d"; flags="-g -s" ;;
+		*) echo "golden: unknown configuration $config" >&2; return 1 ;;
+	esac
+
+	(cd "$dir" && "$bin" -ffiles.in $flags $extra -q > "$d/stdout.txt" 2>&1) || return 1
+	cp "$d/Output/"* "$d/Stepwat Inputs/Output/"* "$d/out/" 2>/dev/null
+	return 0
+}
+
+# compare gold new name: prints the differences of two output files,
+# returns 1 if there are any
+compare() {
+	awk -F '[\t,]' -v tol="$tol" -v name="$3" '
+		function isnum(s) { return s ~ /^[ ]*[-+]?([0-9]+\.?[0-9]*|\.[0-9]+)([eE][-+]?[0-9]+)?[ ]*$/ }
+		function abs(x) { return x < 0 ? -x : x }
+		FNR == NR { g[FNR] = $0; ng = FNR; next }
+		{
+			nn = FNR
+			if (FNR > ng) { extra++; next }
+			n = split(g[FNR], a, /[\t,]/)
+			if (n != NF) { shape++; if (!shape_row) shape_row = FNR; next }
+			for (k = 1; k <= NF; k++) {
+				if (FNR == 1 && !isnum($k)) head[k] = $k
+				if ((a[k] "") == ($k "")) continue
+				if (isnum(a[k]) && isnum($k)) {
+					d = abs(a[k] - $k)
+					m = abs(a[k]) > abs($k) ? abs(a[k]) : abs($k)
+					if (m < 1) m = 1
+					if (tol > 0 && d <= tol * m) continue
+					r = d / m
+				} else { d = -1; r = -1 }
+				if (!(k in bad)) { bad[k] = 0; first[k] = FNR; ncols++; if (k > maxk) maxk = k }
+				bad[k]++
+				if (d > maxd[k]) maxd[k] = d
+				if (r > maxr[k]) maxr[k] = r
+			}
+		}
+		END {
+			if (nn < ng) missing = ng - nn
+			if (!ncols && !shape && !extra && !missing) exit 0
+			if (shape) printf "  %s: %d rows have a different number of columns, first at row %d\n", name, shape, shape_row
+			if (extra || missing) printf "  %s: %d rows more, %d rows fewer than the golden file\n", name, extra, missing
+			for (k = 1; k <= maxk; k++)
+				if (k in bad) {
+					if (maxd[k] < 0) printf "  %s: column %d (%s): %d rows differ (not numbers), first at row %d\n", name, k, (k in head) ? head[k] : "", bad[k], first[k]
+					else printf "  %s: column %d (%s): %d rows differ, max abs %g, max rel %g, first at row %d\n", name, k, (k in head) ? head[k] : "", bad[k], maxd[k], maxr[k], first[k]
+				}
+			exit 1
+		}' "$1" "$2"
+}
+
+mkdir -p "$work"
+failed=0
+for config in $configs; do
+	d="$work/$config"
+	if ! run $config "$d"; then
+		echo "golden: $config: stepwat failed, see $d/stdout.txt"
+		failed=1
+		keep=1
+		continue
+	fi
+
+	if [ $cmd = record ]; then
+		rm -rf "$gold/$config"
+		mkdir -p "$gold/$config"
+		cp "$d/out/"* "$gold/$config/"
+		echo "golden: $config: recorded $(ls "$gold/$config" | wc -l) files"
+	else
+		same=0; close=0; diff=0
+		for f in "$gold/$config/"*; do
+			b=$(basename "$f")
+			if [ ! -f "$d/out/$b" ]; then
+				echo "  $config/$b: missing"
+				diff=$((diff + 1))
+			elif cmp -s "$f" "$d/out/$b"; then
+				same=$((same + 1))
+			elif compare "$f" "$d/out/$b" "$config/$b"; then
+				close=$((close + 1))
+			else
+				diff=$((diff + 1))
+			fi
+		done
+		for f in "$d/out/"*; do
+			[ -f "$gold/$config/$(basename "$f")" ] || { echo "  $config/$(basename "$f"): not in the golden results"; diff=$((diff + 1)); }
+		done
+		echo "golden: $config: $same files identical, $close within tolerance, $diff different"
+		[ $diff = 0 ] || failed=1
+	fi
+
+	[ $keep = 1 ] || rm -rf "$d"
+done
+[ $keep = 1 ] || rmdir "$work" 2>/dev/null
+
+exit $failed
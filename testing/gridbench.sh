@@ -0,0 +1,178 @@
+#!/bin/sh
+# gridbench.sh - scaling benchmark for the grid version of STEPWAT.
+#
+# Makes synthetic landscapes of any size out of the inputs in this folder
+# (grid_setup.in, grid_soils.csv, grid_disturbances.csv, and the species
+# mix in species.in), runs stepwat on each combination of the sizes,
+# iterations, soilwat and seed dispersal settings given, and writes one CSV
+# line per run with its wall time, cell-years per second, and peak RSS (from
+# the -t timing report, see ST_prof.c).  The sizes make the weak scaling
+# curve (work grows with the cells); running the same matrix with another
+# build or mode gives the strong scaling one.
+#
+# usage: sh gridbench.sh [-b stepwat] [-o results.csv] [-w workdir] [-k]
+#                        [-g "RxC ..."] [-i "iters ..."] [-y years]
+#                        [-s "0 1"] [-d "0 1"] [-c classes] [-m "species ..."]
+#                        [-x seed]
+#
+#   -b : stepwat binary (default=../stepwat)
+#   -o : results file, appended to (default=gridbench.csv)
+#   -w : folder for the generated runs (default=gridbench_runs)
+#   -k : keep the generated runs, otherwise each is removed after it's timed
+#   -g : grid sizes (default="4x4 8x8 16x16")
+#   -i : iterations (default="1")
+#   -y : years of each iteration (default=20)
+#   -s : without (0) and/or with (1) soilwat, the -s option (default="0")
+#   -d : seed dispersal off (0) and/or on (1) (default="0 1")
+#   -c : number of soil classes; each gets a band of cells (default=4)
+#   -m : species mixes, the number of species turned on in species.in; the
+#        first species of each group is always on (default=all)
+#   -x : random number seed for the model and the generated inputs (default=42)
+#
+# "make bench" in the top folder builds stepwat and runs this with the
+# defaults.
+
+bin=../stepwat
+results=gridbench.csv
+work=gridbench_runs
+keep=0
+sizes="4x4 8x8 16x16"
+iters="1"
+years=20
+soilwat="0"
+dispersal="0 1"
+classes=4
+mixes="all"
+seed=42
+
+while getopts "b:o:w:kg:i:y:s:d:c:m:x:" opt; do
+	case $opt in
+		b) bin=$OPTARG ;;
+		o) results=$OPTARG ;;
+		w) work=$OPTARG ;;
+		k) keep=1 ;;
+		g) sizes=$OPTARG ;;
+		i) iters=$OPTARG ;;
+		y) years=$OPTARG ;;
+		s) soilwat=$OPTARG ;;
+		d) dispersal=$OPTARG ;;
+		c) classes=$OPTARG ;;
+		m) mixes=$OPTARG ;;
+		x) seed=$OPTARG ;;
+		*) sed -n '/^# usage/,/^#   -x/p' "$0" | sed 's/^# \{0,1\}//' >&2; exit 1 ;;
+	esac
+done
+
+here=$(cd "$(dirname "$0")" && pwd)
+case $bin in /*) ;; *) bin=$(pwd)/$bin ;; esac
+case $work in /*) ;; *) work=$(pwd)/$work ;; esac
+if [ ! -x "$bin" ]; then
+	echo "gridbench: no stepwat binary at $bin (run make first)" >&2
+	exit 1
+fi
+
+# gen dir rows cols iters dispersal mix: makes a run folder
+gen() {
+	d=$1; rows=$2; cols=$3; niter=$4; disp=$5; mix=$6
+	cells=$((rows * cols))
+
+	rm -rf "$d"
+	mkdir -p "$d/Grid Inputs" "$d/Output"
+	cp -R "$here/Stepwat Inputs" "$d/"
+	cp "$here/files.in" "$d/"
+	cp "$here/Grid Inputs/grid_seed_dispersal.in" "$d/Grid Inputs/"
+
+	# niter nyrs seed
+	tr -d '\r' < "$here/Stepwat Inputs/Input/model.in" \
+	| awk -v l="$niter $years $seed" '!/^#/ && NF == 3 && !done { print l; done = 1; next } { print }' \
+		> "$d/Stepwat Inputs/Input/model.in"
+
+	# species mix: the onoff column of the first table
+	tr -d '\r' < "$here/Stepwat Inputs/Input/species.in" \
+	| awk -v mix="$mix" '
+		/^\[end\]/ { ended = 1 }
+		!ended && !/^#/ && NF >= 16 {
+			n++
+			if (mix != "all" && n > mix && ($2 in seen)) $16 = 0
+			seen[$2] = 1
+		}
+		{ print }' > "$d/Stepwat Inputs/Input/species.in"
+
+	cat > "$d/Grid Inputs/grid_setup.in" <<EOF
+# Grid setup for STEPWAT grid version, made by gridbench.sh
+
+$rows $cols		# rows cols
+1		# use disturbances csv file (0 or 1)... 0 means no, 1 means yes
+1		# use soils csv file (0 or 1)... 0 means no, 1 means yes
+$disp		# use seed dispersal (0 or 1)... 0 means no, 1 means yes
+0		# write one binary file for each kind of output (0 or 1)
+EOF
+
+	# about a tenth of the cells get each kind of disturbance
+	awk -v cells=$cells -v seed=$seed 'BEGIN {
+		srand(seed)
+		print "cell,fecal_pat_use,ant_mound_use,animal_burrows_use,kill_yr"
+		for (i = 0; i < cells; i++)
+			printf "%d,%d,%d,%d,0\n", i, rand() < .1, rand() < .1, rand() < .1
+	}' > "$d/Grid Inputs/grid_disturbances.csv"
+
+	# the soil classes are the two profiles of the test grid with their bulk
+	# density nudged, each class is a band of cells that copy its first cell
+	tr '\r' '\n' < "$here/Grid Inputs/grid_soils.csv" \
+	| awk -F, -v cells=$cells -v classes=$classes '
+		NR == 1 { print; next }
+		$2 == 0 && ntmpl < 2 { tmpl[ntmpl++] = $0 }
+		END {
+			OFS = ","
+			if (classes > cells) classes = cells
+			for (i = 0; i < cells; i++) {
+				c = int(i * classes / cells)
+				first = int((c * cells + classes - 1) / classes)
+				if (i != first) { print i, 1, first, 0; continue }
+				n = split(tmpl[c % 2], f, ",")
+				f[1] = i
+				for (l = 0; l < f[4]; l++)
+					f[6 + l * 12] = sprintf("%.4f", f[6 + l * 12] * (1 + .01 * int(c / 2)))
+				line = f[1]
+				for (k = 2; k <= n; k++) line = line "," f[k]
+				print line
+			}
+		}' > "$d/Grid Inputs/grid_soils.csv"
+}
+
+if [ ! -f "$results" ]; then
+	echo "rows,cols,cells,iterations,years,soilwat,dispersal,soil_classes,species,wall_seconds,cell_years,cell_years_per_second,peak_rss_kb,status" > "$results"
+fi
+
+mkdir -p "$work"
+for size in $sizes; do
+	rows=${size%x*}; cols=${size#*x}
+	for niter in $iters; do
+	for sw in $soilwat; do
+	for disp in $dispersal; do
+	for mix in $mixes; do
+		d="$work/${rows}x${cols}_i${niter}_s${sw}_d${disp}_m${mix}"
+		gen "$d" $rows $cols $niter $disp $mix
+		flags="-g -q"
+		[ "$sw" = 1 ] && flags="$flags -s"
+
+		(cd "$d" && "$bin" -ffiles.in $flags -t"$d/timing.csv" > "$d/stdout.txt" 2>&1)
+		status=$?
+
+		awk -F, -v pre="$rows,$cols,$((rows * cols)),$niter,$years,$sw,$disp,$classes,$mix" -v status=$status '
+			$1 == "summary" { v[$2] = $3 }
+			END { printf "%s,%s,%s,%s,%s,%d\n", pre, v["wall_seconds"], v["cell_years"],
+			             v["cell_years_per_second"], v["peak_rss_kb"], status }' \
+			"$d/timing.csv" 2>/dev/null >> "$results" \
+		|| echo "$rows,$cols,$((rows * cols)),$niter,$years,$sw,$disp,$classes,$mix,,,,,$status" >> "$results"
+		echo "gridbench: ${rows}x${cols} iterations=$niter soilwat=$sw dispersal=$disp species=$mix status=$status"
+
+		[ $keep = 1 ] || rm -rf "$d"
+	done
+	done
+	done
+	done
+done
+[ $keep = 1 ] || rmdir "$work" 2>/dev/null
+
+exit 0